@@ -236,6 +236,10 @@ typedef struct cgImport_s {
 	char		*(*Sys_GetClipboardData) (void);
 	int			(*Sys_Milliseconds) (void);
 	void		(*Sys_SendKeyEvents) (void);
+
+	// Appended so the members above keep their offsets
+	void		*(*Mem_ObjAlloc) (size_t size, const char *fileName, const int fileLine);
+	size_t		(*Mem_ObjFree) (const void *ptr, const char *fileName, const int fileLine);
 } cgImport_t;
 
 typedef cgExport_t (*GetCGameAPI_t) (cgImport_t);
@@ -58,6 +58,10 @@ enum {
 #define CG_MemTagSize(tag)				cgi.Mem_TagSize((tag))
 #define CG_ChangeTag(tagFrom,tagTo)		cgi.Mem_ChangeTag((tagFrom),(tagTo))
 
+// Fixed-size object classes, for things allocated and released constantly
+#define CG_ObjAlloc(size)				cgi.Mem_ObjAlloc((size),__FILE__,__LINE__)
+#define CG_ObjFree(ptr)					cgi.Mem_ObjFree((ptr),__FILE__,__LINE__)
+
 // Filesystem
 #define CG_FS_FreeFile(buffer)			cgi.FS_FreeFile((buffer),__FILE__,__LINE__)
 #define CG_FS_FreeFileList(list,num)	cgi.FS_FreeFileList((list),(num),__FILE__,__LINE__)
@@ -48,8 +48,7 @@ typedef struct localEnt_s {
 	qBool				remove;
 } localEnt_t;
 
-static localEnt_t	*cg_freeLEnts;
-static localEnt_t	cg_leHeadNode, cg_leList[MAX_LENTS];
+static localEnt_t	cg_leHeadNode;
 static int			cg_numLEnts;
 
 /*
@@ -228,10 +227,9 @@ static localEnt_t *CG_AllocLEnt (void)
 {
 	localEnt_t	*le;
 
-	// Take a free particle spot if possible, otherwise steal the oldest one
-	if (cg_freeLEnts) {
-		le = cg_freeLEnts;
-		cg_freeLEnts = le->next;
+	// Allocate one if there's room, otherwise steal the oldest one
+	if (cg_numLEnts < MAX_LENTS) {
+		le = CG_ObjAlloc (sizeof (localEnt_t));
 	}
 	else {
 		le = cg_leHeadNode.prev;
@@ -263,10 +261,7 @@ static inline void CG_FreeLEnt (localEnt_t *le)
 	le->prev->next = le->next;
 	le->next->prev = le->prev;
 
-	// Insert into linked free list
-	le->next = cg_freeLEnts;
-	cg_freeLEnts = le;
-
+	CG_ObjFree (le);
 	cg_numLEnts--;
 }
 
@@ -334,15 +329,15 @@ CG_ClearLocalEnts
 */
 void CG_ClearLocalEnts (void)
 {
-	int		i;
+	// Release the active ones
+	if (cg_leHeadNode.next) {
+		while (cg_leHeadNode.next != &cg_leHeadNode)
+			CG_FreeLEnt (cg_leHeadNode.next);
+	}
 
-	// Link particles
-	cg_freeLEnts = &cg_leList[0];
 	cg_leHeadNode.prev = &cg_leHeadNode;
 	cg_leHeadNode.next = &cg_leHeadNode;
-	for (i=0 ; i<MAX_LENTS-1 ; i++)
-		cg_leList[i].next = &cg_leList[i+1];
-	cg_leList[MAX_LENTS-1].next = NULL;
+	cg_numLEnts = 0;
 }
 
 
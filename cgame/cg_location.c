@@ -260,8 +260,8 @@ CG_AddLoc_f
 */
 static void CG_AddLoc_f (void)
 {
-	FILE	*f;
-	char	path[MAX_QPATH];
+	fileHandle_t	fileNum;
+	char			line[MAX_STRING_CHARS];
 
 	if (cgi.Cmd_Argc () < 2) {
 		Com_Printf (0, "syntax: addloc <message>\n");
@@ -273,21 +273,21 @@ static void CG_AddLoc_f (void)
 		return;
 	}
 
-	Q_snprintfz (path, sizeof (path), "%s/%s", cgi.FS_Gamedir (), cg_locFileName);
-
-	f = fopen (path, "ab");
-	if (!f) {
-		Com_Printf (PRNT_ERROR, "ERROR: Couldn't write %s\n", path);
+	// Written through the filesystem so it knows the file is there to reload
+	cgi.FS_OpenFile (cg_locFileName, &fileNum, FS_MODE_APPEND_BINARY);
+	if (!fileNum) {
+		Com_Printf (PRNT_ERROR, "ERROR: Couldn't write %s/%s\n", cgi.FS_Gamedir (), cg_locFileName);
 		return;
 	}
 
-	fprintf (f, "%i %i %i %s\n",
+	Q_snprintfz (line, sizeof (line), "%i %i %i %s\n",
 		(int)(cg.refDef.viewOrigin[0]*8),
 		(int)(cg.refDef.viewOrigin[1]*8),
 		(int)(cg.refDef.viewOrigin[2]*8),
 		cgi.Cmd_Args ());
 
-	fclose (f);
+	cgi.FS_Write (line, strlen (line), fileNum);
+	cgi.FS_CloseFile (fileNum);
 
 	// Tell them
 	Com_Printf (0, "Saved location (x%i y%i z%i): \"%s\"\n",
@@ -375,8 +375,9 @@ CG_MFX_AddOrigin_f
 */
 static void CG_MFX_AddOrigin_f (void)
 {
-	FILE	*f;
-	char	path[MAX_QPATH];
+	fileHandle_t	fileNum;
+	char			path[MAX_QPATH];
+	char			line[MAX_STRING_CHARS];
 
 	if (!cg.mapLoaded) {
 		Com_Printf (0, "CG_MFX_AddOrigin_f: No map loaded!\n");
@@ -385,21 +386,22 @@ static void CG_MFX_AddOrigin_f (void)
 	if (!cg_mfxInitialized)
 		CG_MapFXLoad (cg.configStrings[CS_MODELS+1]);
 
-	// Open file
-	Q_snprintfz (path, sizeof (path), "%s/mfx/%s.mfx", cgi.FS_Gamedir (), cg_mfxMapName);
-	f = fopen (path, "at");
-	if (!f) {
-		Com_Printf (PRNT_ERROR, "ERROR: CG_AddMFX Couldn't write %s\n", path);
+	// Open file, through the filesystem so it knows the file is there to reload
+	Q_snprintfz (path, sizeof (path), "mfx/%s.mfx", cg_mfxMapName);
+	cgi.FS_OpenFile (path, &fileNum, FS_MODE_APPEND_TEXT);
+	if (!fileNum) {
+		Com_Printf (PRNT_ERROR, "ERROR: CG_AddMFX Couldn't write %s/%s\n", cgi.FS_Gamedir (), path);
 		return;
 	}
 
 	// Print to file
-	fprintf (f, "%i %i %i\t\t0 0 0\t\t0 0 0\t\t255 255 255\t255 255 255\t0.6 -10000\t2 2\t0\t0\t0\n",
+	Q_snprintfz (line, sizeof (line), "%i %i %i\t\t0 0 0\t\t0 0 0\t\t255 255 255\t255 255 255\t0.6 -10000\t2 2\t0\t0\t0\n",
 		(int)(cg.refDef.viewOrigin[0]*8),
 		(int)(cg.refDef.viewOrigin[1]*8),
 		(int)(cg.refDef.viewOrigin[2]*8));
 
-	fclose (f);
+	cgi.FS_Write (line, strlen (line), fileNum);
+	cgi.FS_CloseFile (fileNum);
 
 	// Echo
 	Com_Printf (0, "Saved (x%i y%i z%i) to '%s', reloading file to display...\n",
@@ -422,10 +424,11 @@ CG_MFX_AddTrace_f
 static void CG_MFX_AddTrace_f (void)
 {
 	static vec3_t	mins = {-1, -1, -1}, maxs = {1, 1, 1};
-	FILE	*f;
-	char	path[MAX_QPATH];
-	trace_t	tr;
-	vec3_t	forward;
+	fileHandle_t	fileNum;
+	char			path[MAX_QPATH];
+	char			line[MAX_STRING_CHARS];
+	trace_t			tr;
+	vec3_t			forward;
 
 	if (!cg.mapLoaded) {
 		Com_Printf (0, "CG_MFX_AddTrace_f: No map loaded!\n");
@@ -434,11 +437,11 @@ static void CG_MFX_AddTrace_f (void)
 	if (!cg_mfxInitialized)
 		CG_MapFXLoad (cg.configStrings[CS_MODELS+1]);
 
-	// Open file
-	Q_snprintfz (path, sizeof (path), "%s/mfx/%s.mfx", cgi.FS_Gamedir (), cg_mfxMapName);
-	f = fopen (path, "at");
-	if (!f) {
-		Com_Printf (PRNT_ERROR, "ERROR: CG_AddMFXTr Couldn't write %s\n", path);
+	// Open file, through the filesystem so it knows the file is there to reload
+	Q_snprintfz (path, sizeof (path), "mfx/%s.mfx", cg_mfxMapName);
+	cgi.FS_OpenFile (path, &fileNum, FS_MODE_APPEND_TEXT);
+	if (!fileNum) {
+		Com_Printf (PRNT_ERROR, "ERROR: CG_AddMFXTr Couldn't write %s/%s\n", cgi.FS_Gamedir (), path);
 		return;
 	}
 
@@ -449,22 +452,23 @@ static void CG_MFX_AddTrace_f (void)
 	CG_PMTrace (&tr, cg.refDef.viewOrigin, mins, maxs, forward, qFalse);
 	if (tr.startSolid || tr.allSolid) {
 		Com_Printf (PRNT_ERROR, "ERROR: outside world!\n");
-		fclose (f);
+		cgi.FS_CloseFile (fileNum);
 		return;
 	}
 	if (tr.fraction == 1.0f) {
 		Com_Printf (PRNT_ERROR, "ERROR: didn't hit anything!\n");
-		fclose (f);
+		cgi.FS_CloseFile (fileNum);
 		return;
 	}
 
 	// Print to file
-	fprintf (f, "%i %i %i\t\t0 0 0\t\t0 0 0\t\t255 255 255\t255 255 255\t0.6 -10000\t2 2\t0\t0\t0\n",
+	Q_snprintfz (line, sizeof (line), "%i %i %i\t\t0 0 0\t\t0 0 0\t\t255 255 255\t255 255 255\t0.6 -10000\t2 2\t0\t0\t0\n",
 		(int)((tr.endPos[0] + tr.plane.normal[0])*8),
 		(int)((tr.endPos[1] + tr.plane.normal[1])*8),
 		(int)((tr.endPos[2] + tr.plane.normal[2])*8));
 
-	fclose (f);
+	cgi.FS_Write (line, strlen (line), fileNum);
+	cgi.FS_CloseFile (fileNum);
 
 	// Echo
 	Com_Printf (0, "Saved (x%i y%i z%i) to '%s', reloading file to display...\n",
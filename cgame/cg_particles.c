@@ -23,8 +23,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 
 #include "cg_local.h"
 
-static cgParticle_t		*cg_freeParticles;
-static cgParticle_t		cg_particleHeadNode, cg_particleList[MAX_PARTICLES];
+static cgParticle_t		cg_particleHeadNode;
 static int				cg_numParticles;
 
 /*
@@ -61,10 +60,16 @@ static cgParticle_t *CG_AllocParticle (void)
 {
 	cgParticle_t	*p;
 
-	// Take a free particle spot if possible, otherwise steal the oldest one
-	if (cg_freeParticles && cg_numParticles+1 < cg_particleMax->intVal) {
-		p = cg_freeParticles;
-		cg_freeParticles = p->next;
+	// Allocate one if there's room, otherwise steal the oldest one
+	if (cg_numParticles+1 < cg_particleMax->intVal || !cg_numParticles) {
+		p = CG_ObjAlloc (sizeof (cgParticle_t));
+
+		// Store static poly info
+		p->outPoly.numVerts = 4;
+		p->outPoly.colors = p->outColor;
+		p->outPoly.texCoords = p->outCoords;
+		p->outPoly.vertices = p->outVertices;
+		p->outPoly.matTime = 0;
 	}
 	else {
 		p = cg_particleHeadNode.prev;
@@ -96,10 +101,7 @@ static inline void CG_FreeParticle (cgParticle_t *p)
 	p->prev->next = p->next;
 	p->next->prev = p->prev;
 
-	// Insert into linked free list
-	p->next = cg_freeParticles;
-	cg_freeParticles = p;
-
+	CG_ObjFree (p);
 	cg_numParticles--;
 }
 
@@ -166,25 +168,15 @@ CG_ClearParticles
 */
 void CG_ClearParticles (void)
 {
-	int		i;
+	// Release the active ones
+	if (cg_particleHeadNode.next) {
+		while (cg_particleHeadNode.next != &cg_particleHeadNode)
+			CG_FreeParticle (cg_particleHeadNode.next);
+	}
 
-	// Link particles
-	cg_freeParticles = &cg_particleList[0];
 	cg_particleHeadNode.prev = &cg_particleHeadNode;
 	cg_particleHeadNode.next = &cg_particleHeadNode;
-	for (i=0 ; i<MAX_PARTICLES ; i++) {
-		if (i < MAX_PARTICLES-1)
-			cg_particleList[i].next = &cg_particleList[i+1];
-
-		// Store static poly info
-		cg_particleList[i].outPoly.numVerts = 4;
-		cg_particleList[i].outPoly.colors = cg_particleList[i].outColor;
-		cg_particleList[i].outPoly.texCoords = cg_particleList[i].outCoords;
-		cg_particleList[i].outPoly.vertices = cg_particleList[i].outVertices;
-		cg_particleList[i].outPoly.matTime = 0;
-	}
-
-	cg_particleList[MAX_PARTICLES-1].next = NULL;
+	cg_numParticles = 0;
 }
 
 
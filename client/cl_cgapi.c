@@ -38,6 +38,98 @@ void GUI_EndRegistration (void);
 =============================================================================
 */
 
+#define MAX_PREFETCH_MEDIA	(MAX_CS_MODELS+MAX_CS_SOUNDS+MAX_CS_IMAGES+2)
+
+static char		cl_prefetchNames[MAX_PREFETCH_MEDIA][MAX_QPATH];
+static char		*cl_prefetchList[MAX_PREFETCH_MEDIA];
+static int		cl_numPrefetch;
+
+/*
+===============
+CL_PrefetchFile
+===============
+*/
+static void CL_PrefetchFile (char *name)
+{
+	Q_strncpyz (cl_prefetchNames[cl_numPrefetch], name, sizeof (cl_prefetchNames[cl_numPrefetch]));
+	cl_prefetchList[cl_numPrefetch] = cl_prefetchNames[cl_numPrefetch];
+	cl_numPrefetch++;
+}
+
+
+/*
+===============
+CL_PrefetchImage
+
+Takes the first of the formats R_RegisterImage tries that's there
+===============
+*/
+static void CL_PrefetchImage (char *bareName)
+{
+	static char	*exts[] = { "png", "tga", "jpg", "pcx" };
+	char		name[MAX_QPATH];
+	int			i;
+
+	for (i=0 ; i<sizeof (exts) / sizeof (exts[0]) ; i++) {
+		Q_snprintfz (name, sizeof (name), "%s.%s", bareName, exts[i]);
+		if (FS_FileExists (name) > 0) {
+			CL_PrefetchFile (name);
+			return;
+		}
+	}
+}
+
+
+/*
+===============
+CL_PrefetchMedia
+
+Queues the map, models, sounds and pics the server listed to be read in
+the background while registration starts, so it finds them loaded
+instead of waiting on them one at a time.
+===============
+*/
+static void CL_PrefetchMedia (void)
+{
+	char		*name;
+	int			i;
+
+	cl_numPrefetch = 0;
+	for (i=1 ; i<MAX_CS_MODELS ; i++) {
+		name = cl.configStrings[CS_MODELS+i];
+		if (!name[0] || name[0] == '*' || name[0] == '#')
+			continue;	// inline models and view weapons
+
+		CL_PrefetchFile (name);
+	}
+
+	for (i=1 ; i<MAX_CS_SOUNDS ; i++) {
+		name = cl.configStrings[CS_SOUNDS+i];
+		if (!name[0] || name[0] == '*')
+			continue;	// sexed sounds depend on the player model
+
+		if (name[0] == '#')
+			CL_PrefetchFile (name+1);
+		else
+			CL_PrefetchFile (Q_VarArgs ("sound/%s", name));
+	}
+
+	// What CL_SoundMediaInit and CL_ImageMediaInit register
+	CL_PrefetchFile ("sound/misc/talk.wav");
+	CL_PrefetchImage ("pics/conback");
+
+	for (i=1 ; i<MAX_CS_IMAGES ; i++) {
+		name = cl.configStrings[CS_IMAGES+i];
+		if (!name[0])
+			break;
+
+		CL_PrefetchImage (Q_VarArgs ("pics/%s", name));
+	}
+
+	FS_Prefetch (cl_prefetchList, cl_numPrefetch);
+}
+
+
 /*
 ===============
 CL_CGModule_LoadMap
@@ -58,6 +150,9 @@ void CL_CGModule_LoadMap (void)
 	// Update connection info
 	CL_CGModule_UpdateConnectInfo ();
 
+	// Start reading the media, the world first
+	CL_PrefetchMedia ();
+
 	// Begin registration
 	GUI_BeginRegistration ();
 	R_BeginRegistration ();
@@ -82,6 +177,7 @@ void CL_CGModule_LoadMap (void)
 	GUI_EndRegistration ();
 	R_EndRegistration ();
 	Snd_EndRegistration ();
+	FS_ClearPrefetch ();
 
 	// Clear notify lines
 	CL_ClearNotifyLines ();
@@ -789,6 +885,9 @@ void CL_CGameAPI_Init (void)
 	cgi.Sys_Milliseconds			= Sys_Milliseconds;
 	cgi.Sys_SendKeyEvents			= Sys_SendKeyEvents;
 
+	cgi.Mem_ObjAlloc				= _Mem_ObjAlloc;
+	cgi.Mem_ObjFree					= _Mem_ObjFree;
+
 	// Get the cgame api
 	CGI_Com_DevPrintf (0, "LoadLibrary()\n");
 	cge = (cgExport_t *) Sys_LoadLibrary (LIB_CGAME, &cgi);
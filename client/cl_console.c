@@ -435,6 +435,7 @@ static void CL_ConsoleDump_f (void)
 	}
 
 	fclose (f);
+	FS_InvalidateIndex ();
 }
 
 
@@ -255,8 +255,10 @@ void CL_ParseDownload (qBool compressed)
 		rn = rename (oldName, newName);
 		if (rn)
 			Com_Printf (PRNT_ERROR, "Failed to rename!\n");
-		else
+		else {
 			Com_Printf (0, "Download of %s completed\n", newName);
+			FS_InvalidateIndex ();
+		}
 
 		cls.download.file = NULL;
 		cls.download.percent = 0;
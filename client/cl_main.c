@@ -1635,6 +1635,7 @@ static void CL_WriteConfig (void)
 
 	fprintf (f, "\n\0");
 	fclose (f);
+	FS_InvalidateIndex ();
 	Com_Printf (0, "Saved to %s\n", path);
 }
 
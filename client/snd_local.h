@@ -133,8 +133,6 @@ extern qBool					snd_isAL;
 
 extern uint32					snd_registrationFrame;
 
-extern playSound_t				snd_playSounds[MAX_PLAYSOUNDS];
-extern playSound_t				snd_freePlays;
 extern playSound_t				snd_pendingPlays;
 
 extern cVar_t	*s_show;
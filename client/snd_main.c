@@ -40,10 +40,11 @@ static int				snd_numSFX;
 uint32					snd_registrationFrame;
 
 // Play sounds
-playSound_t				snd_playSounds[MAX_PLAYSOUNDS];
-playSound_t				snd_freePlays;
+static int				snd_numPlaySounds;
 playSound_t				snd_pendingPlays;
 
+static void				Snd_FreePlaysounds (void);
+
 cVar_t	*s_initSound;
 cVar_t	*s_show;
 cVar_t	*s_loadas8bit;
@@ -364,7 +365,7 @@ sfxCache_t *Snd_LoadSound (sfx_t *s)
 	else
 		Q_snprintfz (namebuffer, sizeof (namebuffer), "sound/%s", name);
 
-	fileLen = FS_LoadFile (namebuffer, (void **)&data, NULL);
+	fileLen = FS_LoadFileView (namebuffer, (const void **)&data);
 	if (!data || fileLen <= 0) {
 		Com_DevPrintf (0, "Snd_LoadSound: Couldn't load %s -- %s\n", namebuffer, (fileLen == -1) ? "not found" : "empty file");
 		return NULL;
@@ -375,7 +376,7 @@ sfxCache_t *Snd_LoadSound (sfx_t *s)
 	if (snd_isDMA) {
 		if (info.channels != 1) {
 			Com_Printf (0, "Snd_LoadSound: %s is a stereo sample\n", s->name);
-			FS_FreeFile (data);
+			FS_FreeFileView (data);
 			return NULL;
 		}
 		stepscale = (float)info.rate / snd_audioDMA.speed;	
@@ -387,7 +388,7 @@ sfxCache_t *Snd_LoadSound (sfx_t *s)
 
 	sc = s->cache = Mem_PoolAlloc (len + sizeof (sfxCache_t), cl_soundSysPool, 0);
 	if (!sc) {
-		FS_FreeFile (data);
+		FS_FreeFileView (data);
 		return NULL;
 	}
 
@@ -404,7 +405,7 @@ sfxCache_t *Snd_LoadSound (sfx_t *s)
 		ALSnd_CreateBuffer (sc, info.width, info.channels, data + info.dataOfs, info.samples * info.width * info.channels, info.rate);
 	}
 
-	FS_FreeFile (data);
+	FS_FreeFileView (data);
 	return sc;
 }
 
@@ -969,6 +970,7 @@ void Snd_Shutdown (void)
 
 	// Free all sounds
 	Snd_FreeSounds ();
+	Snd_FreePlaysounds ();
 
 	// Free all memory
 	size = Mem_PoolSize (cl_soundSysPool);
@@ -1026,17 +1028,11 @@ Snd_AllocPlaysound
 */
 static playSound_t *Snd_AllocPlaysound (void)
 {
-	playSound_t	*ps;
-
-	ps = snd_freePlays.next;
-	if (ps == &snd_freePlays)
+	if (snd_numPlaySounds == MAX_PLAYSOUNDS)
 		return NULL;	// No free playsounds
 
-	// Unlink from freelist
-	ps->prev->next = ps->next;
-	ps->next->prev = ps->prev;
-	
-	return ps;
+	snd_numPlaySounds++;
+	return Mem_ObjAlloc (sizeof (playSound_t));
 }
 
 
@@ -1051,11 +1047,22 @@ void Snd_FreePlaysound (playSound_t *ps)
 	ps->prev->next = ps->next;
 	ps->next->prev = ps->prev;
 
-	// Add to free list
-	ps->next = snd_freePlays.next;
-	snd_freePlays.next->prev = ps;
-	ps->prev = &snd_freePlays;
-	snd_freePlays.next = ps;
+	Mem_ObjFree (ps);
+	snd_numPlaySounds--;
+}
+
+
+/*
+=================
+Snd_FreePlaysounds
+
+Releases the ones that never got to a channel
+=================
+*/
+static void Snd_FreePlaysounds (void)
+{
+	while (snd_pendingPlays.next != &snd_pendingPlays)
+		Snd_FreePlaysound (snd_pendingPlays.next);
 }
 
 /*
@@ -1187,23 +1194,14 @@ Snd_StopAllSounds
 */
 void Snd_StopAllSounds (void)
 {
-	int		i;
-
 	if (!snd_isInitialized)
 		return;
 
 	// Clear all the playsounds
-	memset (snd_playSounds, 0, sizeof (snd_playSounds));
-	snd_freePlays.next = snd_freePlays.prev = &snd_freePlays;
+	if (snd_pendingPlays.next)
+		Snd_FreePlaysounds ();
 	snd_pendingPlays.next = snd_pendingPlays.prev = &snd_pendingPlays;
 
-	for (i=0 ; i<MAX_PLAYSOUNDS ; i++) {
-		snd_playSounds[i].prev = &snd_freePlays;
-		snd_playSounds[i].next = snd_freePlays.next;
-		snd_playSounds[i].prev->next = &snd_playSounds[i];
-		snd_playSounds[i].next->prev = &snd_playSounds[i];
-	}
-
 	// Hand off to the implementation
 	if (snd_isDMA) {
 		DMASnd_StopAllSounds ();
@@ -46,6 +46,115 @@ cVar_t					*flushmap;
 cVar_t					*cm_noAreas;
 cVar_t					*cm_noCurves;
 cVar_t					*cm_showTrace;
+cVar_t					*cm_visCacheSize;
+
+cmTraceContext_t		cm_defaultTraceContext;
+static cmTraceContext_t	*cm_traceContexts = &cm_defaultTraceContext;
+
+#define MAX_MERGEDPVS			64		// must be a power of two
+#define MAX_MERGEDPVS_CLUSTERS	8		// larger sets are merged but not remembered
+
+typedef struct cmMergedPVS_s {
+	int						numClusters;
+	int						clusters[MAX_MERGEDPVS_CLUSTERS];
+	byte					*row;
+} cmMergedPVS_t;
+
+static cmMergedPVS_t	cm_mergedPVS[MAX_MERGEDPVS];
+static byte				*cm_mergedScratch;
+
+/*
+=============================================================================
+
+	TRACE CONTEXTS
+
+	The CM_* trace functions all go through cm_defaultTraceContext and are
+	meant for the main thread. Anything tracing from another thread creates
+	its own context with CM_NewTraceContext and uses the CM_Context* calls.
+	Contexts are only created and freed on the main thread, and no trace
+	may be running while a map loads.
+=============================================================================
+*/
+
+/*
+==================
+CM_InitTraceContext
+==================
+*/
+static void CM_InitTraceContext (cmTraceContext_t *ctx)
+{
+	if (cm_bspType == BSP_TYPE_Q3)
+		CM_Q3BSP_InitTraceContext (ctx);
+	else
+		CM_Q2BSP_InitTraceContext (ctx);
+}
+
+
+/*
+==================
+CM_InitTraceContexts
+
+Resizes every context for the map that was just loaded
+==================
+*/
+static void CM_InitTraceContexts (void)
+{
+	cmTraceContext_t	*ctx;
+
+	for (ctx=cm_traceContexts ; ctx ; ctx=ctx->next)
+		CM_InitTraceContext (ctx);
+}
+
+
+/*
+==================
+CM_NewTraceContext
+==================
+*/
+cmTraceContext_t *CM_NewTraceContext (void)
+{
+	cmTraceContext_t	*ctx;
+
+	ctx = Mem_Alloc (sizeof (cmTraceContext_t));
+	ctx->boxPlanes = ctx->boxPlaneBuf;
+	if (cm_mapName[0])
+		CM_InitTraceContext (ctx);
+
+	ctx->next = cm_traceContexts;
+	cm_traceContexts = ctx;
+	return ctx;
+}
+
+
+/*
+==================
+CM_FreeTraceContext
+==================
+*/
+void CM_FreeTraceContext (cmTraceContext_t *ctx)
+{
+	cmTraceContext_t	**prev;
+
+	if (!ctx || ctx == &cm_defaultTraceContext)
+		return;
+
+	for (prev=&cm_traceContexts ; *prev ; prev=&(*prev)->next) {
+		if (*prev != ctx)
+			continue;
+
+		*prev = ctx->next;
+		break;
+	}
+
+	cm_numTraces += ctx->numTraces;
+	cm_numBrushTraces += ctx->numBrushTraces;
+
+	if (ctx->brushChecks)
+		Mem_Free (ctx->brushChecks);
+	if (ctx->patchChecks)
+		Mem_Free (ctx->patchChecks);
+	Mem_Free (ctx);
+}
 
 /*
 =============================================================================
@@ -104,6 +213,7 @@ cBspModel_t *CM_LoadMap (char *name, qBool clientLoad, uint32 *checksum)
 	cm_noAreas		= Cvar_Register ("cm_noAreas",		"0",		CVAR_CHEAT);
 	cm_noCurves		= Cvar_Register ("cm_noCurves",		"0",		CVAR_CHEAT);
 	cm_showTrace	= Cvar_Register ("cm_showTrace",	"0",		0);
+	cm_visCacheSize	= Cvar_Register ("cm_visCacheSize",	"16384",	CVAR_ARCHIVE);
 
 	Com_NormalizePath (fixedName, sizeof (fixedName), name);
 	if (fixedName[0])	// Demos will pass a NULL name, don't need to append an extension to that...
@@ -124,7 +234,8 @@ cBspModel_t *CM_LoadMap (char *name, qBool clientLoad, uint32 *checksum)
 	}
 
 	// Load the file
-	fileLen = FS_LoadFile (fixedName, (void **)&buffer, NULL);
+	// The loaders only read it, so take a view straight out of the pak if it's mapped
+	fileLen = FS_LoadFileView (fixedName, (const void **)&buffer);
 	if (!buffer || fileLen <= 0)
 		Com_Error (ERR_DROP, "CM_LoadMap: Couldn't %s %s", fixedName, (fileLen == -1) ? "find" : "load");
 
@@ -146,15 +257,16 @@ cBspModel_t *CM_LoadMap (char *name, qBool clientLoad, uint32 *checksum)
 
 	model = descr->loader (buffer);
 	if (!model) {
-		FS_FreeFile (buffer);
+		FS_FreeFileView (buffer);
 		return NULL;
 	}
 
 	cm_bspType = descr->type;
 	Q_strncpyz (cm_mapName, fixedName, sizeof (cm_mapName));
+	CM_InitTraceContexts ();
 
 	// Free the buffer
-	FS_FreeFile (buffer);
+	FS_FreeFileView (buffer);
 
 	// Check integrity and return
 	Mem_CheckPoolIntegrity (com_cmodelSysPool);
@@ -180,6 +292,8 @@ void CM_UnloadMap (void)
 	cm_mapChecksum = 0;
 
 	cm_numCModels = 0;
+	memset (cm_mergedPVS, 0, sizeof (cm_mergedPVS));
+	cm_mergedScratch = NULL;
 
 	cm_numTraces = 0;
 	cm_numBrushTraces = 0;
@@ -337,8 +451,15 @@ int CM_LeafContents (int leafNum)
 int	CM_HeadnodeForBox (vec3_t mins, vec3_t maxs)
 {
 	if (cm_bspType == BSP_TYPE_Q3)
-		return CM_Q3BSP_HeadnodeForBox (mins, maxs);
-	return CM_Q2BSP_HeadnodeForBox (mins, maxs);
+		return CM_Q3BSP_HeadnodeForBox (&cm_defaultTraceContext, mins, maxs);
+	return CM_Q2BSP_HeadnodeForBox (&cm_defaultTraceContext, mins, maxs);
+}
+
+int	CM_ContextHeadnodeForBox (cmTraceContext_t *ctx, vec3_t mins, vec3_t maxs)
+{
+	if (cm_bspType == BSP_TYPE_Q3)
+		return CM_Q3BSP_HeadnodeForBox (ctx, mins, maxs);
+	return CM_Q2BSP_HeadnodeForBox (ctx, mins, maxs);
 }
 
 int CM_PointLeafnum (vec3_t p)
@@ -380,27 +501,37 @@ int	CM_TransformedPointContents (vec3_t p, int headNode, vec3_t origin, vec3_t a
 trace_t CM_Trace (vec3_t start, vec3_t end, float size, int contentMask)
 {
 	if (cm_bspType == BSP_TYPE_Q3)
-		return CM_Q3BSP_Trace (start, end, size, contentMask);
-	return CM_Q2BSP_Trace (start, end, size, contentMask);
+		return CM_Q3BSP_Trace (&cm_defaultTraceContext, start, end, size, contentMask);
+	return CM_Q2BSP_Trace (&cm_defaultTraceContext, start, end, size, contentMask);
 }
 
 trace_t CM_BoxTrace (vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs, int headNode, int brushMask)
 {
-	if (cm_bspType == BSP_TYPE_Q3)
-		return CM_Q3BSP_BoxTrace (start, end, mins, maxs, headNode, brushMask);
-	return CM_Q2BSP_BoxTrace (start, end, mins, maxs, headNode, brushMask);
+	return CM_ContextBoxTrace (&cm_defaultTraceContext, start, end, mins, maxs, headNode, brushMask);
 }
 
 void CM_TransformedBoxTrace (trace_t *out, vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs, int headNode, int brushMask, vec3_t origin, vec3_t angles)
+{
+	CM_ContextTransformedBoxTrace (&cm_defaultTraceContext, out, start, end, mins, maxs, headNode, brushMask, origin, angles);
+}
+
+trace_t CM_ContextBoxTrace (cmTraceContext_t *ctx, vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs, int headNode, int brushMask)
+{
+	if (cm_bspType == BSP_TYPE_Q3)
+		return CM_Q3BSP_BoxTrace (ctx, start, end, mins, maxs, headNode, brushMask);
+	return CM_Q2BSP_BoxTrace (ctx, start, end, mins, maxs, headNode, brushMask);
+}
+
+void CM_ContextTransformedBoxTrace (cmTraceContext_t *ctx, trace_t *out, vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs, int headNode, int brushMask, vec3_t origin, vec3_t angles)
 {
 	if (!out)
 		return;
 
 	if (cm_bspType == BSP_TYPE_Q3) {
-		CM_Q3BSP_TransformedBoxTrace (out, start, end, mins, maxs, headNode, brushMask, origin, angles);
+		CM_Q3BSP_TransformedBoxTrace (ctx, out, start, end, mins, maxs, headNode, brushMask, origin, angles);
 		return;
 	}
-	CM_Q2BSP_TransformedBoxTrace (out, start, end, mins, maxs, headNode, brushMask, origin, angles);
+	CM_Q2BSP_TransformedBoxTrace (ctx, out, start, end, mins, maxs, headNode, brushMask, origin, angles);
 }
 
 /*
@@ -411,20 +542,110 @@ void CM_TransformedBoxTrace (trace_t *out, vec3_t start, vec3_t end, vec3_t mins
 =============================================================================
 */
 
-byte *CM_ClusterPVS (int cluster)
+const byte *CM_ClusterPVS (int cluster)
 {
 	if (cm_bspType == BSP_TYPE_Q3)
 		return CM_Q3BSP_ClusterPVS (cluster);
 	return CM_Q2BSP_ClusterPVS (cluster);
 }
 
-byte *CM_ClusterPHS (int cluster)
+const byte *CM_ClusterPHS (int cluster)
 {
 	if (cm_bspType == BSP_TYPE_Q3)
 		return CM_Q3BSP_ClusterPHS (cluster);
 	return CM_Q2BSP_ClusterPHS (cluster);
 }
 
+
+/*
+==================
+CM_OrClusterRow
+
+64 bits at a time when both rows are aligned for it
+==================
+*/
+static void CM_OrClusterRow (byte *dest, const byte *src, int numBytes)
+{
+	int		i;
+
+	i = 0;
+	if (!(((size_t)dest | (size_t)src) & (sizeof (uint64)-1))) {
+		for ( ; i+8<=numBytes ; i+=8)
+			*(uint64 *)(dest+i) |= *(const uint64 *)(src+i);
+	}
+	for ( ; i<numBytes ; i++)
+		dest[i] |= src[i];
+}
+
+
+/*
+==================
+CM_MergedClusterPVS
+
+Returns the union of the PVS rows of a set of clusters. PVS data does not
+change during a map, so each merged row is remembered by its cluster set
+and anyone standing in the same clusters gets the same row back.
+==================
+*/
+const byte *CM_MergedClusterPVS (int *clusters, int numClusters)
+{
+	cmMergedPVS_t	*merged;
+	int				rowBytes, rowSize;
+	uint32			hash;
+	byte			*row;
+	int				i, j, temp;
+
+	if (numClusters < 1)
+		return CM_ClusterPVS (-1);
+
+	// Sort and remove duplicates so the set has one spelling
+	for (i=1 ; i<numClusters ; i++) {
+		temp = clusters[i];
+		for (j=i ; j>0 && clusters[j-1] > temp ; j--)
+			clusters[j] = clusters[j-1];
+		clusters[j] = temp;
+	}
+	for (i=1, j=1 ; i<numClusters ; i++) {
+		if (clusters[i] != clusters[j-1])
+			clusters[j++] = clusters[i];
+	}
+	numClusters = j;
+
+	if (numClusters == 1)
+		return CM_ClusterPVS (clusters[0]);
+
+	rowBytes = (CM_NumClusters () + 7) >> 3;
+	rowSize = ((rowBytes + 7) >> 3) << 3;
+
+	if (numClusters <= MAX_MERGEDPVS_CLUSTERS) {
+		hash = numClusters;
+		for (i=0 ; i<numClusters ; i++)
+			hash = hash * 31 + clusters[i];
+		merged = &cm_mergedPVS[(hash ^ (hash >> 8)) & (MAX_MERGEDPVS-1)];
+
+		if (merged->row && merged->numClusters == numClusters
+		&& !memcmp (merged->clusters, clusters, sizeof (int) * numClusters))
+			return merged->row;
+
+		if (!merged->row)
+			merged->row = Mem_PoolAlloc (rowSize, com_cmodelSysPool, 0);
+		merged->numClusters = numClusters;
+		memcpy (merged->clusters, clusters, sizeof (int) * numClusters);
+		row = merged->row;
+	}
+	else {
+		if (!cm_mergedScratch)
+			cm_mergedScratch = Mem_PoolAlloc (rowSize, com_cmodelSysPool, 0);
+		row = cm_mergedScratch;
+	}
+
+	memcpy (row, CM_ClusterPVS (clusters[0]), rowBytes);
+	for (i=1 ; i<numClusters ; i++)
+		CM_OrClusterRow (row, CM_ClusterPVS (clusters[i]), rowBytes);
+
+	return row;
+}
+
 /*
 =============================================================================
 
@@ -475,7 +696,7 @@ void CM_ReadPortalState (fileHandle_t fileNum)
 	CM_Q2BSP_ReadPortalState (fileNum);
 }
 
-qBool CM_HeadnodeVisible (int nodeNum, byte *visBits)
+qBool CM_HeadnodeVisible (int nodeNum, const byte *visBits)
 {
 	if (cm_bspType == BSP_TYPE_Q3)
 		return CM_Q3BSP_HeadnodeVisible (nodeNum, visBits);
@@ -497,9 +718,18 @@ CM_PrintStats
 */
 void CM_PrintStats (void)
 {
-	static int	highTrace = 0;
-	static int	highBTrace = 0;
-	static int	highPC = 0;
+	static int			highTrace = 0;
+	static int			highBTrace = 0;
+	static int			highPC = 0;
+	cmTraceContext_t	*ctx;
+
+	// Gather the per-context counters
+	for (ctx=cm_traceContexts ; ctx ; ctx=ctx->next) {
+		cm_numTraces += ctx->numTraces;
+		cm_numBrushTraces += ctx->numBrushTraces;
+		ctx->numTraces = 0;
+		ctx->numBrushTraces = 0;
+	}
 
 	if (cm_showTrace && cm_showTrace->intVal)
 		Com_Printf (0, "%4i/%4i tr %4i/%4i brtr %4i/%4i pt\n",
@@ -519,3 +749,23 @@ void CM_PrintStats (void)
 	cm_numBrushTraces = 0;
 	cm_numPointContents = 0;
 }
+
+
+/*
+==================
+CM_NumTraces
+
+Traces run since the last CM_PrintStats, main thread only
+==================
+*/
+int CM_NumTraces (void)
+{
+	cmTraceContext_t	*ctx;
+	int					numTraces;
+
+	numTraces = cm_numTraces;
+	for (ctx=cm_traceContexts ; ctx ; ctx=ctx->next)
+		numTraces += ctx->numTraces;
+
+	return numTraces;
+}
@@ -51,6 +51,65 @@ extern cVar_t				*flushmap;
 extern cVar_t				*cm_noAreas;
 extern cVar_t				*cm_noCurves;
 extern cVar_t				*cm_showTrace;
+extern cVar_t				*cm_visCacheSize;
+
+/*
+=============================================================================
+
+	TRACE CONTEXT
+
+	Everything a box trace writes while it runs. Nothing in here is shared,
+	so traces through different contexts can run on different threads at
+	once. The brush and patch check marks are indexed by brush/patch number
+	and sized for the loaded map by CM_Q2BSP/Q3BSP_InitTraceContext.
+=============================================================================
+*/
+
+typedef struct cmTraceContext_s {
+	trace_t						trace;
+
+	vec3_t						start, end;
+	vec3_t						mins, maxs;
+	vec3_t						extents;
+	int							contents;
+	qBool						isPoint;		// optimized case
+
+	// Q3BSP
+	vec3_t						startMins, startMaxs;
+	vec3_t						endMins, endMaxs;
+	vec3_t						absMins, absMaxs;
+	// !Q3BSP
+
+	// Box hull planes for CM_ContextHeadnodeForBox. The default context
+	// points this at the map's shared box planes, others at boxPlaneBuf
+	cBspPlane_t					*boxPlanes;
+	cBspPlane_t					boxPlaneBuf[12];
+
+	// Multi-check avoidance
+	int							checkCount;
+	int							numBrushChecks;
+	int							*brushChecks;
+	int							numPatchChecks;
+	int							*patchChecks;
+
+	// Folded into cm_numTraces/cm_numBrushTraces by CM_PrintStats
+	int							numTraces;
+	int							numBrushTraces;
+
+	struct cmTraceContext_s		*next;
+} cmTraceContext_t;
+
+extern cmTraceContext_t		cm_defaultTraceContext;
+
+// Box leaf list state, kept on the stack so leaf queries are reentrant too
+typedef struct cmLeafList_s {
+	cmTraceContext_t			*ctx;			// box hull planes for box headnodes
+	int							count;
+	int							maxCount;
+	int							*list;
+	float						*mins, *maxs;
+	int							topNode;
+} cmLeafList_t;
 
 /*
 =============================================================================
@@ -75,26 +134,27 @@ int			CM_Q2BSP_LeafArea (int leafNum);
 int			CM_Q2BSP_LeafCluster (int leafNum);
 int			CM_Q2BSP_LeafContents (int leafNum);
 
-int			CM_Q2BSP_HeadnodeForBox (vec3_t mins, vec3_t maxs);
+int			CM_Q2BSP_HeadnodeForBox (cmTraceContext_t *ctx, vec3_t mins, vec3_t maxs);
 int			CM_Q2BSP_PointLeafnum (vec3_t p);
 int			CM_Q2BSP_BoxLeafnums (vec3_t mins, vec3_t maxs, int *list, int listSize, int *topNode);
 
 int			CM_Q2BSP_PointContents (vec3_t p, int headNode);
 int			CM_Q2BSP_TransformedPointContents (vec3_t p, int headNode, vec3_t origin, vec3_t angles);
 
-trace_t		CM_Q2BSP_Trace (vec3_t start, vec3_t end, float size, int contentMask);
-trace_t		CM_Q2BSP_BoxTrace (vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs, int headNode, int brushMask);
-void		CM_Q2BSP_TransformedBoxTrace (trace_t *out, vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs, int headNode, int brushMask, vec3_t origin, vec3_t angles);
+void		CM_Q2BSP_InitTraceContext (cmTraceContext_t *ctx);
+trace_t		CM_Q2BSP_Trace (cmTraceContext_t *ctx, vec3_t start, vec3_t end, float size, int contentMask);
+trace_t		CM_Q2BSP_BoxTrace (cmTraceContext_t *ctx, vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs, int headNode, int brushMask);
+void		CM_Q2BSP_TransformedBoxTrace (cmTraceContext_t *ctx, trace_t *out, vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs, int headNode, int brushMask, vec3_t origin, vec3_t angles);
 
-byte		*CM_Q2BSP_ClusterPVS (int cluster);
-byte		*CM_Q2BSP_ClusterPHS (int cluster);
+const byte	*CM_Q2BSP_ClusterPVS (int cluster);
+const byte	*CM_Q2BSP_ClusterPHS (int cluster);
 
 void		CM_Q2BSP_SetAreaPortalState (int portalNum, qBool open);
 qBool		CM_Q2BSP_AreasConnected (int area1, int area2);
 int			CM_Q2BSP_WriteAreaBits (byte *buffer, int area);
 void		CM_Q2BSP_WritePortalState (fileHandle_t fileNum);
 void		CM_Q2BSP_ReadPortalState (fileHandle_t fileNum);
-qBool		CM_Q2BSP_HeadnodeVisible (int nodeNum, byte *visBits);
+qBool		CM_Q2BSP_HeadnodeVisible (int nodeNum, const byte *visBits);
 
 /*
 =============================================================================
@@ -119,23 +179,24 @@ int			CM_Q3BSP_LeafArea (int leafNum);
 int			CM_Q3BSP_LeafCluster (int leafNum);
 int			CM_Q3BSP_LeafContents (int leafNum);
 
-int			CM_Q3BSP_HeadnodeForBox (vec3_t mins, vec3_t maxs);
+int			CM_Q3BSP_HeadnodeForBox (cmTraceContext_t *ctx, vec3_t mins, vec3_t maxs);
 int			CM_Q3BSP_PointLeafnum (vec3_t p);
 int			CM_Q3BSP_BoxLeafnums (vec3_t mins, vec3_t maxs, int *list, int listSize, int *topNode);
 
 int			CM_Q3BSP_PointContents (vec3_t p, int headNode);
 int			CM_Q3BSP_TransformedPointContents (vec3_t p, int headNode, vec3_t origin, vec3_t angles);
 
-trace_t		CM_Q3BSP_Trace (vec3_t start, vec3_t end, float size, int contentMask);
-trace_t		CM_Q3BSP_BoxTrace (vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs, int headNode, int brushMask);
-void		CM_Q3BSP_TransformedBoxTrace (trace_t *out, vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs, int headNode, int brushMask, vec3_t origin, vec3_t angles);
+void		CM_Q3BSP_InitTraceContext (cmTraceContext_t *ctx);
+trace_t		CM_Q3BSP_Trace (cmTraceContext_t *ctx, vec3_t start, vec3_t end, float size, int contentMask);
+trace_t		CM_Q3BSP_BoxTrace (cmTraceContext_t *ctx, vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs, int headNode, int brushMask);
+void		CM_Q3BSP_TransformedBoxTrace (cmTraceContext_t *ctx, trace_t *out, vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs, int headNode, int brushMask, vec3_t origin, vec3_t angles);
 
-byte		*CM_Q3BSP_ClusterPVS (int cluster);
-byte		*CM_Q3BSP_ClusterPHS (int cluster);
+const byte	*CM_Q3BSP_ClusterPVS (int cluster);
+const byte	*CM_Q3BSP_ClusterPHS (int cluster);
 
 void		CM_Q3BSP_SetAreaPortalState (int portalNum, int area, int otherArea, qBool open);
 qBool		CM_Q3BSP_AreasConnected (int area1, int area2);
 int			CM_Q3BSP_WriteAreaBits (byte *buffer, int area);
 void		CM_Q3BSP_WritePortalState (fileHandle_t fileNum);
 void		CM_Q3BSP_ReadPortalState (fileHandle_t fileNum);
-qBool		CM_Q3BSP_HeadnodeVisible (int nodeNum, byte *visBits);
+qBool		CM_Q3BSP_HeadnodeVisible (int nodeNum, const byte *visBits);
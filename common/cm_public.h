@@ -38,6 +38,7 @@ int			CM_InlineModelHeadNode (struct cBspModel_s *model);
 // ==========================================================================
 
 void		CM_PrintStats (void);
+int			CM_NumTraces (void);
 
 // ==========================================================================
 
@@ -59,8 +60,18 @@ trace_t		CM_Trace (vec3_t start, vec3_t end, float size,  int contentMask);
 trace_t		CM_BoxTrace (vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs,  int headNode, int brushMask);
 void		CM_TransformedBoxTrace (trace_t *out, vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs, int headNode, int brushMask, vec3_t origin, vec3_t angles);
 
-byte		*CM_ClusterPVS (int cluster);
-byte		*CM_ClusterPHS (int cluster);
+// the functions above share one context and are main thread only, each
+// thread that traces concurrently creates its own context on the main thread
+struct cmTraceContext_s	*CM_NewTraceContext (void);
+void		CM_FreeTraceContext (struct cmTraceContext_s *ctx);
+
+int			CM_ContextHeadnodeForBox (struct cmTraceContext_s *ctx, vec3_t mins, vec3_t maxs);	// only valid for traces through ctx
+trace_t		CM_ContextBoxTrace (struct cmTraceContext_s *ctx, vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs, int headNode, int brushMask);
+void		CM_ContextTransformedBoxTrace (struct cmTraceContext_s *ctx, trace_t *out, vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs, int headNode, int brushMask, vec3_t origin, vec3_t angles);
+
+const byte	*CM_ClusterPVS (int cluster);
+const byte	*CM_ClusterPHS (int cluster);
+const byte	*CM_MergedClusterPVS (int *clusters, int numClusters);	// clusters is reordered
 
 int			CM_PointLeafnum (vec3_t p);
 
@@ -76,7 +87,7 @@ void		CM_SetAreaPortalState (int portalNum, int area, int otherArea, qBool open)
 qBool		CM_AreasConnected (int area1, int area2);
 
 int			CM_WriteAreaBits (byte *buffer, int area);
-qBool		CM_HeadnodeVisible (int headNode, byte *visBits);
+qBool		CM_HeadnodeVisible (int headNode, const byte *visBits);
 
 void		CM_WritePortalState (fileHandle_t fileNum);
 void		CM_ReadPortalState (fileHandle_t fileNum);
@@ -48,7 +48,6 @@ typedef struct cQ2BspBrush_s {
 	int				contents;
 	int				numSides;
 	int				firstBrushSide;
-	int				checkCount;			// to avoid repeated testings
 } cQ2BspBrush_t;
 
 typedef struct cQ2BspArea_s {
@@ -96,4 +95,5 @@ extern int					cm_q2_numClusters;
 // ==========================================================================
 
 void		CM_Q2BSP_InitBoxHull (void);
+void		CM_Q2BSP_BuildVisCache (void);
 void		CM_Q2BSP_FloodAreaConnections (void);
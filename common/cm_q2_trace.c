@@ -24,7 +24,6 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 
 #include "cm_q2_local.h"
 
-static int				cm_q2_checkCount;
 static int				cm_q2_floodValid;
 
 static cBspPlane_t		*cm_q2_boxPlanes;
@@ -32,21 +31,13 @@ static int				cm_q2_boxHeadNode;
 static cQ2BspBrush_t	*cm_q2_boxBrush;
 static cQ2BspLeaf_t		*cm_q2_boxLeaf;
 
-static int				cm_q2_leafCount, cm_q2_leafMaxCount;
-static int				*cm_q2_leafList;
-static float			*cm_q2_leafMins, *cm_q2_leafMaxs;
-static int				cm_q2_leafTopNode;
+static byte				*cm_q2_visRows;		// [numClusters*2][visRowStride], PVS rows then PHS rows
+static int				cm_q2_visRowStride;
+static uint64			cm_q2_nullRow[Q2BSP_MAX_VIS/8];
 
 // 1/32 epsilon to keep floating point happy
 #define DIST_EPSILON	(0.03125f)
 
-static trace_t			cm_q2_currentTrace;
-static vec3_t			cm_q2_traceStart, cm_q2_traceEnd;
-static vec3_t			cm_q2_traceMins, cm_q2_traceMaxs;
-static vec3_t			cm_q2_traceExtents;
-static int				cm_q2_traceContents;
-static qBool			cm_q2_traceIsPoint;		// optimized case
-
 /*
 =============================================================================
 
@@ -176,31 +167,67 @@ To keep everything totally uniform, bounding boxes are turned into small
 BSP trees instead of being compared directly.
 ===================
 */
-int	CM_Q2BSP_HeadnodeForBox (vec3_t mins, vec3_t maxs)
+int	CM_Q2BSP_HeadnodeForBox (cmTraceContext_t *ctx, vec3_t mins, vec3_t maxs)
 {
-	cm_q2_boxPlanes[0].dist = maxs[0];
-	cm_q2_boxPlanes[1].dist = -maxs[0];
-	cm_q2_boxPlanes[2].dist = mins[0];
-	cm_q2_boxPlanes[3].dist = -mins[0];
-	cm_q2_boxPlanes[4].dist = maxs[1];
-	cm_q2_boxPlanes[5].dist = -maxs[1];
-	cm_q2_boxPlanes[6].dist = mins[1];
-	cm_q2_boxPlanes[7].dist = -mins[1];
-	cm_q2_boxPlanes[8].dist = maxs[2];
-	cm_q2_boxPlanes[9].dist = -maxs[2];
-	cm_q2_boxPlanes[10].dist = mins[2];
-	cm_q2_boxPlanes[11].dist = -mins[2];
+	cBspPlane_t	*planes = ctx->boxPlanes;
+
+	planes[0].dist = maxs[0];
+	planes[1].dist = -maxs[0];
+	planes[2].dist = mins[0];
+	planes[3].dist = -mins[0];
+	planes[4].dist = maxs[1];
+	planes[5].dist = -maxs[1];
+	planes[6].dist = mins[1];
+	planes[7].dist = -mins[1];
+	planes[8].dist = maxs[2];
+	planes[9].dist = -maxs[2];
+	planes[10].dist = mins[2];
+	planes[11].dist = -mins[2];
 
 	return cm_q2_boxHeadNode;
 }
 
 
+/*
+===================
+CM_Q2BSP_InitTraceContext
+
+Called for every trace context after a map is loaded, and for contexts
+created while one is loaded. Sizes the brush check marks to the map and
+gives private contexts their own copy of the box hull planes.
+===================
+*/
+void CM_Q2BSP_InitTraceContext (cmTraceContext_t *ctx)
+{
+	if (ctx->numBrushChecks < cm_q2_numBrushes+1) {
+		if (ctx->brushChecks)
+			Mem_Free (ctx->brushChecks);
+		ctx->numBrushChecks = cm_q2_numBrushes+1;	// extra for box hull
+		ctx->brushChecks = Mem_Alloc (sizeof (int) * ctx->numBrushChecks);
+	}
+	else {
+		memset (ctx->brushChecks, 0, sizeof (int) * ctx->numBrushChecks);
+	}
+	ctx->checkCount = 0;
+
+	if (ctx == &cm_defaultTraceContext) {
+		ctx->boxPlanes = cm_q2_boxPlanes;
+	}
+	else {
+		memcpy (ctx->boxPlaneBuf, cm_q2_boxPlanes, sizeof (ctx->boxPlaneBuf));
+		ctx->boxPlanes = ctx->boxPlaneBuf;
+	}
+}
+
+
 /*
 ==================
 CM_Q2BSP_PointLeafnum_r
+
+Box hull nodes take their planes from ctx
 ==================
 */
-static int CM_Q2BSP_PointLeafnum_r (vec3_t p, int num)
+static int CM_Q2BSP_PointLeafnum_r (cmTraceContext_t *ctx, vec3_t p, int num)
 {
 	float			d;
 	cQ2BspNode_t	*node;
@@ -208,7 +235,10 @@ static int CM_Q2BSP_PointLeafnum_r (vec3_t p, int num)
 
 	while (num >= 0) {
 		node = cm_q2_nodes + num;
-		plane = node->plane;
+		if (num >= cm_q2_boxHeadNode)
+			plane = ctx->boxPlanes + (node->plane - cm_q2_boxPlanes);
+		else
+			plane = node->plane;
 
 		d = PlaneDiff (p, plane);
 		if (d < 0)
@@ -232,7 +262,7 @@ int CM_Q2BSP_PointLeafnum (vec3_t p)
 {
 	if (!cm_q2_numPlanes)
 		return 0;	// Sound may call this without map loaded
-	return CM_Q2BSP_PointLeafnum_r (p, 0);
+	return CM_Q2BSP_PointLeafnum_r (&cm_defaultTraceContext, p, 0);
 }
 
 
@@ -243,7 +273,7 @@ CM_Q2BSP_BoxLeafnums
 Fills in a list of all the leafs touched
 =============
 */
-static void CM_Q2BSP_BoxLeafnums_r (int nodeNum)
+static void CM_Q2BSP_BoxLeafnums_r (cmLeafList_t *ll, int nodeNum)
 {
 	cBspPlane_t		*plane;
 	cQ2BspNode_t	*node;
@@ -251,25 +281,28 @@ static void CM_Q2BSP_BoxLeafnums_r (int nodeNum)
 
 	for ( ; ; ) {
 		if (nodeNum < 0) {
-			if (cm_q2_leafCount >= cm_q2_leafMaxCount)
+			if (ll->count >= ll->maxCount)
 				return;
 
-			cm_q2_leafList[cm_q2_leafCount++] = -1 - nodeNum;
+			ll->list[ll->count++] = -1 - nodeNum;
 			return;
 		}
 	
 		node = &cm_q2_nodes[nodeNum];
-		plane = node->plane;
-		s = BOX_ON_PLANE_SIDE (cm_q2_leafMins, cm_q2_leafMaxs, plane);
+		if (nodeNum >= cm_q2_boxHeadNode)
+			plane = ll->ctx->boxPlanes + (node->plane - cm_q2_boxPlanes);
+		else
+			plane = node->plane;
+		s = BOX_ON_PLANE_SIDE (ll->mins, ll->maxs, plane);
 		if (s == 1)
 			nodeNum = node->children[0];
 		else if (s == 2)
 			nodeNum = node->children[1];
 		else {
 			// Go down both
-			if (cm_q2_leafTopNode == -1)
-				cm_q2_leafTopNode = nodeNum;
-			CM_Q2BSP_BoxLeafnums_r (node->children[0]);
+			if (ll->topNode == -1)
+				ll->topNode = nodeNum;
+			CM_Q2BSP_BoxLeafnums_r (ll, node->children[0]);
 			nodeNum = node->children[1];
 		}
 	}
@@ -281,21 +314,24 @@ static void CM_Q2BSP_BoxLeafnums_r (int nodeNum)
 CM_Q2BSP_BoxLeafnumsHeadNode
 ==================
 */
-static int CM_Q2BSP_BoxLeafnumsHeadNode (vec3_t mins, vec3_t maxs, int *list, int listSize, int headNode, int *topNode)
+static int CM_Q2BSP_BoxLeafnumsHeadNode (cmTraceContext_t *ctx, vec3_t mins, vec3_t maxs, int *list, int listSize, int headNode, int *topNode)
 {
-	cm_q2_leafList = list;
-	cm_q2_leafCount = 0;
-	cm_q2_leafMaxCount = listSize;
-	cm_q2_leafMins = mins;
-	cm_q2_leafMaxs = maxs;
-	cm_q2_leafTopNode = -1;
+	cmLeafList_t	ll;
+
+	ll.ctx = ctx;
+	ll.list = list;
+	ll.count = 0;
+	ll.maxCount = listSize;
+	ll.mins = mins;
+	ll.maxs = maxs;
+	ll.topNode = -1;
 
-	CM_Q2BSP_BoxLeafnums_r (headNode);
+	CM_Q2BSP_BoxLeafnums_r (&ll, headNode);
 
 	if (topNode)
-		*topNode = cm_q2_leafTopNode;
+		*topNode = ll.topNode;
 
-	return cm_q2_leafCount;
+	return ll.count;
 }
 
 
@@ -306,7 +342,7 @@ CM_Q2BSP_BoxLeafnums
 */
 int	CM_Q2BSP_BoxLeafnums (vec3_t mins, vec3_t maxs, int *list, int listSize, int *topNode)
 {
-	return CM_Q2BSP_BoxLeafnumsHeadNode (mins, maxs, list, listSize, cm_mapCModels[0].headNode, topNode);
+	return CM_Q2BSP_BoxLeafnumsHeadNode (&cm_defaultTraceContext, mins, maxs, list, listSize, cm_mapCModels[0].headNode, topNode);
 }
 
 
@@ -322,7 +358,7 @@ int CM_Q2BSP_PointContents (vec3_t p, int headNode)
 	if (!cm_q2_numNodes)	// Map not loaded
 		return 0;
 
-	l = CM_Q2BSP_PointLeafnum_r (p, headNode);
+	l = CM_Q2BSP_PointLeafnum_r (&cm_defaultTraceContext, p, headNode);
 
 	return cm_q2_leafs[l].contents;
 }
@@ -355,7 +391,7 @@ int	CM_Q2BSP_TransformedPointContents (vec3_t p, int headNode, vec3_t origin, ve
 		dist[2] = DotProduct (temp, up);
 	}
 
-	l = CM_Q2BSP_PointLeafnum_r (dist, headNode);
+	l = CM_Q2BSP_PointLeafnum_r (&cm_defaultTraceContext, dist, headNode);
 
 	return cm_q2_leafs[l].contents;
 }
@@ -373,7 +409,7 @@ int	CM_Q2BSP_TransformedPointContents (vec3_t p, int headNode, vec3_t origin, ve
 CM_Q2BSP_ClipBoxToBrush
 ================
 */
-static void CM_Q2BSP_ClipBoxToBrush (cQ2BspBrush_t *brush)
+static void CM_Q2BSP_ClipBoxToBrush (cmTraceContext_t *ctx, cQ2BspBrush_t *brush)
 {
 	int					i, j;
 	cBspPlane_t			*p, *clipPlane;
@@ -390,7 +426,7 @@ static void CM_Q2BSP_ClipBoxToBrush (cQ2BspBrush_t *brush)
 	if (!brush->numSides)
 		return;
 
-	cm_numBrushTraces++;
+	ctx->numBrushTraces++;
 
 	getOut = qFalse;
 	startOut = qFalse;
@@ -398,17 +434,19 @@ static void CM_Q2BSP_ClipBoxToBrush (cQ2BspBrush_t *brush)
 
 	for (i=0, side=&cm_q2_brushSides[brush->firstBrushSide] ; i<brush->numSides ; side++, i++) 	{
 		p = side->plane;
+		if (brush == cm_q2_boxBrush)
+			p = ctx->boxPlanes + (p - cm_q2_boxPlanes);
 
 		// FIXME: special case for axial
-		if (!cm_q2_traceIsPoint) {
+		if (!ctx->isPoint) {
 			// general box case
 			// push the plane out apropriately for mins/maxs
 			// FIXME: use signBits into 8 way lookup for each mins/maxs
 			for (j=0 ; j<3 ; j++) {
 				if (p->normal[j] < 0)
-					ofs[j] = cm_q2_traceMaxs[j];
+					ofs[j] = ctx->maxs[j];
 				else
-					ofs[j] = cm_q2_traceMins[j];
+					ofs[j] = ctx->mins[j];
 			}
 			dist = DotProduct (ofs, p->normal);
 			dist = p->dist - dist;
@@ -418,8 +456,8 @@ static void CM_Q2BSP_ClipBoxToBrush (cQ2BspBrush_t *brush)
 			dist = p->dist;
 		}
 
-		dot1 = DotProduct (cm_q2_traceStart, p->normal) - dist;
-		dot2 = DotProduct (cm_q2_traceEnd, p->normal) - dist;
+		dot1 = DotProduct (ctx->start, p->normal) - dist;
+		dot2 = DotProduct (ctx->end, p->normal) - dist;
 
 		if (dot2 > 0)
 			getOut = qTrue;	// Endpoint is not in solid
@@ -454,20 +492,20 @@ static void CM_Q2BSP_ClipBoxToBrush (cQ2BspBrush_t *brush)
 
 	if (!startOut) {
 		// Original point was inside brush
-		cm_q2_currentTrace.startSolid = qTrue;
+		ctx->trace.startSolid = qTrue;
 		if (!getOut)
-			cm_q2_currentTrace.allSolid = qTrue;
+			ctx->trace.allSolid = qTrue;
 		return;
 	}
 
-	if (enterFrac < leaveFrac && enterFrac > -1 && enterFrac < cm_q2_currentTrace.fraction) {
+	if (enterFrac < leaveFrac && enterFrac > -1 && enterFrac < ctx->trace.fraction) {
 		if (enterFrac < 0)
 			enterFrac = 0;
 
-		cm_q2_currentTrace.fraction = enterFrac;
-		cm_q2_currentTrace.plane = *clipPlane;
-		cm_q2_currentTrace.surface = leadSide->surface;
-		cm_q2_currentTrace.contents = brush->contents;
+		ctx->trace.fraction = enterFrac;
+		ctx->trace.plane = *clipPlane;
+		ctx->trace.surface = leadSide->surface;
+		ctx->trace.contents = brush->contents;
 	}
 }
 
@@ -477,7 +515,7 @@ static void CM_Q2BSP_ClipBoxToBrush (cQ2BspBrush_t *brush)
 CM_Q2BSP_ClipBoxes
 ================
 */
-static void CM_Q2BSP_ClipBoxes (int leafNum)
+static void CM_Q2BSP_ClipBoxes (cmTraceContext_t *ctx, int leafNum)
 {
 	cQ2BspLeaf_t	*leaf;
 	cQ2BspBrush_t	*brush;
@@ -485,7 +523,7 @@ static void CM_Q2BSP_ClipBoxes (int leafNum)
 	int				k;
 
 	leaf = &cm_q2_leafs[leafNum];
-	if (!(leaf->contents & cm_q2_traceContents))
+	if (!(leaf->contents & ctx->contents))
 		return;
 
 	// Trace line against all brushes in the leaf
@@ -493,14 +531,14 @@ static void CM_Q2BSP_ClipBoxes (int leafNum)
 		brushNum = cm_q2_leafBrushes[leaf->firstLeafBrush+k];
 		brush = &cm_q2_brushes[brushNum];
 
-		if (brush->checkCount == cm_q2_checkCount)
+		if (ctx->brushChecks[brushNum] == ctx->checkCount)
 			continue;	// Already checked this brush in another leaf
-		brush->checkCount = cm_q2_checkCount;
-		if (!(brush->contents & cm_q2_traceContents))
+		ctx->brushChecks[brushNum] = ctx->checkCount;
+		if (!(brush->contents & ctx->contents))
 			continue;
 
-		CM_Q2BSP_ClipBoxToBrush (brush);
-		if (!cm_q2_currentTrace.fraction)
+		CM_Q2BSP_ClipBoxToBrush (ctx, brush);
+		if (!ctx->trace.fraction)
 			return;
 	}
 }
@@ -511,7 +549,7 @@ static void CM_Q2BSP_ClipBoxes (int leafNum)
 CM_Q2BSP_TestBoxInBrush
 ================
 */
-static void CM_Q2BSP_TestBoxInBrush (cQ2BspBrush_t *brush)
+static void CM_Q2BSP_TestBoxInBrush (cmTraceContext_t *ctx, cQ2BspBrush_t *brush)
 {
 	int					i, j;
 	vec3_t				ofs;
@@ -524,6 +562,8 @@ static void CM_Q2BSP_TestBoxInBrush (cQ2BspBrush_t *brush)
 
 	for (i=0, side=&cm_q2_brushSides[brush->firstBrushSide] ; i<brush->numSides ; side++, i++) {
 		p = side->plane;
+		if (brush == cm_q2_boxBrush)
+			p = ctx->boxPlanes + (p - cm_q2_boxPlanes);
 
 		// FIXME: special case for axial
 		// general box case
@@ -531,13 +571,13 @@ static void CM_Q2BSP_TestBoxInBrush (cQ2BspBrush_t *brush)
 		// FIXME: use signBits into 8 way lookup for each mins/maxs
 		for (j=0 ; j<3 ; j++) {
 			if (p->normal[j] < 0)
-				ofs[j] = cm_q2_traceMaxs[j];
+				ofs[j] = ctx->maxs[j];
 			else
-				ofs[j] = cm_q2_traceMins[j];
+				ofs[j] = ctx->mins[j];
 		}
 
 		dist = p->dist - DotProduct (ofs, p->normal);
-		dot = DotProduct (cm_q2_traceStart, p->normal) - dist;
+		dot = DotProduct (ctx->start, p->normal) - dist;
 
 		// If completely in front of face, no intersection
 		if (dot > 0)
@@ -545,9 +585,9 @@ static void CM_Q2BSP_TestBoxInBrush (cQ2BspBrush_t *brush)
 	}
 
 	// Inside this brush
-	cm_q2_currentTrace.startSolid = cm_q2_currentTrace.allSolid = qTrue;
-	cm_q2_currentTrace.fraction = 0;
-	cm_q2_currentTrace.contents = brush->contents;
+	ctx->trace.startSolid = ctx->trace.allSolid = qTrue;
+	ctx->trace.fraction = 0;
+	ctx->trace.contents = brush->contents;
 }
 
 
@@ -556,7 +596,7 @@ static void CM_Q2BSP_TestBoxInBrush (cQ2BspBrush_t *brush)
 CM_Q2BSP_TestBoxes
 ================
 */
-static void CM_Q2BSP_TestBoxes (int leafNum)
+static void CM_Q2BSP_TestBoxes (cmTraceContext_t *ctx, int leafNum)
 {
 	cQ2BspLeaf_t	*leaf;
 	cQ2BspBrush_t	*brush;
@@ -564,7 +604,7 @@ static void CM_Q2BSP_TestBoxes (int leafNum)
 	int				k;
 
 	leaf = &cm_q2_leafs[leafNum];
-	if (!(leaf->contents & cm_q2_traceContents))
+	if (!(leaf->contents & ctx->contents))
 		return;
 
 	// Trace line against all brushes in the leaf
@@ -572,14 +612,14 @@ static void CM_Q2BSP_TestBoxes (int leafNum)
 		brushNum = cm_q2_leafBrushes[leaf->firstLeafBrush+k];
 		brush = &cm_q2_brushes[brushNum];
 
-		if (brush->checkCount == cm_q2_checkCount)
+		if (ctx->brushChecks[brushNum] == ctx->checkCount)
 			continue;	// Already checked this brush in another leaf
-		brush->checkCount = cm_q2_checkCount;
-		if (!(brush->contents & cm_q2_traceContents))
+		ctx->brushChecks[brushNum] = ctx->checkCount;
+		if (!(brush->contents & ctx->contents))
 			continue;
 
-		CM_Q2BSP_TestBoxInBrush (brush);
-		if (!cm_q2_currentTrace.fraction)
+		CM_Q2BSP_TestBoxInBrush (ctx, brush);
+		if (!ctx->trace.fraction)
 			return;
 	}
 }
@@ -590,7 +630,7 @@ static void CM_Q2BSP_TestBoxes (int leafNum)
 CM_Q2BSP_RecursiveHullCheck
 ==================
 */
-static void CM_Q2BSP_RecursiveHullCheck (int num, float p1f, float p2f, vec3_t p1, vec3_t p2)
+static void CM_Q2BSP_RecursiveHullCheck (cmTraceContext_t *ctx, int num, float p1f, float p2f, vec3_t p1, vec3_t p2)
 {
 	cQ2BspNode_t	*node;
 	cBspPlane_t		*plane;
@@ -601,12 +641,12 @@ static void CM_Q2BSP_RecursiveHullCheck (int num, float p1f, float p2f, vec3_t p
 	vec3_t			mid;
 	float			midf;
 
-	if (cm_q2_currentTrace.fraction <= p1f)
+	if (ctx->trace.fraction <= p1f)
 		return;		// already hit something nearer
 
 	// if < 0, we are in a leaf node
 	if (num < 0) {
-		CM_Q2BSP_ClipBoxes (-1-num);
+		CM_Q2BSP_ClipBoxes (ctx, -1-num);
 		return;
 	}
 
@@ -615,31 +655,34 @@ static void CM_Q2BSP_RecursiveHullCheck (int num, float p1f, float p2f, vec3_t p
 	** and the offset for the size of the box
 	*/
 	node = cm_q2_nodes + num;
-	plane = node->plane;
+	if (num >= cm_q2_boxHeadNode)
+		plane = ctx->boxPlanes + (node->plane - cm_q2_boxPlanes);
+	else
+		plane = node->plane;
 
 	if (plane->type < 3) {
 		t1 = p1[plane->type] - plane->dist;
 		t2 = p2[plane->type] - plane->dist;
-		offset = cm_q2_traceExtents[plane->type];
+		offset = ctx->extents[plane->type];
 	}
 	else {
 		t1 = DotProduct (plane->normal, p1) - plane->dist;
 		t2 = DotProduct (plane->normal, p2) - plane->dist;
-		if (cm_q2_traceIsPoint)
+		if (ctx->isPoint)
 			offset = 0;
 		else
-			offset = fabs (cm_q2_traceExtents[0]*plane->normal[0])
-				+ fabs (cm_q2_traceExtents[1]*plane->normal[1])
-				+ fabs (cm_q2_traceExtents[2]*plane->normal[2]);
+			offset = fabs (ctx->extents[0]*plane->normal[0])
+				+ fabs (ctx->extents[1]*plane->normal[1])
+				+ fabs (ctx->extents[2]*plane->normal[2]);
 	}
 
 	// see which sides we need to consider
 	if (t1 >= offset && t2 >= offset) {
-		CM_Q2BSP_RecursiveHullCheck (node->children[0], p1f, p2f, p1, p2);
+		CM_Q2BSP_RecursiveHullCheck (ctx, node->children[0], p1f, p2f, p1, p2);
 		return;
 	}
 	if (t1 < -offset && t2 < -offset) {
-		CM_Q2BSP_RecursiveHullCheck (node->children[1], p1f, p2f, p1, p2);
+		CM_Q2BSP_RecursiveHullCheck (ctx, node->children[1], p1f, p2f, p1, p2);
 		return;
 	}
 
@@ -668,7 +711,7 @@ static void CM_Q2BSP_RecursiveHullCheck (int num, float p1f, float p2f, vec3_t p
 	for (i=0 ; i<3 ; i++)
 		mid[i] = p1[i] + frac * (p2[i] - p1[i]);
 
-	CM_Q2BSP_RecursiveHullCheck (node->children[side], p1f, midf, p1, mid);
+	CM_Q2BSP_RecursiveHullCheck (ctx, node->children[side], p1f, midf, p1, mid);
 
 	// go past the node
 	frac2 = clamp (frac2, 0, 1);
@@ -676,7 +719,7 @@ static void CM_Q2BSP_RecursiveHullCheck (int num, float p1f, float p2f, vec3_t p
 	for (i=0 ; i<3 ; i++)
 		mid[i] = p1[i] + frac2 * (p2[i] - p1[i]);
 
-	CM_Q2BSP_RecursiveHullCheck (node->children[side^1], midf, p2f, mid, p2);
+	CM_Q2BSP_RecursiveHullCheck (ctx, node->children[side^1], midf, p2f, mid, p2);
 }
 
 // ==========================================================================
@@ -686,14 +729,14 @@ static void CM_Q2BSP_RecursiveHullCheck (int num, float p1f, float p2f, vec3_t p
 CM_Q2BSP_Trace
 ====================
 */
-trace_t CM_Q2BSP_Trace (vec3_t start, vec3_t end, float size, int contentMask)
+trace_t CM_Q2BSP_Trace (cmTraceContext_t *ctx, vec3_t start, vec3_t end, float size, int contentMask)
 {
 	vec3_t maxs, mins;
 
 	Vec3Set (maxs, size, size, size);
 	Vec3Set (mins, -size, -size, -size);
 
-	return CM_Q2BSP_BoxTrace (start, end, mins, maxs, 0, contentMask);
+	return CM_Q2BSP_BoxTrace (ctx, start, end, mins, maxs, 0, contentMask);
 }
 
 
@@ -702,32 +745,32 @@ trace_t CM_Q2BSP_Trace (vec3_t start, vec3_t end, float size, int contentMask)
 CM_Q2BSP_BoxTrace
 ==================
 */
-trace_t CM_Q2BSP_BoxTrace (vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs, int headNode, int brushMask)
+trace_t CM_Q2BSP_BoxTrace (cmTraceContext_t *ctx, vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs, int headNode, int brushMask)
 {
-	cm_q2_checkCount++;	// For multi-check avoidance
-	cm_numTraces++;		// For statistics, may be zeroed
+	ctx->checkCount++;	// For multi-check avoidance
+	ctx->numTraces++;	// For statistics, may be zeroed
 
 	// Fill in a default trace
-	cm_q2_currentTrace.allSolid = qFalse;
-	cm_q2_currentTrace.contents = 0;
-	Vec3Clear (cm_q2_currentTrace.endPos);
-	cm_q2_currentTrace.ent = NULL;
-	cm_q2_currentTrace.fraction = 1;
-	cm_q2_currentTrace.plane.dist = 0;
-	Vec3Clear (cm_q2_currentTrace.plane.normal);
-	cm_q2_currentTrace.plane.signBits = 0;
-	cm_q2_currentTrace.plane.type = 0;
-	cm_q2_currentTrace.startSolid = qFalse;
-	cm_q2_currentTrace.surface = &cm_q2_nullSurface;
+	ctx->trace.allSolid = qFalse;
+	ctx->trace.contents = 0;
+	Vec3Clear (ctx->trace.endPos);
+	ctx->trace.ent = NULL;
+	ctx->trace.fraction = 1;
+	ctx->trace.plane.dist = 0;
+	Vec3Clear (ctx->trace.plane.normal);
+	ctx->trace.plane.signBits = 0;
+	ctx->trace.plane.type = 0;
+	ctx->trace.startSolid = qFalse;
+	ctx->trace.surface = &cm_q2_nullSurface;
 
 	if (!cm_q2_numNodes)	// Map not loaded
-		return cm_q2_currentTrace;
+		return ctx->trace;
 
-	cm_q2_traceContents = brushMask;
-	Vec3Copy (start, cm_q2_traceStart);
-	Vec3Copy (end, cm_q2_traceEnd);
-	Vec3Copy (mins, cm_q2_traceMins);
-	Vec3Copy (maxs, cm_q2_traceMaxs);
+	ctx->contents = brushMask;
+	Vec3Copy (start, ctx->start);
+	Vec3Copy (end, ctx->end);
+	Vec3Copy (mins, ctx->mins);
+	Vec3Copy (maxs, ctx->maxs);
 
 	// Check for position test special case
 	if (Vec3Compare (start, end)) {
@@ -743,41 +786,41 @@ trace_t CM_Q2BSP_BoxTrace (vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs, i
 			c2[i] += 1;
 		}
 
-		numLeafs = CM_Q2BSP_BoxLeafnumsHeadNode (c1, c2, leafs, 1024, headNode, &topNode);
+		numLeafs = CM_Q2BSP_BoxLeafnumsHeadNode (ctx, c1, c2, leafs, 1024, headNode, &topNode);
 		for (i=0 ; i<numLeafs ; i++) {
-			CM_Q2BSP_TestBoxes (leafs[i]);
-			if (cm_q2_currentTrace.allSolid)
+			CM_Q2BSP_TestBoxes (ctx, leafs[i]);
+			if (ctx->trace.allSolid)
 				break;
 		}
-		Vec3Copy (start, cm_q2_currentTrace.endPos);
-		return cm_q2_currentTrace;
+		Vec3Copy (start, ctx->trace.endPos);
+		return ctx->trace;
 	}
 
 	// Check for point special case
 	if (Vec3Compare (mins, vec3Origin) && Vec3Compare (maxs, vec3Origin)) {
-		cm_q2_traceIsPoint = qTrue;
-		Vec3Clear (cm_q2_traceExtents);
+		ctx->isPoint = qTrue;
+		Vec3Clear (ctx->extents);
 	}
 	else {
-		cm_q2_traceIsPoint = qFalse;
-		cm_q2_traceExtents[0] = -mins[0] > maxs[0] ? -mins[0] : maxs[0];
-		cm_q2_traceExtents[1] = -mins[1] > maxs[1] ? -mins[1] : maxs[1];
-		cm_q2_traceExtents[2] = -mins[2] > maxs[2] ? -mins[2] : maxs[2];
+		ctx->isPoint = qFalse;
+		ctx->extents[0] = -mins[0] > maxs[0] ? -mins[0] : maxs[0];
+		ctx->extents[1] = -mins[1] > maxs[1] ? -mins[1] : maxs[1];
+		ctx->extents[2] = -mins[2] > maxs[2] ? -mins[2] : maxs[2];
 	}
 
 	// General sweeping through world
-	CM_Q2BSP_RecursiveHullCheck (headNode, 0, 1, start, end);
+	CM_Q2BSP_RecursiveHullCheck (ctx, headNode, 0, 1, start, end);
 
-	if (cm_q2_currentTrace.fraction == 1) {
-		Vec3Copy (end, cm_q2_currentTrace.endPos);
+	if (ctx->trace.fraction == 1) {
+		Vec3Copy (end, ctx->trace.endPos);
 	}
 	else {
-		cm_q2_currentTrace.endPos[0] = start[0] + cm_q2_currentTrace.fraction * (end[0] - start[0]);
-		cm_q2_currentTrace.endPos[1] = start[1] + cm_q2_currentTrace.fraction * (end[1] - start[1]);
-		cm_q2_currentTrace.endPos[2] = start[2] + cm_q2_currentTrace.fraction * (end[2] - start[2]);
+		ctx->trace.endPos[0] = start[0] + ctx->trace.fraction * (end[0] - start[0]);
+		ctx->trace.endPos[1] = start[1] + ctx->trace.fraction * (end[1] - start[1]);
+		ctx->trace.endPos[2] = start[2] + ctx->trace.fraction * (end[2] - start[2]);
 	}
 
-	return cm_q2_currentTrace;
+	return ctx->trace;
 }
 
 
@@ -791,7 +834,7 @@ Handles offseting and rotation of the end points for moving and rotating entitie
 #ifdef _WIN32
 #pragma optimize ("", off)
 #endif
-void CM_Q2BSP_TransformedBoxTrace (trace_t *out, vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs, int headNode, int brushMask, vec3_t origin, vec3_t angles)
+void CM_Q2BSP_TransformedBoxTrace (cmTraceContext_t *ctx, trace_t *out, vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs, int headNode, int brushMask, vec3_t origin, vec3_t angles)
 {
 	vec3_t		start_l, end_l;
 	vec3_t		forward, right, up;
@@ -823,7 +866,7 @@ void CM_Q2BSP_TransformedBoxTrace (trace_t *out, vec3_t start, vec3_t end, vec3_
 	}
 
 	// Sweep the box through the model
-	*out = CM_Q2BSP_BoxTrace (start_l, end_l, mins, maxs, headNode, brushMask);
+	*out = CM_Q2BSP_BoxTrace (ctx, start_l, end_l, mins, maxs, headNode, brushMask);
 
 	if (rotated && out->fraction != 1.0) {
 		// FIXME: figure out how to do this with existing angles
@@ -896,19 +939,59 @@ static void CM_Q2BSP_DecompressVis (byte *in, byte *out)
 }
 
 
+/*
+===================
+CM_Q2BSP_BuildVisCache
+
+Decompresses every PVS and PHS row once at load, so the cluster queries
+return shared read-only rows instead of decompressing per call. Rows are
+padded to 64 bits so they can be combined a word at a time. Maps whose
+rows don't fit in cm_visCacheSize fall back to decompressing on demand.
+===================
+*/
+void CM_Q2BSP_BuildVisCache (void)
+{
+	size_t	size;
+	byte	*in;
+	int		i;
+
+	cm_q2_visRows = NULL;
+	cm_q2_visRowStride = ((cm_q2_numClusters + 63) >> 6) << 3;
+	if (!cm_q2_visData)
+		return;
+
+	size = (size_t)cm_q2_visRowStride * cm_q2_numClusters * 2;
+	if (size > (size_t)cm_visCacheSize->intVal * 1024) {
+		Com_DevPrintf (PRNT_WARNING, "CM_Q2BSP_BuildVisCache: %uKB of vis rows is over cm_visCacheSize, decompressing on demand\n", (uint32)(size >> 10));
+		return;
+	}
+
+	cm_q2_visRows = Mem_PoolAlloc (size, com_cmodelSysPool, 0);
+	for (i=0 ; i<cm_q2_numClusters ; i++) {
+		in = cm_q2_numVisibility ? (byte *)cm_q2_visData + cm_q2_visData->bitOfs[i][Q2BSP_VIS_PVS] : NULL;
+		CM_Q2BSP_DecompressVis (in, cm_q2_visRows + i*cm_q2_visRowStride);
+
+		in = cm_q2_numVisibility ? (byte *)cm_q2_visData + cm_q2_visData->bitOfs[i][Q2BSP_VIS_PHS] : NULL;
+		CM_Q2BSP_DecompressVis (in, cm_q2_visRows + (cm_q2_numClusters+i)*cm_q2_visRowStride);
+	}
+}
+
+
 /*
 ===================
 CM_Q2BSP_ClusterPVS
 ===================
 */
-byte *CM_Q2BSP_ClusterPVS (int cluster)
+const byte *CM_Q2BSP_ClusterPVS (int cluster)
 {
 	static byte		pvsRow[Q2BSP_MAX_VIS];
 
 	if (cluster == -1 || !cm_q2_visData)
-		memset (pvsRow, 0, (cm_q2_numClusters + 7) >> 3);
-	else
-		CM_Q2BSP_DecompressVis ((byte *)cm_q2_visData + cm_q2_visData->bitOfs[cluster][Q2BSP_VIS_PVS], pvsRow);
+		return (byte *)cm_q2_nullRow;
+	if (cm_q2_visRows)
+		return cm_q2_visRows + cluster*cm_q2_visRowStride;
+
+	CM_Q2BSP_DecompressVis ((byte *)cm_q2_visData + cm_q2_visData->bitOfs[cluster][Q2BSP_VIS_PVS], pvsRow);
 	return pvsRow;
 }
 
@@ -918,14 +1001,16 @@ byte *CM_Q2BSP_ClusterPVS (int cluster)
 CM_Q2BSP_ClusterPHS
 ===================
 */
-byte *CM_Q2BSP_ClusterPHS (int cluster)
+const byte *CM_Q2BSP_ClusterPHS (int cluster)
 {
 	static byte		phsRow[Q2BSP_MAX_VIS];
 
 	if (cluster == -1 || !cm_q2_visData)
-		memset (phsRow, 0, (cm_q2_numClusters + 7) >> 3);
-	else
-		CM_Q2BSP_DecompressVis ((byte *)cm_q2_visData + cm_q2_visData->bitOfs[cluster][Q2BSP_VIS_PHS], phsRow);
+		return (byte *)cm_q2_nullRow;
+	if (cm_q2_visRows)
+		return cm_q2_visRows + (cm_q2_numClusters+cluster)*cm_q2_visRowStride;
+
+	CM_Q2BSP_DecompressVis ((byte *)cm_q2_visData + cm_q2_visData->bitOfs[cluster][Q2BSP_VIS_PHS], phsRow);
 	return phsRow;
 }
 
@@ -1086,7 +1171,7 @@ CM_Q2BSP_HeadnodeVisible
 Returns qTrue if any leaf under headnode has a cluster that is potentially visible
 =============
 */
-qBool CM_Q2BSP_HeadnodeVisible (int nodeNum, byte *visBits)
+qBool CM_Q2BSP_HeadnodeVisible (int nodeNum, const byte *visBits)
 {
 	cQ2BspNode_t	*node;
 	int				leafNum;
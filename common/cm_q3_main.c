@@ -1014,13 +1014,13 @@ static void CM_Q3BSP_CalcPHS (void)
 	int		i, j, k, l, index;
 	int		bitbyte;
 	uint32	*dest, *src;
-	byte	*scan;
+	const byte	*scan;
 	int		count, vcount;
 	int		numClusters;
 
 	Com_DevPrintf (0, "CM_Q3BSP_CalcPHS: Building PHS...\n");
 
-	rowwords = cm_q3_visData->rowSize / sizeof(long);
+	rowwords = cm_q3_visData->rowSize / sizeof(uint32);
 	rowbytes = cm_q3_visData->rowSize;
 
 	memset (cm_q3_hearData, 0, MAX_Q3BSP_CM_VISIBILITY);
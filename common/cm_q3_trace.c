@@ -24,7 +24,6 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 
 #include "cm_q3_local.h"
 
-static int			cm_q3_checkCount;
 static int			cm_q3_floodValid;
 
 static cBspPlane_t	*cm_q3_boxPlanes;
@@ -32,23 +31,9 @@ static int			cm_q3_boxHeadNode;
 static cbrush_t		*cm_q3_boxBrush;
 static cleaf_t		*cm_q3_boxLeaf;
 
-static int			cm_q3_leafCount, cm_q3_leafMaxCount;
-static int			*cm_q3_leafList;
-static float		*cm_q3_leafMins, *cm_q3_leafMaxs;
-static int			cm_q3_leafTopNode;
-
 // 1/32 epsilon to keep floating point happy
 #define DIST_EPSILON	(0.03125f)
 
-static trace_t		cm_q3_currentTrace;
-static vec3_t		cm_q3_traceStart, cm_q3_traceStartMins, cm_q3_traceStartMaxs;
-static vec3_t		cm_q3_traceEnd, cm_q3_traceEndMins, cm_q3_traceEndMaxs;
-static vec3_t		cm_q3_traceMins, cm_q3_traceMaxs;
-static vec3_t		cm_q3_traceAbsMins, cm_q3_traceAbsMaxs;
-static vec3_t		cm_q3_traceExtents;
-static int			cm_q3_traceContents;
-static qBool		cm_q3_traceIsPoint;		// Optimized case
-
 /*
 =============================================================================
 
@@ -172,31 +157,77 @@ void CM_Q3BSP_InitBoxHull (void)
 CM_Q3BSP_HeadnodeForBox
 ===================
 */
-int	CM_Q3BSP_HeadnodeForBox (vec3_t mins, vec3_t maxs)
+int	CM_Q3BSP_HeadnodeForBox (cmTraceContext_t *ctx, vec3_t mins, vec3_t maxs)
 {
-	cm_q3_boxPlanes[0].dist = maxs[0];
-	cm_q3_boxPlanes[1].dist = -maxs[0];
-	cm_q3_boxPlanes[2].dist = mins[0];
-	cm_q3_boxPlanes[3].dist = -mins[0];
-	cm_q3_boxPlanes[4].dist = maxs[1];
-	cm_q3_boxPlanes[5].dist = -maxs[1];
-	cm_q3_boxPlanes[6].dist = mins[1];
-	cm_q3_boxPlanes[7].dist = -mins[1];
-	cm_q3_boxPlanes[8].dist = maxs[2];
-	cm_q3_boxPlanes[9].dist = -maxs[2];
-	cm_q3_boxPlanes[10].dist = mins[2];
-	cm_q3_boxPlanes[11].dist = -mins[2];
+	cBspPlane_t	*planes = ctx->boxPlanes;
+
+	planes[0].dist = maxs[0];
+	planes[1].dist = -maxs[0];
+	planes[2].dist = mins[0];
+	planes[3].dist = -mins[0];
+	planes[4].dist = maxs[1];
+	planes[5].dist = -maxs[1];
+	planes[6].dist = mins[1];
+	planes[7].dist = -mins[1];
+	planes[8].dist = maxs[2];
+	planes[9].dist = -maxs[2];
+	planes[10].dist = mins[2];
+	planes[11].dist = -mins[2];
 
 	return cm_q3_boxHeadNode;
 }
 
 
+/*
+===================
+CM_Q3BSP_InitTraceContext
+
+Called for every trace context after a map is loaded, and for contexts
+created while one is loaded. Sizes the brush and patch check marks to the
+map and gives private contexts their own copy of the box hull planes.
+===================
+*/
+void CM_Q3BSP_InitTraceContext (cmTraceContext_t *ctx)
+{
+	if (ctx->numBrushChecks < cm_q3_numBrushes+1) {
+		if (ctx->brushChecks)
+			Mem_Free (ctx->brushChecks);
+		ctx->numBrushChecks = cm_q3_numBrushes+1;	// extra for box hull
+		ctx->brushChecks = Mem_Alloc (sizeof (int) * ctx->numBrushChecks);
+	}
+	else {
+		memset (ctx->brushChecks, 0, sizeof (int) * ctx->numBrushChecks);
+	}
+
+	if (ctx->numPatchChecks < cm_q3_numPatches || !ctx->patchChecks) {
+		if (ctx->patchChecks)
+			Mem_Free (ctx->patchChecks);
+		ctx->numPatchChecks = max (cm_q3_numPatches, 1);
+		ctx->patchChecks = Mem_Alloc (sizeof (int) * ctx->numPatchChecks);
+	}
+	else {
+		memset (ctx->patchChecks, 0, sizeof (int) * ctx->numPatchChecks);
+	}
+	ctx->checkCount = 0;
+
+	if (ctx == &cm_defaultTraceContext) {
+		ctx->boxPlanes = cm_q3_boxPlanes;
+	}
+	else {
+		memcpy (ctx->boxPlaneBuf, cm_q3_boxPlanes, sizeof (ctx->boxPlaneBuf));
+		ctx->boxPlanes = ctx->boxPlaneBuf;
+	}
+}
+
+
 /*
 ==================
 CM_Q3BSP_PointLeafnum
+
+Box hull nodes take their planes from ctx
 ==================
 */
-int CM_PointLeafnum_r (vec3_t p, int num)
+static int CM_PointLeafnum_r (cmTraceContext_t *ctx, vec3_t p, int num)
 {
 	float		d;
 	cnode_t		*node;
@@ -204,7 +235,10 @@ int CM_PointLeafnum_r (vec3_t p, int num)
 
 	while (num >= 0) {
 		node = cm_q3_nodes + num;
-		plane = node->plane;
+		if (num >= cm_q3_boxHeadNode)
+			plane = ctx->boxPlanes + (node->plane - cm_q3_boxPlanes);
+		else
+			plane = node->plane;
 		d = PlaneDiff (p, plane);
 
 		if (d < 0)
@@ -221,7 +255,7 @@ int CM_Q3BSP_PointLeafnum (vec3_t p)
 {
 	if (!cm_q3_numPlanes)
 		return 0;		// Sound may call this without map loaded
-	return CM_PointLeafnum_r (p, 0);
+	return CM_PointLeafnum_r (&cm_defaultTraceContext, p, 0);
 }
 
 
@@ -230,22 +264,27 @@ int CM_Q3BSP_PointLeafnum (vec3_t p)
 CM_Q3BSP_BoxLeafnums
 ==================
 */
-static void CM_Q3BSP_BoxLeafnums_r (int nodeNum)
+static void CM_Q3BSP_BoxLeafnums_r (cmLeafList_t *ll, int nodeNum)
 {
-	cnode_t	*node;
-	int		s;
+	cnode_t		*node;
+	cBspPlane_t	*plane;
+	int			s;
 
 	for ( ; ; ) {
 		if (nodeNum < 0) {
-			if (cm_q3_leafCount >= cm_q3_leafMaxCount)
+			if (ll->count >= ll->maxCount)
 				return;
 
-			cm_q3_leafList[cm_q3_leafCount++] = -1 - nodeNum;
+			ll->list[ll->count++] = -1 - nodeNum;
 			return;
 		}
 	
 		node = &cm_q3_nodes[nodeNum];
-		s = BoxOnPlaneSide (cm_q3_leafMins, cm_q3_leafMaxs, node->plane);
+		if (nodeNum >= cm_q3_boxHeadNode)
+			plane = ll->ctx->boxPlanes + (node->plane - cm_q3_boxPlanes);
+		else
+			plane = node->plane;
+		s = BoxOnPlaneSide (ll->mins, ll->maxs, plane);
 
 		if (s == 1) {
 			nodeNum = node->children[0];
@@ -255,32 +294,35 @@ static void CM_Q3BSP_BoxLeafnums_r (int nodeNum)
 		}
 		else {
 			// Go down both
-			if (cm_q3_leafTopNode == -1)
-				cm_q3_leafTopNode = nodeNum;
-			CM_Q3BSP_BoxLeafnums_r (node->children[0]);
+			if (ll->topNode == -1)
+				ll->topNode = nodeNum;
+			CM_Q3BSP_BoxLeafnums_r (ll, node->children[0]);
 			nodeNum = node->children[1];
 		}
 	}
 }
-static int CM_Q3BSP_BoxLeafnums_headnode (vec3_t mins, vec3_t maxs, int *list, int listSize, int headNode, int *topNode)
+static int CM_Q3BSP_BoxLeafnums_headnode (cmTraceContext_t *ctx, vec3_t mins, vec3_t maxs, int *list, int listSize, int headNode, int *topNode)
 {
-	cm_q3_leafList = list;
-	cm_q3_leafCount = 0;
-	cm_q3_leafMaxCount = listSize;
-	cm_q3_leafMins = mins;
-	cm_q3_leafMaxs = maxs;
-	cm_q3_leafTopNode = -1;
+	cmLeafList_t	ll;
+
+	ll.ctx = ctx;
+	ll.list = list;
+	ll.count = 0;
+	ll.maxCount = listSize;
+	ll.mins = mins;
+	ll.maxs = maxs;
+	ll.topNode = -1;
 
-	CM_Q3BSP_BoxLeafnums_r (headNode);
+	CM_Q3BSP_BoxLeafnums_r (&ll, headNode);
 
 	if (topNode)
-		*topNode = cm_q3_leafTopNode;
+		*topNode = ll.topNode;
 
-	return cm_q3_leafCount;
+	return ll.count;
 }
 int	CM_Q3BSP_BoxLeafnums (vec3_t mins, vec3_t maxs, int *list, int listSize, int *topNode)
 {
-	return CM_Q3BSP_BoxLeafnums_headnode (mins, maxs, list, listSize, cm_mapCModels[0].headNode, topNode);
+	return CM_Q3BSP_BoxLeafnums_headnode (&cm_defaultTraceContext, mins, maxs, list, listSize, cm_mapCModels[0].headNode, topNode);
 }
 
 
@@ -299,7 +341,7 @@ int CM_Q3BSP_PointContents (vec3_t p, int headNode)
 	if (!cm_q3_numNodes)
 		return 0;	// Map not loaded
 
-	i = CM_PointLeafnum_r (p, headNode);
+	i = CM_PointLeafnum_r (&cm_defaultTraceContext, p, headNode);
 	leaf = &cm_q3_leafs[i];
 
 	if (leaf->contents & Q3CNTNTS_NODROP)
@@ -371,7 +413,7 @@ int	CM_Q3BSP_TransformedPointContents (vec3_t p, int headNode, vec3_t origin, ve
 CM_Q3BSP_ClipBoxToBrush
 ================
 */
-static void CM_Q3BSP_ClipBoxToBrush (cbrush_t *brush)
+static void CM_Q3BSP_ClipBoxToBrush (cmTraceContext_t *ctx, cbrush_t *brush)
 {
 	int				i;
 	cBspPlane_t		*p, *clipPlane;
@@ -388,7 +430,7 @@ static void CM_Q3BSP_ClipBoxToBrush (cbrush_t *brush)
 	if (!brush->numSides)
 		return;
 
-	cm_numBrushTraces++;
+	ctx->numBrushTraces++;
 
 	getOut = qFalse;
 	startOut = qFalse;
@@ -396,45 +438,47 @@ static void CM_Q3BSP_ClipBoxToBrush (cbrush_t *brush)
 
 	for (i=0, side=&cm_q3_brushSides[brush->firstBrushSide] ; i<brush->numSides ; side++, i++) {
 		p = side->plane;
+		if (brush == cm_q3_boxBrush)
+			p = ctx->boxPlanes + (p - cm_q3_boxPlanes);
 
 		// Push the plane out apropriately for mins/maxs
 		if (p->type < 3) {
-			d1 = cm_q3_traceStartMins[p->type] - p->dist;
-			d2 = cm_q3_traceEndMins[p->type] - p->dist;
+			d1 = ctx->startMins[p->type] - p->dist;
+			d2 = ctx->endMins[p->type] - p->dist;
 		}
 		else {
 			switch (p->signBits) {
 			case 0:
-				d1 = p->normal[0]*cm_q3_traceStartMins[0] + p->normal[1]*cm_q3_traceStartMins[1] + p->normal[2]*cm_q3_traceStartMins[2] - p->dist;
-				d2 = p->normal[0]*cm_q3_traceEndMins[0] + p->normal[1]*cm_q3_traceEndMins[1] + p->normal[2]*cm_q3_traceEndMins[2] - p->dist;
+				d1 = p->normal[0]*ctx->startMins[0] + p->normal[1]*ctx->startMins[1] + p->normal[2]*ctx->startMins[2] - p->dist;
+				d2 = p->normal[0]*ctx->endMins[0] + p->normal[1]*ctx->endMins[1] + p->normal[2]*ctx->endMins[2] - p->dist;
 				break;
 			case 1:
-				d1 = p->normal[0]*cm_q3_traceStartMaxs[0] + p->normal[1]*cm_q3_traceStartMins[1] + p->normal[2]*cm_q3_traceStartMins[2] - p->dist;
-				d2 = p->normal[0]*cm_q3_traceEndMaxs[0] + p->normal[1]*cm_q3_traceEndMins[1] + p->normal[2]*cm_q3_traceEndMins[2] - p->dist;
+				d1 = p->normal[0]*ctx->startMaxs[0] + p->normal[1]*ctx->startMins[1] + p->normal[2]*ctx->startMins[2] - p->dist;
+				d2 = p->normal[0]*ctx->endMaxs[0] + p->normal[1]*ctx->endMins[1] + p->normal[2]*ctx->endMins[2] - p->dist;
 				break;
 			case 2:
-				d1 = p->normal[0]*cm_q3_traceStartMins[0] + p->normal[1]*cm_q3_traceStartMaxs[1] + p->normal[2]*cm_q3_traceStartMins[2] - p->dist;
-				d2 = p->normal[0]*cm_q3_traceEndMins[0] + p->normal[1]*cm_q3_traceEndMaxs[1] + p->normal[2]*cm_q3_traceEndMins[2] - p->dist;
+				d1 = p->normal[0]*ctx->startMins[0] + p->normal[1]*ctx->startMaxs[1] + p->normal[2]*ctx->startMins[2] - p->dist;
+				d2 = p->normal[0]*ctx->endMins[0] + p->normal[1]*ctx->endMaxs[1] + p->normal[2]*ctx->endMins[2] - p->dist;
 				break;
 			case 3:
-				d1 = p->normal[0]*cm_q3_traceStartMaxs[0] + p->normal[1]*cm_q3_traceStartMaxs[1] + p->normal[2]*cm_q3_traceStartMins[2] - p->dist;
-				d2 = p->normal[0]*cm_q3_traceEndMaxs[0] + p->normal[1]*cm_q3_traceEndMaxs[1] + p->normal[2]*cm_q3_traceEndMins[2] - p->dist;
+				d1 = p->normal[0]*ctx->startMaxs[0] + p->normal[1]*ctx->startMaxs[1] + p->normal[2]*ctx->startMins[2] - p->dist;
+				d2 = p->normal[0]*ctx->endMaxs[0] + p->normal[1]*ctx->endMaxs[1] + p->normal[2]*ctx->endMins[2] - p->dist;
 				break;
 			case 4:
-				d1 = p->normal[0]*cm_q3_traceStartMins[0] + p->normal[1]*cm_q3_traceStartMins[1] + p->normal[2]*cm_q3_traceStartMaxs[2] - p->dist;
-				d2 = p->normal[0]*cm_q3_traceEndMins[0] + p->normal[1]*cm_q3_traceEndMins[1] + p->normal[2]*cm_q3_traceEndMaxs[2] - p->dist;
+				d1 = p->normal[0]*ctx->startMins[0] + p->normal[1]*ctx->startMins[1] + p->normal[2]*ctx->startMaxs[2] - p->dist;
+				d2 = p->normal[0]*ctx->endMins[0] + p->normal[1]*ctx->endMins[1] + p->normal[2]*ctx->endMaxs[2] - p->dist;
 				break;
 			case 5:
-				d1 = p->normal[0]*cm_q3_traceStartMaxs[0] + p->normal[1]*cm_q3_traceStartMins[1] + p->normal[2]*cm_q3_traceStartMaxs[2] - p->dist;
-				d2 = p->normal[0]*cm_q3_traceEndMaxs[0] + p->normal[1]*cm_q3_traceEndMins[1] + p->normal[2]*cm_q3_traceEndMaxs[2] - p->dist;
+				d1 = p->normal[0]*ctx->startMaxs[0] + p->normal[1]*ctx->startMins[1] + p->normal[2]*ctx->startMaxs[2] - p->dist;
+				d2 = p->normal[0]*ctx->endMaxs[0] + p->normal[1]*ctx->endMins[1] + p->normal[2]*ctx->endMaxs[2] - p->dist;
 				break;
 			case 6:
-				d1 = p->normal[0]*cm_q3_traceStartMins[0] + p->normal[1]*cm_q3_traceStartMaxs[1] + p->normal[2]*cm_q3_traceStartMaxs[2] - p->dist;
-				d2 = p->normal[0]*cm_q3_traceEndMins[0] + p->normal[1]*cm_q3_traceEndMaxs[1] + p->normal[2]*cm_q3_traceEndMaxs[2] - p->dist;
+				d1 = p->normal[0]*ctx->startMins[0] + p->normal[1]*ctx->startMaxs[1] + p->normal[2]*ctx->startMaxs[2] - p->dist;
+				d2 = p->normal[0]*ctx->endMins[0] + p->normal[1]*ctx->endMaxs[1] + p->normal[2]*ctx->endMaxs[2] - p->dist;
 				break;
 			case 7:
-				d1 = p->normal[0]*cm_q3_traceStartMaxs[0] + p->normal[1]*cm_q3_traceStartMaxs[1] + p->normal[2]*cm_q3_traceStartMaxs[2] - p->dist;
-				d2 = p->normal[0]*cm_q3_traceEndMaxs[0] + p->normal[1]*cm_q3_traceEndMaxs[1] + p->normal[2]*cm_q3_traceEndMaxs[2] - p->dist;
+				d1 = p->normal[0]*ctx->startMaxs[0] + p->normal[1]*ctx->startMaxs[1] + p->normal[2]*ctx->startMaxs[2] - p->dist;
+				d2 = p->normal[0]*ctx->endMaxs[0] + p->normal[1]*ctx->endMaxs[1] + p->normal[2]*ctx->endMaxs[2] - p->dist;
 				break;
 			default:
 				d1 = d2 = 0;	// Shut up compiler
@@ -475,20 +519,20 @@ static void CM_Q3BSP_ClipBoxToBrush (cbrush_t *brush)
 
 	if (!startOut) {
 		// Original point was inside brush
-		cm_q3_currentTrace.startSolid = qTrue;
+		ctx->trace.startSolid = qTrue;
 		if (!getOut)
-			cm_q3_currentTrace.allSolid = qTrue;
+			ctx->trace.allSolid = qTrue;
 		return;
 	}
 
 	if (enterFrac-(1.0f/1024.0f) <= leaveFrac) {
-		if (enterFrac > -1 && enterFrac < cm_q3_currentTrace.fraction) {
+		if (enterFrac > -1 && enterFrac < ctx->trace.fraction) {
 			if (enterFrac < 0)
 				enterFrac = 0;
-			cm_q3_currentTrace.fraction = enterFrac;
-			cm_q3_currentTrace.plane = *clipPlane;
-			cm_q3_currentTrace.surface = leadSide->surface;
-			cm_q3_currentTrace.contents = brush->contents;
+			ctx->trace.fraction = enterFrac;
+			ctx->trace.plane = *clipPlane;
+			ctx->trace.surface = leadSide->surface;
+			ctx->trace.contents = brush->contents;
 		}
 	}
 }
@@ -499,7 +543,7 @@ static void CM_Q3BSP_ClipBoxToBrush (cbrush_t *brush)
 CM_Q3BSP_ClipBoxes
 ================
 */
-static void CM_Q3BSP_ClipBoxes (int leafNum)
+static void CM_Q3BSP_ClipBoxes (cmTraceContext_t *ctx, int leafNum)
 {
 	int			i, j;
 	int			brushNum, patchNum;
@@ -508,7 +552,7 @@ static void CM_Q3BSP_ClipBoxes (int leafNum)
 	cpatch_t	*patch;
 
 	leaf = &cm_q3_leafs[leafNum];
-	if (!(leaf->contents & cm_q3_traceContents))
+	if (!(leaf->contents & ctx->contents))
 		return;
 
 	// Trace line against all brushes in the leaf
@@ -516,14 +560,14 @@ static void CM_Q3BSP_ClipBoxes (int leafNum)
 		brushNum = cm_q3_leafBrushes[leaf->firstLeafBrush+i];
 		brush = &cm_q3_brushes[brushNum];
 
-		if (brush->checkCount == cm_q3_checkCount)
+		if (ctx->brushChecks[brushNum] == ctx->checkCount)
 			continue;	// Already checked this brush in another leaf
-		brush->checkCount = cm_q3_checkCount;
-		if (!(brush->contents & cm_q3_traceContents))
+		ctx->brushChecks[brushNum] = ctx->checkCount;
+		if (!(brush->contents & ctx->contents))
 			continue;
 
-		CM_Q3BSP_ClipBoxToBrush (brush);
-		if (!cm_q3_currentTrace.fraction)
+		CM_Q3BSP_ClipBoxToBrush (ctx, brush);
+		if (!ctx->trace.fraction)
 			return;
 	}
 
@@ -535,17 +579,17 @@ static void CM_Q3BSP_ClipBoxes (int leafNum)
 		patchNum = cm_q3_leafPatches[leaf->firstLeafPatch+i];
 		patch = &cm_q3_patches[patchNum];
 
-		if (patch->checkCount == cm_q3_checkCount)
+		if (ctx->patchChecks[patchNum] == ctx->checkCount)
 			continue;	// Already checked this patch in another leaf
-		patch->checkCount = cm_q3_checkCount;
-		if (!(patch->surface->contents & cm_q3_traceContents))
+		ctx->patchChecks[patchNum] = ctx->checkCount;
+		if (!(patch->surface->contents & ctx->contents))
 			continue;
-		if (!BoundsIntersect(patch->absMins, patch->absMaxs, cm_q3_traceAbsMins, cm_q3_traceAbsMaxs))
+		if (!BoundsIntersect(patch->absMins, patch->absMaxs, ctx->absMins, ctx->absMaxs))
 			continue;
 
 		for (j=0 ; j<patch->numBrushes ; j++) {
-			CM_Q3BSP_ClipBoxToBrush (&patch->brushes[j]);
-			if (!cm_q3_currentTrace.fraction)
+			CM_Q3BSP_ClipBoxToBrush (ctx, &patch->brushes[j]);
+			if (!ctx->trace.fraction)
 				return;
 		}
 	}
@@ -557,7 +601,7 @@ static void CM_Q3BSP_ClipBoxes (int leafNum)
 CM_Q3BSP_TestBoxInBrush
 ================
 */
-static void CM_Q3BSP_TestBoxInBrush (cbrush_t *brush)
+static void CM_Q3BSP_TestBoxInBrush (cmTraceContext_t *ctx, cbrush_t *brush)
 {
 	int				i;
 	cBspPlane_t		*p;
@@ -568,45 +612,47 @@ static void CM_Q3BSP_TestBoxInBrush (cbrush_t *brush)
 
 	for (i=0, side=&cm_q3_brushSides[brush->firstBrushSide] ; i<brush->numSides ; side++, i++) {
 		p = side->plane;
+		if (brush == cm_q3_boxBrush)
+			p = ctx->boxPlanes + (p - cm_q3_boxPlanes);
 
 		// Push the plane out apropriately for mins/maxs
 		// if completely in front of face, no intersection
 		if (p->type < 3) {
-			if (cm_q3_traceStartMins[p->type] > p->dist)
+			if (ctx->startMins[p->type] > p->dist)
 				return;
 		}
 		else {
 			switch (p->signBits) {
 			case 0:
-				if (p->normal[0]*cm_q3_traceStartMins[0] + p->normal[1]*cm_q3_traceStartMins[1] + p->normal[2]*cm_q3_traceStartMins[2] > p->dist)
+				if (p->normal[0]*ctx->startMins[0] + p->normal[1]*ctx->startMins[1] + p->normal[2]*ctx->startMins[2] > p->dist)
 					return;
 				break;
 			case 1:
-				if (p->normal[0]*cm_q3_traceStartMaxs[0] + p->normal[1]*cm_q3_traceStartMins[1] + p->normal[2]*cm_q3_traceStartMins[2] > p->dist)
+				if (p->normal[0]*ctx->startMaxs[0] + p->normal[1]*ctx->startMins[1] + p->normal[2]*ctx->startMins[2] > p->dist)
 					return;
 				break;
 			case 2:
-				if (p->normal[0]*cm_q3_traceStartMins[0] + p->normal[1]*cm_q3_traceStartMaxs[1] + p->normal[2]*cm_q3_traceStartMins[2] > p->dist)
+				if (p->normal[0]*ctx->startMins[0] + p->normal[1]*ctx->startMaxs[1] + p->normal[2]*ctx->startMins[2] > p->dist)
 					return;
 				break;
 			case 3:
-				if (p->normal[0]*cm_q3_traceStartMaxs[0] + p->normal[1]*cm_q3_traceStartMaxs[1] + p->normal[2]*cm_q3_traceStartMins[2] > p->dist)
+				if (p->normal[0]*ctx->startMaxs[0] + p->normal[1]*ctx->startMaxs[1] + p->normal[2]*ctx->startMins[2] > p->dist)
 					return;
 				break;
 			case 4:
-				if (p->normal[0]*cm_q3_traceStartMins[0] + p->normal[1]*cm_q3_traceStartMins[1] + p->normal[2]*cm_q3_traceStartMaxs[2] > p->dist)
+				if (p->normal[0]*ctx->startMins[0] + p->normal[1]*ctx->startMins[1] + p->normal[2]*ctx->startMaxs[2] > p->dist)
 					return;
 				break;
 			case 5:
-				if (p->normal[0]*cm_q3_traceStartMaxs[0] + p->normal[1]*cm_q3_traceStartMins[1] + p->normal[2]*cm_q3_traceStartMaxs[2] > p->dist)
+				if (p->normal[0]*ctx->startMaxs[0] + p->normal[1]*ctx->startMins[1] + p->normal[2]*ctx->startMaxs[2] > p->dist)
 					return;
 				break;
 			case 6:
-				if (p->normal[0]*cm_q3_traceStartMins[0] + p->normal[1]*cm_q3_traceStartMaxs[1] + p->normal[2]*cm_q3_traceStartMaxs[2] > p->dist)
+				if (p->normal[0]*ctx->startMins[0] + p->normal[1]*ctx->startMaxs[1] + p->normal[2]*ctx->startMaxs[2] > p->dist)
 					return;
 				break;
 			case 7:
-				if (p->normal[0]*cm_q3_traceStartMaxs[0] + p->normal[1]*cm_q3_traceStartMaxs[1] + p->normal[2]*cm_q3_traceStartMaxs[2] > p->dist)
+				if (p->normal[0]*ctx->startMaxs[0] + p->normal[1]*ctx->startMaxs[1] + p->normal[2]*ctx->startMaxs[2] > p->dist)
 					return;
 				break;
 			default:
@@ -617,9 +663,9 @@ static void CM_Q3BSP_TestBoxInBrush (cbrush_t *brush)
 	}
 
 	// Inside this brush
-	cm_q3_currentTrace.startSolid = cm_q3_currentTrace.allSolid = qTrue;
-	cm_q3_currentTrace.fraction = 0;
-	cm_q3_currentTrace.contents = brush->contents;
+	ctx->trace.startSolid = ctx->trace.allSolid = qTrue;
+	ctx->trace.fraction = 0;
+	ctx->trace.contents = brush->contents;
 }
 
 
@@ -628,7 +674,7 @@ static void CM_Q3BSP_TestBoxInBrush (cbrush_t *brush)
 CM_Q3BSP_TestBoxInLeaf
 ================
 */
-static void CM_Q3BSP_TestBoxInLeaf (int leafNum)
+static void CM_Q3BSP_TestBoxInLeaf (cmTraceContext_t *ctx, int leafNum)
 {
 	int			i, j;
 	int			brushNum, patchNum;
@@ -637,7 +683,7 @@ static void CM_Q3BSP_TestBoxInLeaf (int leafNum)
 	cpatch_t	*patch;
 
 	leaf = &cm_q3_leafs[leafNum];
-	if (!(leaf->contents & cm_q3_traceContents))
+	if (!(leaf->contents & ctx->contents))
 		return;
 
 	// Trace line against all brushes in the leaf
@@ -645,14 +691,14 @@ static void CM_Q3BSP_TestBoxInLeaf (int leafNum)
 		brushNum = cm_q3_leafBrushes[leaf->firstLeafBrush+i];
 		brush = &cm_q3_brushes[brushNum];
 
-		if (brush->checkCount == cm_q3_checkCount)
+		if (ctx->brushChecks[brushNum] == ctx->checkCount)
 			continue;	// Already checked this brush in another leaf
-		brush->checkCount = cm_q3_checkCount;
-		if (!(brush->contents & cm_q3_traceContents))
+		ctx->brushChecks[brushNum] = ctx->checkCount;
+		if (!(brush->contents & ctx->contents))
 			continue;
 
-		CM_Q3BSP_TestBoxInBrush (brush);
-		if (!cm_q3_currentTrace.fraction)
+		CM_Q3BSP_TestBoxInBrush (ctx, brush);
+		if (!ctx->trace.fraction)
 			return;
 	}
 
@@ -664,17 +710,17 @@ static void CM_Q3BSP_TestBoxInLeaf (int leafNum)
 		patchNum = cm_q3_leafPatches[leaf->firstLeafPatch+i];
 		patch = &cm_q3_patches[patchNum];
 
-		if (patch->checkCount == cm_q3_checkCount)
+		if (ctx->patchChecks[patchNum] == ctx->checkCount)
 			continue;	// Already checked this patch in another leaf
-		patch->checkCount = cm_q3_checkCount;
-		if (!(patch->surface->contents & cm_q3_traceContents))
+		ctx->patchChecks[patchNum] = ctx->checkCount;
+		if (!(patch->surface->contents & ctx->contents))
 			continue;
-		if (!BoundsIntersect(patch->absMins, patch->absMaxs, cm_q3_traceAbsMins, cm_q3_traceAbsMaxs))
+		if (!BoundsIntersect(patch->absMins, patch->absMaxs, ctx->absMins, ctx->absMaxs))
 			continue;
 
 		for (j=0 ; j<patch->numBrushes; j++) {
-			CM_Q3BSP_TestBoxInBrush (&patch->brushes[j]);
-			if (!cm_q3_currentTrace.fraction)
+			CM_Q3BSP_TestBoxInBrush (ctx, &patch->brushes[j]);
+			if (!ctx->trace.fraction)
 				return;
 		}
 	}
@@ -686,7 +732,7 @@ static void CM_Q3BSP_TestBoxInLeaf (int leafNum)
 CM_Q3BSP_RecursiveHullCheck
 ==================
 */
-static void CM_Q3BSP_RecursiveHullCheck (int num, float p1f, float p2f, vec3_t p1, vec3_t p2)
+static void CM_Q3BSP_RecursiveHullCheck (cmTraceContext_t *ctx, int num, float p1f, float p2f, vec3_t p1, vec3_t p2)
 {
 	cnode_t		*node;
 	cBspPlane_t	*plane;
@@ -698,12 +744,12 @@ static void CM_Q3BSP_RecursiveHullCheck (int num, float p1f, float p2f, vec3_t p
 	int			side;
 	float		midf;
 
-	if (cm_q3_currentTrace.fraction <= p1f)
+	if (ctx->trace.fraction <= p1f)
 		return;		// Already hit something nearer
 
 	// If < 0, we are in a leaf node
 	if (num < 0) {
-		CM_Q3BSP_ClipBoxes (-1-num);
+		CM_Q3BSP_ClipBoxes (ctx, -1-num);
 		return;
 	}
 
@@ -712,32 +758,35 @@ static void CM_Q3BSP_RecursiveHullCheck (int num, float p1f, float p2f, vec3_t p
 	// and the offset for the size of the box
 	//
 	node = cm_q3_nodes + num;
-	plane = node->plane;
+	if (num >= cm_q3_boxHeadNode)
+		plane = ctx->boxPlanes + (node->plane - cm_q3_boxPlanes);
+	else
+		plane = node->plane;
 
 	if (plane->type < 3) {
 		t1 = p1[plane->type] - plane->dist;
 		t2 = p2[plane->type] - plane->dist;
-		offset = cm_q3_traceExtents[plane->type];
+		offset = ctx->extents[plane->type];
 	}
 	else {
 		t1 = DotProduct (plane->normal, p1) - plane->dist;
 		t2 = DotProduct (plane->normal, p2) - plane->dist;
-		if (cm_q3_traceIsPoint)
+		if (ctx->isPoint)
 			offset = 0;
 		else
-			offset = fabs(cm_q3_traceExtents[0]*plane->normal[0])
-				+ fabs(cm_q3_traceExtents[1]*plane->normal[1])
-				+ fabs(cm_q3_traceExtents[2]*plane->normal[2]);
+			offset = fabs(ctx->extents[0]*plane->normal[0])
+				+ fabs(ctx->extents[1]*plane->normal[1])
+				+ fabs(ctx->extents[2]*plane->normal[2]);
 	}
 
 
 	// See which sides we need to consider
 	if (t1 >= offset && t2 >= offset) {
-		CM_Q3BSP_RecursiveHullCheck (node->children[0], p1f, p2f, p1, p2);
+		CM_Q3BSP_RecursiveHullCheck (ctx, node->children[0], p1f, p2f, p1, p2);
 		return;
 	}
 	if (t1 < -offset && t2 < -offset) {
-		CM_Q3BSP_RecursiveHullCheck (node->children[1], p1f, p2f, p1, p2);
+		CM_Q3BSP_RecursiveHullCheck (ctx, node->children[1], p1f, p2f, p1, p2);
 		return;
 	}
 
@@ -770,7 +819,7 @@ static void CM_Q3BSP_RecursiveHullCheck (int num, float p1f, float p2f, vec3_t p
 	for (i=0 ; i<3 ; i++)
 		mid[i] = p1[i] + frac*(p2[i] - p1[i]);
 
-	CM_Q3BSP_RecursiveHullCheck (node->children[side], p1f, midf, p1, mid);
+	CM_Q3BSP_RecursiveHullCheck (ctx, node->children[side], p1f, midf, p1, mid);
 
 	// Go past the node
 	if (frac2 < 0)
@@ -782,7 +831,7 @@ static void CM_Q3BSP_RecursiveHullCheck (int num, float p1f, float p2f, vec3_t p
 	for (i=0 ; i<3 ; i++)
 		mid[i] = p1[i] + frac2*(p2[i] - p1[i]);
 
-	CM_Q3BSP_RecursiveHullCheck (node->children[side^1], midf, p2f, mid, p2);
+	CM_Q3BSP_RecursiveHullCheck (ctx, node->children[side^1], midf, p2f, mid, p2);
 }
 
 // ==========================================================================
@@ -792,14 +841,14 @@ static void CM_Q3BSP_RecursiveHullCheck (int num, float p1f, float p2f, vec3_t p
 CM_Q3BSP_Trace
 ====================
 */
-trace_t CM_Q3BSP_Trace (vec3_t start, vec3_t end, float size, int contentMask)
+trace_t CM_Q3BSP_Trace (cmTraceContext_t *ctx, vec3_t start, vec3_t end, float size, int contentMask)
 {
 	vec3_t maxs, mins;
 
 	Vec3Set (maxs, size, size, size);
 	Vec3Set (mins, -size, -size, -size);
 
-	return CM_Q3BSP_BoxTrace (start, end, mins, maxs, 0, contentMask);
+	return CM_Q3BSP_BoxTrace (ctx, start, end, mins, maxs, 0, contentMask);
 }
 
 
@@ -808,43 +857,43 @@ trace_t CM_Q3BSP_Trace (vec3_t start, vec3_t end, float size, int contentMask)
 CM_Q3BSP_BoxTrace
 ==================
 */
-trace_t CM_Q3BSP_BoxTrace (vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs, int headNode, int brushMask)
+trace_t CM_Q3BSP_BoxTrace (cmTraceContext_t *ctx, vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs, int headNode, int brushMask)
 {
-	cm_q3_checkCount++;		// For multi-check avoidance
-	cm_numTraces++;			// For statistics, may be zeroed
+	ctx->checkCount++;		// For multi-check avoidance
+	ctx->numTraces++;		// For statistics, may be zeroed
 
 	// Fill in a default trace
-	cm_q3_currentTrace.allSolid = qFalse;
-	cm_q3_currentTrace.contents = 0;
-	Vec3Clear (cm_q3_currentTrace.endPos);
-	cm_q3_currentTrace.ent = NULL;
-	cm_q3_currentTrace.fraction = 1;
-	cm_q3_currentTrace.plane.dist = 0;
-	Vec3Clear (cm_q3_currentTrace.plane.normal);
-	cm_q3_currentTrace.plane.signBits = 0;
-	cm_q3_currentTrace.plane.type = 0;
-	cm_q3_currentTrace.startSolid = qFalse;
-	cm_q3_currentTrace.surface = &cm_q3_nullSurface;
+	ctx->trace.allSolid = qFalse;
+	ctx->trace.contents = 0;
+	Vec3Clear (ctx->trace.endPos);
+	ctx->trace.ent = NULL;
+	ctx->trace.fraction = 1;
+	ctx->trace.plane.dist = 0;
+	Vec3Clear (ctx->trace.plane.normal);
+	ctx->trace.plane.signBits = 0;
+	ctx->trace.plane.type = 0;
+	ctx->trace.startSolid = qFalse;
+	ctx->trace.surface = &cm_q3_nullSurface;
 
 	if (!cm_q3_numNodes)	// map not loaded
-		return cm_q3_currentTrace;
+		return ctx->trace;
 
-	cm_q3_traceContents = brushMask;
-	Vec3Copy (start, cm_q3_traceStart);
-	Vec3Copy (end, cm_q3_traceEnd);
-	Vec3Copy (mins, cm_q3_traceMins);
-	Vec3Copy (maxs, cm_q3_traceMaxs);
+	ctx->contents = brushMask;
+	Vec3Copy (start, ctx->start);
+	Vec3Copy (end, ctx->end);
+	Vec3Copy (mins, ctx->mins);
+	Vec3Copy (maxs, ctx->maxs);
 
 	// Build a bounding box of the entire move
-	ClearBounds (cm_q3_traceAbsMins, cm_q3_traceAbsMaxs);
-	Vec3Add (start, cm_q3_traceMins, cm_q3_traceStartMins);
-	AddPointToBounds (cm_q3_traceStartMins, cm_q3_traceAbsMins, cm_q3_traceAbsMaxs);
-	Vec3Add (start, cm_q3_traceMaxs, cm_q3_traceStartMaxs);
-	AddPointToBounds (cm_q3_traceStartMaxs, cm_q3_traceAbsMins, cm_q3_traceAbsMaxs);
-	Vec3Add (end, cm_q3_traceMins, cm_q3_traceEndMins);
-	AddPointToBounds (cm_q3_traceEndMins, cm_q3_traceAbsMins, cm_q3_traceAbsMaxs);
-	Vec3Add (end, cm_q3_traceMaxs, cm_q3_traceEndMaxs);
-	AddPointToBounds (cm_q3_traceEndMaxs, cm_q3_traceAbsMins, cm_q3_traceAbsMaxs);
+	ClearBounds (ctx->absMins, ctx->absMaxs);
+	Vec3Add (start, ctx->mins, ctx->startMins);
+	AddPointToBounds (ctx->startMins, ctx->absMins, ctx->absMaxs);
+	Vec3Add (start, ctx->maxs, ctx->startMaxs);
+	AddPointToBounds (ctx->startMaxs, ctx->absMins, ctx->absMaxs);
+	Vec3Add (end, ctx->mins, ctx->endMins);
+	AddPointToBounds (ctx->endMins, ctx->absMins, ctx->absMaxs);
+	Vec3Add (end, ctx->maxs, ctx->endMaxs);
+	AddPointToBounds (ctx->endMaxs, ctx->absMins, ctx->absMaxs);
 
 	// Check for position test special case
 	if (start[0] == end[0] && start[1] == end[1] && start[2] == end[2]) {
@@ -860,40 +909,40 @@ trace_t CM_Q3BSP_BoxTrace (vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs, i
 			c2[i] += 1;
 		}
 
-		numLeafs = CM_Q3BSP_BoxLeafnums_headnode (c1, c2, leafs, 1024, headNode, &topnode);
+		numLeafs = CM_Q3BSP_BoxLeafnums_headnode (ctx, c1, c2, leafs, 1024, headNode, &topnode);
 		for (i=0 ; i<numLeafs ; i++) {
-			CM_Q3BSP_TestBoxInLeaf (leafs[i]);
-			if (cm_q3_currentTrace.allSolid)
+			CM_Q3BSP_TestBoxInLeaf (ctx, leafs[i]);
+			if (ctx->trace.allSolid)
 				break;
 		}
-		Vec3Copy (start, cm_q3_currentTrace.endPos);
-		return cm_q3_currentTrace;
+		Vec3Copy (start, ctx->trace.endPos);
+		return ctx->trace;
 	}
 
 	// Check for point special case
 	if (mins[0] == 0 && mins[1] == 0 && mins[2] == 0 && maxs[0] == 0 && maxs[1] == 0 && maxs[2] == 0) {
-		cm_q3_traceIsPoint = qTrue;
-		Vec3Clear (cm_q3_traceExtents);
+		ctx->isPoint = qTrue;
+		Vec3Clear (ctx->extents);
 	}
 	else {
-		cm_q3_traceIsPoint = qFalse;
-		cm_q3_traceExtents[0] = -mins[0] > maxs[0] ? -mins[0] : maxs[0];
-		cm_q3_traceExtents[1] = -mins[1] > maxs[1] ? -mins[1] : maxs[1];
-		cm_q3_traceExtents[2] = -mins[2] > maxs[2] ? -mins[2] : maxs[2];
+		ctx->isPoint = qFalse;
+		ctx->extents[0] = -mins[0] > maxs[0] ? -mins[0] : maxs[0];
+		ctx->extents[1] = -mins[1] > maxs[1] ? -mins[1] : maxs[1];
+		ctx->extents[2] = -mins[2] > maxs[2] ? -mins[2] : maxs[2];
 	}
 
 	// General sweeping through world
-	CM_Q3BSP_RecursiveHullCheck (headNode, 0, 1, start, end);
+	CM_Q3BSP_RecursiveHullCheck (ctx, headNode, 0, 1, start, end);
 
-	if (cm_q3_currentTrace.fraction == 1) {
-		Vec3Copy (end, cm_q3_currentTrace.endPos);
+	if (ctx->trace.fraction == 1) {
+		Vec3Copy (end, ctx->trace.endPos);
 	}
 	else {
-		cm_q3_currentTrace.endPos[0] = start[0] + cm_q3_currentTrace.fraction * (end[0] - start[0]);
-		cm_q3_currentTrace.endPos[1] = start[1] + cm_q3_currentTrace.fraction * (end[1] - start[1]);
-		cm_q3_currentTrace.endPos[2] = start[2] + cm_q3_currentTrace.fraction * (end[2] - start[2]);
+		ctx->trace.endPos[0] = start[0] + ctx->trace.fraction * (end[0] - start[0]);
+		ctx->trace.endPos[1] = start[1] + ctx->trace.fraction * (end[1] - start[1]);
+		ctx->trace.endPos[2] = start[2] + ctx->trace.fraction * (end[2] - start[2]);
 	}
-	return cm_q3_currentTrace;
+	return ctx->trace;
 }
 
 
@@ -905,7 +954,7 @@ CM_Q3BSP_TransformedBoxTrace
 #ifdef _WIN32
 #pragma optimize( "", off )
 #endif
-void CM_Q3BSP_TransformedBoxTrace (trace_t *out, vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs, int headNode, int brushMask, vec3_t origin, vec3_t angles)
+void CM_Q3BSP_TransformedBoxTrace (cmTraceContext_t *ctx, trace_t *out, vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs, int headNode, int brushMask, vec3_t origin, vec3_t angles)
 {
 	vec3_t		start_l, end_l;
 	vec3_t		a;
@@ -938,7 +987,7 @@ void CM_Q3BSP_TransformedBoxTrace (trace_t *out, vec3_t start, vec3_t end, vec3_
 	}
 
 	// Sweep the box through the model
-	*out = CM_Q3BSP_BoxTrace (start_l, end_l, mins, maxs, headNode, brushMask);
+	*out = CM_Q3BSP_BoxTrace (ctx, start_l, end_l, mins, maxs, headNode, brushMask);
 
 	if (rotated && out->fraction != 1.0) {
 		// FIXME: figure out how to do this with existing angles
@@ -972,7 +1021,7 @@ void CM_Q3BSP_TransformedBoxTrace (trace_t *out, vec3_t start, vec3_t end, vec3_
 CM_Q3BSP_ClusterPVS
 ===================
 */
-byte *CM_Q3BSP_ClusterPVS (int cluster)
+const byte *CM_Q3BSP_ClusterPVS (int cluster)
 {
 	if (cluster != -1 && cm_q3_visData && cm_q3_visData->numClusters)
 		return (byte *)cm_q3_visData->data + cluster * cm_q3_visData->rowSize;
@@ -986,7 +1035,7 @@ byte *CM_Q3BSP_ClusterPVS (int cluster)
 CM_Q3BSP_ClusterPHS
 ===================
 */
-byte *CM_Q3BSP_ClusterPHS (int cluster)
+const byte *CM_Q3BSP_ClusterPHS (int cluster)
 {
 	if (cluster != -1 && cm_q3_hearData && cm_q3_hearData->numClusters)
 		return (byte *)cm_q3_hearData->data + cluster * cm_q3_hearData->rowSize;
@@ -1182,7 +1231,7 @@ void CM_Q3BSP_ReadPortalState (fileHandle_t fileNum)
 CM_Q3BSP_HeadnodeVisible
 =============
 */
-qBool CM_Q3BSP_HeadnodeVisible (int nodeNum, byte *visBits)
+qBool CM_Q3BSP_HeadnodeVisible (int nodeNum, const byte *visBits)
 {
 	int		leafNum;
 	int		cluster;
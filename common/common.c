@@ -220,6 +220,7 @@ void Com_ConPrint (comPrint_t flags, char *string)
 				com_logFile = fopen (name, "a");
 			else
 				com_logFile = fopen (name, "w");
+			FS_InvalidateIndex ();
 		}
 		if (com_logFile)
 			fprintf (com_logFile, "%s", string);
@@ -660,7 +661,7 @@ void Com_Init (int argc, char **argv)
 	Mem_Init ();
 	com_aliasSysPool = Mem_CreatePool ("Common: Alias system");
 	com_cmdSysPool = Mem_CreatePool ("Common: Command system");
-	com_cmodelSysPool = Mem_CreatePool ("Common: Collision model");
+	com_cmodelSysPool = Mem_CreateArenaPool ("Common: Collision model", 1<<20);
 	com_cvarSysPool = Mem_CreatePool ("Common: Cvar system");
 	com_fileSysPool = Mem_CreatePool ("Common: File system");
 	com_genericPool = Mem_CreatePool ("Generic");
@@ -814,6 +815,9 @@ void Com_Frame (int msec)
 	// Print trace statistics if desired
 	CM_PrintStats ();
 
+	// Roll over memory profiling counters
+	Mem_Frame ();
+
 	// Pump the message loop
 	Sys_SendKeyEvents ();
 
@@ -823,6 +827,9 @@ void Com_Frame (int msec)
 		Cbuf_AddText (conInput);
 	Cbuf_Execute ();
 
+	// Hand out background file loads that finished
+	FS_PollLoads ();
+
 	// Update server
 	SV_Frame (msec);
 
@@ -100,6 +100,7 @@ typedef enum libType_s {
 
 int			Sys_Milliseconds (void);
 uint32		Sys_UMilliseconds (void);
+uint32		Sys_Microseconds (void);	// for timing short spans, wraps every ~71 minutes
 
 void		Sys_Init (void);
 void		Sys_AppActivate (void);
@@ -115,6 +116,10 @@ char		*Sys_GetClipboardData (void);
 
 void		Sys_Mkdir (char *path);
 
+// read-only mapping of a whole file, NULL if it can't be mapped
+void		*Sys_MapFile (char *path, size_t *size);
+void		Sys_UnmapFile (void *base, size_t size);
+
 // pass in an attribute mask of things you wish to REJECT
 char		*Sys_FindFirst (char *path, uint32 mustHave, uint32 cantHave);
 char		*Sys_FindNext (uint32 mustHave, uint32 cantHave);
@@ -122,6 +127,21 @@ void		Sys_FindClose (void);
 
 int			Sys_FindFiles (char *path, char *pattern, char **fileList, int maxFiles, int fileCount, qBool recurse, qBool addFiles, qBool addDirs);
 
+// Worker threads. Sys_RunJobs calls func once for every job number from up
+// to numThreads threads, the caller being thread 0, and returns when all of
+// them are done. Sys_StartJobs hands the batch to numThreads workers and
+// returns at once, Sys_RunJob runs the next job nobody took yet on the
+// caller and Sys_WaitJobs waits for the batch. Jobs must not Com_Error or
+// print.
+#define SYS_MAX_JOB_THREADS	16
+
+int			Sys_NumProcessors (void);
+void		Sys_RunJobs (int numJobs, int numThreads, void (*func) (int job, int thread));
+void		Sys_StartJobs (int numJobs, int numThreads, void (*func) (int job, int thread));
+qBool		Sys_RunJob (void);
+void		Sys_WaitJobs (void);
+int			Sys_AtomicAdd (volatile int *value, int add);	// returns the old value
+
 // ==========================================================================
 
 char		*Sys_ConsoleInput (void);
@@ -27,12 +27,22 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #define FS_MAX_PAKS			1024
 #define FS_MAX_HASHSIZE		1024
 #define FS_MAX_FILEINDICES	1024
+#define FS_MAX_INDEXFILES	65536		// loose files indexed across all directories
+#define FS_MAX_FINDHASH		16384
+#define FS_MAX_PKZCACHE		64
+#define FS_MAX_ASYNCLOADS	1024		// queued before FS_LoadFileAsync finishes them itself
+#define FS_MAX_ASYNCBATCH	256			// open at once, leaves handles for everything else
+#define FS_MAX_PREFETCH		1024
+#define FS_PREFETCH_PAD		4			// room left for a FS_LoadFile terminator
 
 cVar_t	*fs_basedir;
 cVar_t	*fs_cddir;
 cVar_t	*fs_game;
 cVar_t	*fs_gamedircvar;
 cVar_t	*fs_defaultPaks;
+cVar_t	*fs_index;
+cVar_t	*fs_pkzCacheSize;
+cVar_t	*fs_threads;
 
 /*
 =============================================================================
@@ -57,6 +67,14 @@ typedef struct mPack_s {
 	// Standard
 	FILE					*pak;
 
+	// Read-only mapping of a standard pak, NULL if it couldn't be mapped.
+	// Open handles and views on it keep it alive past a gamedir change
+	byte					*mapBase;
+	size_t					mapSize;
+	int						numViews;		// open handles and views
+	qBool					orphaned;
+	struct mPack_s			*mapNext;
+
 	// Compressed
 	unzFile					*pkz;
 
@@ -82,10 +100,20 @@ typedef struct fsLink_s {
 	char					*to;
 } fsLink_t;
 
+typedef struct fsFindEntry_s {
+	char					*name;
+	qBool					isDir;			// loose directories, listed when there's no extension
+} fsFindEntry_t;
+
 typedef struct fsPath_s {
 	char					pathName[MAX_OSPATH];
 	char					gamePath[MAX_OSPATH];
 	mPack_t					*package;
+	qBool					indexed;		// every file in it is in the search index
+
+	// Sorted by name for FS_FindFiles, valid with the search index
+	fsFindEntry_t			*findEntries;
+	int						numFindEntries;
 
 	struct fsPath_s			*next;
 } fsPath_t;
@@ -99,6 +127,67 @@ static fsPath_t	**fs_invSearchPaths;
 static size_t	fs_numInvSearchPaths;
 static fsPath_t	*fs_baseSearchPath;		// Without gamedirs
 
+static mPack_t	*fs_mappedPacks;
+
+/*
+=============================================================================
+
+	PKZ ENTRY CACHE
+
+	Compressed entries no bigger than a quarter of fs_pkzCacheSize (in KB)
+	are inflated whole on the first read, seek or view and kept, least
+	recently used first out, so reads and seeks on them are memory copies.
+	Opening one only to check it's there or how big it is inflates nothing.
+	Bigger entries still stream through minizip, and 0 disables the cache.
+=============================================================================
+*/
+
+typedef struct fsPkzCache_s {
+	mPack_t					*package;		// NULL once the pack is gone
+	int						filePos;
+
+	byte					*data;
+	size_t					dataLen;
+
+	int						refCount;		// open handles and views
+	uint32					lastUse;
+} fsPkzCache_t;
+
+static fsPkzCache_t		fs_pkzCache[FS_MAX_PKZCACHE];
+static size_t			fs_pkzCacheBytes;
+static uint32			fs_pkzCacheTime;
+static qBool			fs_noPkzCache;		// set while opening for FS_StartLoads
+
+/*
+=============================================================================
+
+	SEARCH INDEX
+
+	Every file visible through the search path, keyed by name, pointing at
+	the search path that wins it. Built lazily on the first open after it's
+	invalidated, so a lookup is one hash probe and a miss never touches the
+	disk. Anything that writes into a game directory without FS_OpenFile
+	has to call FS_InvalidateIndex, "fs_rescan" does it by hand.
+=============================================================================
+*/
+
+typedef struct fsIndexEntry_s {
+	char					*name;			// relative to the search path
+	fsPath_t				*searchPath;
+	mPackFile_t				*packFile;		// NULL for loose files
+	char					*netPath;		// full path of a loose file
+
+	struct fsIndexEntry_s	*hashNext;
+} fsIndexEntry_t;
+
+static qBool			fs_indexValid;
+static fsIndexEntry_t	*fs_indexEntries;
+static fsIndexEntry_t	**fs_indexHash;
+static int				fs_indexHashSize;
+static char				**fs_indexLooseFiles;
+static int				fs_numIndexLooseFiles;
+static fsFindEntry_t	*fs_findEntries;
+
 /*
 =============================================================================
 
@@ -113,13 +202,24 @@ typedef struct fsHandleIndex_s {
 	qBool					inUse;
 	fsOpenMode_t			openMode;
 
-	// One of these is always NULL
+	// Only one of these is ever set
 	FILE					*regFile;
 	unzFile					*pkzFile;
+	byte					*mapData;		// points into mapPack's mapping, or pkzCache's data
+	mPackFile_t				*pkzEntry;		// cacheable pkz entry not touched yet, in pkzPack
+
+	mPack_t					*mapPack;
+	mPack_t					*pkzPack;
+	fsPkzCache_t			*pkzCache;
+	size_t					mapLen;
+	size_t					mapPos;
 } fsHandleIndex_t;
 
 static fsHandleIndex_t	fs_fileIndices[FS_MAX_FILEINDICES];
 
+static void FS_OpenPkzEntry (fsHandleIndex_t *handle);
+static void FS_ReleaseMappedPack (mPack_t *package);
+
 /*
 =============================================================================
 
@@ -294,6 +394,260 @@ void FS_CopyFile (char *src, char *dst)
 
 	fclose (f1);
 	fclose (f2);
+
+	FS_InvalidateIndex ();
+}
+
+/*
+=============================================================================
+
+	SEARCH INDEX
+
+=============================================================================
+*/
+
+/*
+=============
+FS_FreeSysFileList
+=============
+*/
+static void FS_FreeSysFileList (char **list, int num)
+{
+	int		i;
+
+	for (i=0 ; i<num ; i++) {
+		if (!list[i])
+			continue;
+
+		Mem_Free (list[i]);
+		list[i] = NULL;
+	}
+}
+
+
+/*
+=================
+FS_InvalidateIndex
+
+Call after creating a file in a game directory without going through
+FS_OpenFile, or it won't be found until the next gamedir change.
+=================
+*/
+void FS_InvalidateIndex (void)
+{
+	fs_indexValid = qFalse;
+	FS_ClearPrefetch ();
+}
+
+
+/*
+=================
+FS_ClearIndex
+=================
+*/
+static void FS_ClearIndex (void)
+{
+	if (fs_indexLooseFiles) {
+		FS_FreeSysFileList (fs_indexLooseFiles, fs_numIndexLooseFiles);
+		Mem_Free (fs_indexLooseFiles);
+		fs_indexLooseFiles = NULL;
+		fs_numIndexLooseFiles = 0;
+	}
+	if (fs_indexEntries) {
+		Mem_Free (fs_indexEntries);
+		fs_indexEntries = NULL;
+	}
+	if (fs_indexHash) {
+		Mem_Free (fs_indexHash);
+		fs_indexHash = NULL;
+	}
+	if (fs_findEntries) {
+		Mem_Free (fs_findEntries);
+		fs_findEntries = NULL;
+	}
+
+	fs_indexHashSize = 0;
+	fs_indexValid = qFalse;
+}
+
+
+/*
+=================
+FS_IndexLookup
+=================
+*/
+static fsIndexEntry_t *FS_IndexLookup (char *name)
+{
+	fsIndexEntry_t	*entry;
+
+	for (entry=fs_indexHash[Com_HashFileName (name, fs_indexHashSize)] ; entry ; entry=entry->hashNext) {
+		if (!Q_stricmp (entry->name, name))
+			return entry;
+	}
+
+	return NULL;
+}
+
+
+/*
+=================
+FS_IndexAdd
+
+Search paths are added in order, so the first to add a name keeps it
+=================
+*/
+static void FS_IndexAdd (fsIndexEntry_t **next, char *name, fsPath_t *searchPath, mPackFile_t *packFile, char *netPath)
+{
+	fsIndexEntry_t	*entry;
+	uint32			hashValue;
+
+	hashValue = Com_HashFileName (name, fs_indexHashSize);
+	for (entry=fs_indexHash[hashValue] ; entry ; entry=entry->hashNext) {
+		if (!Q_stricmp (entry->name, name))
+			return;
+	}
+
+	entry = (*next)++;
+	entry->name = name;
+	entry->searchPath = searchPath;
+	entry->packFile = packFile;
+	entry->netPath = netPath;
+
+	entry->hashNext = fs_indexHash[hashValue];
+	fs_indexHash[hashValue] = entry;
+}
+
+
+/*
+=================
+FS_FindCompare
+=================
+*/
+static int FS_FindCompare (const void *a, const void *b)
+{
+	return Q_stricmp (((const fsFindEntry_t *)a)->name, ((const fsFindEntry_t *)b)->name);
+}
+
+
+/*
+=================
+FS_BuildIndex
+
+Also builds the FS_FindFiles listing, every search path's files (and loose
+directories) sorted by name. A directory with more files than are left to
+index is marked as not indexed, and is searched on disk like it used to be.
+=================
+*/
+static void FS_BuildIndex (void)
+{
+	fsPath_t		*searchPath;
+	fsIndexEntry_t	*next;
+	fsFindEntry_t	*find;
+	char			**looseFiles;
+	int				*looseCounts, *looseDirCounts;
+	int				numEntries, numLoose, count, dirCount;
+	int				numPaths, pathNum, i, len;
+	uint32			initTime;
+
+	initTime = Sys_UMilliseconds ();
+	FS_ClearIndex ();
+
+	// Scan the loose directories
+	for (numPaths=0, searchPath=fs_searchPaths ; searchPath ; searchPath=searchPath->next, numPaths++) ;
+	looseFiles = Mem_PoolAlloc (sizeof (char *) * FS_MAX_INDEXFILES, com_fileSysPool, 0);
+	looseCounts = Mem_PoolAlloc (sizeof (int) * (numPaths+1) * 2, com_fileSysPool, 0);
+	looseDirCounts = looseCounts + numPaths + 1;
+
+	numEntries = 0;
+	numLoose = 0;
+	for (searchPath=fs_searchPaths, pathNum=0 ; searchPath ; searchPath=searchPath->next, pathNum++) {
+		if (searchPath->package) {
+			searchPath->indexed = qTrue;
+			numEntries += (int)searchPath->package->numFiles;
+			continue;
+		}
+
+		// Files, then the directories after them. The list is offset here
+		// rather than with fileCount, which the platforms don't agree on
+		count = Sys_FindFiles (searchPath->pathName, "*", looseFiles+numLoose, FS_MAX_INDEXFILES-numLoose, 0, qTrue, qTrue, qFalse);
+		dirCount = Sys_FindFiles (searchPath->pathName, "*", looseFiles+numLoose+count, FS_MAX_INDEXFILES-numLoose-count, 0, qTrue, qFalse, qTrue);
+		if (numLoose + count + dirCount >= FS_MAX_INDEXFILES) {
+			Com_Printf (PRNT_WARNING, "FS_BuildIndex: too many files in \"%s\", not indexing it\n", searchPath->pathName);
+			FS_FreeSysFileList (looseFiles+numLoose, count+dirCount);
+			count = 0;
+			dirCount = 0;
+			searchPath->indexed = qFalse;
+		}
+		else
+			searchPath->indexed = qTrue;
+
+		looseCounts[pathNum] = count;
+		looseDirCounts[pathNum] = dirCount;
+		numLoose += count + dirCount;
+		numEntries += count + dirCount;
+	}
+
+	fs_indexLooseFiles = Mem_PoolAlloc (sizeof (char *) * (numLoose+1), com_fileSysPool, 0);
+	fs_numIndexLooseFiles = numLoose;
+	memcpy (fs_indexLooseFiles, looseFiles, sizeof (char *) * numLoose);
+	Mem_Free (looseFiles);
+
+	// Size the hash to the number of files
+	for (fs_indexHashSize=256 ; fs_indexHashSize<numEntries ; fs_indexHashSize<<=1) ;
+	fs_indexHash = Mem_PoolAlloc (sizeof (fsIndexEntry_t *) * fs_indexHashSize, com_fileSysPool, 0);
+	fs_indexEntries = Mem_PoolAlloc (sizeof (fsIndexEntry_t) * (numEntries+1), com_fileSysPool, 0);
+	fs_findEntries = Mem_PoolAlloc (sizeof (fsFindEntry_t) * (numEntries+1), com_fileSysPool, 0);
+
+	// Fill it in search order
+	next = fs_indexEntries;
+	find = fs_findEntries;
+	numLoose = 0;
+	for (searchPath=fs_searchPaths, pathNum=0 ; searchPath ; searchPath=searchPath->next, pathNum++) {
+		searchPath->findEntries = find;
+
+		if (searchPath->package) {
+			for (i=0 ; i<(int)searchPath->package->numFiles ; i++, find++) {
+				FS_IndexAdd (&next, searchPath->package->files[i].fileName, searchPath, &searchPath->package->files[i], NULL);
+				find->name = searchPath->package->files[i].fileName;
+			}
+		}
+		else {
+			len = (int)strlen (searchPath->pathName) + 1;
+			for (i=0 ; i<looseCounts[pathNum] ; i++, numLoose++, find++) {
+				FS_IndexAdd (&next, fs_indexLooseFiles[numLoose] + len, searchPath, NULL, fs_indexLooseFiles[numLoose]);
+				find->name = fs_indexLooseFiles[numLoose] + len;
+			}
+			for (i=0 ; i<looseDirCounts[pathNum] ; i++, numLoose++, find++) {
+				find->name = fs_indexLooseFiles[numLoose] + len;
+				find->isDir = qTrue;
+			}
+		}
+
+		searchPath->numFindEntries = (int)(find - searchPath->findEntries);
+		qsort (searchPath->findEntries, searchPath->numFindEntries, sizeof (fsFindEntry_t), FS_FindCompare);
+	}
+
+	Mem_Free (looseCounts);
+	fs_indexValid = qTrue;
+
+	if (fs_developer->intVal)
+		Com_Printf (0, "FS_BuildIndex: %i files (%i loose) in %ums\n", (int)(next - fs_indexEntries), fs_numIndexLooseFiles, Sys_UMilliseconds()-initTime);
+}
+
+
+/*
+=================
+FS_CheckIndex
+=================
+*/
+static void FS_CheckIndex (void)
+{
+	if (fs_index->modified) {
+		fs_index->modified = qFalse;
+		fs_indexValid = qFalse;
+	}
+	if (!fs_indexValid)
+		FS_BuildIndex ();
 }
 
 /*
@@ -368,6 +722,12 @@ size_t FS_FileLength (fileHandle_t fileNum)
 		// FIXME
 		return 0;
 	}
+	else if (handle->mapData) {
+		return handle->mapLen;
+	}
+	else if (handle->pkzEntry) {
+		return handle->pkzEntry->fileLen;
+	}
 
 	// Shouldn't happen...
 	assert (0);
@@ -391,6 +751,10 @@ size_t FS_Tell (fileHandle_t fileNum)
 		return ftell (handle->regFile);
 	else if (handle->pkzFile)
 		return unztell (handle->pkzFile);
+	else if (handle->mapData)
+		return handle->mapPos;
+	else if (handle->pkzEntry)
+		return 0;
 
 	// Shouldn't happen...
 	assert (0);
@@ -416,6 +780,8 @@ size_t FS_Read (void *buffer, size_t len, fileHandle_t fileNum)
 	handle = FS_GetHandle (fileNum);
 	if (handle->openMode != FS_MODE_READ_BINARY)
 		Com_Error (ERR_FATAL, "FS_Read: %s: was not opened in read mode", handle->name);
+	if (handle->pkzEntry)
+		FS_OpenPkzEntry (handle);
 
 	// Read in chunks for progress bar
 	remaining = len;
@@ -484,6 +850,18 @@ size_t FS_Read (void *buffer, size_t len, fileHandle_t fileNum)
 
 		return len;
 	}
+	else if (handle->mapData) {
+		// Mapped pack entry
+		if (remaining > handle->mapLen - handle->mapPos) {
+			remaining = handle->mapLen - handle->mapPos;
+			if (fs_developer->intVal)
+				Com_Printf (0, "FS_Read: short read from \"%s\"", handle->name);
+		}
+
+		memcpy (buf, handle->mapData + handle->mapPos, remaining);
+		handle->mapPos += remaining;
+		return remaining;
+	}
 
 	// Shouldn't happen...
 	assert (0);
@@ -559,10 +937,13 @@ void FS_Seek (fileHandle_t fileNum, long offset, fsSeekOrigin_t seekOrigin)
 {
 	fsHandleIndex_t	*handle;
 	unz_file_info	info;
-	int				remaining = 0, r, len;
+	int				remaining = 0, r, len, pos;
 	static byte		dummy[0x8000];
 
 	handle = FS_GetHandle (fileNum);
+	if (handle->pkzEntry)
+		FS_OpenPkzEntry (handle);
+
 	if (handle->regFile) {
 		// Seek through a regular file
 		switch (seekOrigin) {
@@ -604,9 +985,16 @@ void FS_Seek (fileHandle_t fileNum, long offset, fsSeekOrigin_t seekOrigin)
 			Com_Error (ERR_FATAL, "FS_Seek: bad origin (%i)", seekOrigin);
 		}
 
-		// Reopen the file
-		unzCloseCurrentFile (handle->pkzFile);
-		unzOpenCurrentFile (handle->pkzFile);
+		// Going forward just skips from here, only going back has to
+		// reopen the file and inflate from the start
+		pos = unztell (handle->pkzFile);
+		if (remaining >= pos) {
+			remaining -= pos;
+		}
+		else {
+			unzCloseCurrentFile (handle->pkzFile);
+			unzOpenCurrentFile (handle->pkzFile);
+		}
 
 		// Skip until the desired offset is reached
 		while (remaining) {
@@ -621,6 +1009,31 @@ void FS_Seek (fileHandle_t fileNum, long offset, fsSeekOrigin_t seekOrigin)
 			remaining -= r;
 		}
 	}
+	else if (handle->mapData) {
+		// Seek through a mapped pack entry
+		switch (seekOrigin) {
+		case FS_SEEK_SET:
+			break;
+
+		case FS_SEEK_CUR:
+			offset += (long)handle->mapPos;
+			break;
+
+		case FS_SEEK_END:
+			offset += (long)handle->mapLen;
+			break;
+
+		default:
+			Com_Error (ERR_FATAL, "FS_Seek: bad origin (%i)", seekOrigin);
+			break;
+		}
+
+		if (offset < 0)
+			offset = 0;
+		else if ((size_t)offset > handle->mapLen)
+			offset = (long)handle->mapLen;
+		handle->mapPos = offset;
+	}
 	else
 		assert (0);
 }
@@ -650,6 +1063,7 @@ static int FS_OpenFileAppend (fsHandleIndex_t *handle, qBool binary)
 	if (handle->regFile) {
 		if (fs_developer->intVal)
 			Com_Printf (0, "FS_OpenFileAppend: \"%s\"", path);
+		FS_InvalidateIndex ();
 		return __FileLen (handle->regFile);
 	}
 
@@ -684,6 +1098,7 @@ static int FS_OpenFileWrite (fsHandleIndex_t *handle, qBool binary)
 	if (handle->regFile) {
 		if (fs_developer->intVal)
 			Com_Printf (0, "FS_OpenFileWrite: \"%s\"", path);
+		FS_InvalidateIndex ();
 		return 0;
 	}
 
@@ -696,96 +1111,394 @@ static int FS_OpenFileWrite (fsHandleIndex_t *handle, qBool binary)
 
 /*
 ===========
-FS_OpenFileRead
+FS_FreePkzCache
+===========
+*/
+static void FS_FreePkzCache (fsPkzCache_t *cache)
+{
+	fs_pkzCacheBytes -= cache->dataLen;
+	Mem_Free (cache->data);
+	memset (cache, 0, sizeof (fsPkzCache_t));
+}
 
-Finds the file in the search path.
-returns filesize and an open FILE *
-Used for streaming data out of either a pak file or
-a seperate file.
+
+/*
+===========
+FS_ReleasePkzCache
 ===========
 */
-qBool	fs_fileFromPak = qFalse;
-static int FS_OpenFileRead (fsHandleIndex_t *handle)
+static void FS_ReleasePkzCache (fsPkzCache_t *cache)
 {
-	fsPath_t		*searchPath;
-	char			netPath[MAX_OSPATH];
-	mPack_t			*package;
-	mPackFile_t		*searchFile;
-	fsLink_t		*link;
-	uint32			hashValue;
+	assert (cache->refCount > 0);
+	if (--cache->refCount == 0 && !cache->package)
+		FS_FreePkzCache (cache);
+}
 
-	fs_fileFromPak = qFalse;
-	// Check for links first
-	for (link=fs_fileLinks ; link ; link=link->next) {
-		if (!strncmp (handle->name, link->from, link->fromLength)) {
-			Q_snprintfz (netPath, sizeof (netPath), "%s%s", link->to, handle->name+link->fromLength);
 
-			// Open
-			handle->regFile = fopen (netPath, "rb");
+/*
+===========
+FS_FlushPkzCache
 
-			// Return length
-			if (fs_developer->intVal)
-				Com_Printf (0, "FS_OpenFileRead: link file: %s\n", netPath);
-			if (handle->regFile)
-				return __FileLen (handle->regFile);
+Called before the packs are freed. Entries still in use are cut loose from
+their pack and freed when released.
+===========
+*/
+static void FS_FlushPkzCache (void)
+{
+	fsPkzCache_t	*cache;
+	int				i;
 
-			// Failed to load
-			return -1;
-		}
+	// Handles still waiting on their pack settle now
+	for (i=0 ; i<FS_MAX_FILEINDICES ; i++) {
+		if (fs_fileIndices[i].inUse && fs_fileIndices[i].pkzEntry)
+			FS_OpenPkzEntry (&fs_fileIndices[i]);
 	}
 
-	// Calculate hash value
-	hashValue = Com_HashFileName (handle->name, FS_MAX_HASHSIZE);
+	for (i=0, cache=fs_pkzCache ; i<FS_MAX_PKZCACHE ; i++, cache++) {
+		if (!cache->data)
+			continue;
 
-	// Search through the path, one element at a time
-	for (searchPath=fs_searchPaths ; searchPath ; searchPath=searchPath->next) {
-		// Is the element a pak file?
-		if (searchPath->package) {
-			// Look through all the pak file elements
-			package = searchPath->package;
+		if (cache->refCount)
+			cache->package = NULL;
+		else
+			FS_FreePkzCache (cache);
+	}
+}
 
-			for (searchFile=package->fileHashTree[hashValue] ; searchFile ; searchFile=searchFile->hashNext) {
-				if (Q_stricmp (searchFile->fileName, handle->name))
-					continue;
 
-				// Found it!
-				fs_fileFromPak = qTrue;
+/*
+===========
+FS_PkzCacheLimit
 
-				if (package->pak) {
-					if (fs_developer->intVal)
-						Com_Printf (0, "FS_OpenFileRead: pack file %s : %s\n", package->name, handle->name);
-
-					// Open a new file on the pakfile
-					handle->regFile = fopen (package->name, "rb");
-					if (handle->regFile) {
-						fseek (handle->regFile, searchFile->filePos, SEEK_SET);
-						return searchFile->fileLen;
-					}
-				}
-				else if (package->pkz) {
-					if (fs_developer->intVal)
-						Com_Printf (0, "FS_OpenFileRead: pkz file %s : %s\n", package->name, handle->name);
-
-					handle->pkzFile = unzOpen (package->name);
-					if (handle->pkzFile) {
-						if (unzSetOffset (handle->pkzFile, searchFile->filePos) == UNZ_OK) {
-							if (unzOpenCurrentFile (handle->pkzFile) == UNZ_OK)
-								return searchFile->fileLen;
-						}
-
-						// Failed to locate/open
-						unzClose (handle->pkzFile);
-					}
-				}
+Cache size in bytes, 0 if it's disabled.
+===========
+*/
+static size_t FS_PkzCacheLimit (void)
+{
+	if (fs_pkzCacheSize->intVal <= 0)
+		return 0;
+	return (size_t)fs_pkzCacheSize->intVal * 1024;
+}
 
-				Com_Error (ERR_FATAL, "FS_OpenFileRead: couldn't reopen \"%s\"", handle->name);
-			}
-		}
-		else {
-			// Check a file in the directory tree
-			Q_snprintfz (netPath, sizeof (netPath), "%s/%s", searchPath->pathName, handle->name);
 
-			handle->regFile = fopen (netPath, "rb");
+/*
+===========
+FS_CachePkzFile
+
+Returns the inflated entry with a reference held, or NULL if it's too big
+to cache or there's no room left that isn't in use.
+===========
+*/
+static fsPkzCache_t *FS_CachePkzFile (mPack_t *package, mPackFile_t *searchFile)
+{
+	fsPkzCache_t	*cache, *oldest;
+	unzFile			*pkzFile;
+	size_t			limit;
+	byte			*data;
+	int				i;
+
+	limit = FS_PkzCacheLimit ();
+	if (searchFile->fileLen <= 0 || (size_t)searchFile->fileLen > limit/4)
+		return NULL;
+
+	// Already inflated?
+	for (i=0, cache=fs_pkzCache ; i<FS_MAX_PKZCACHE ; i++, cache++) {
+		if (!cache->data || cache->package != package || cache->filePos != searchFile->filePos)
+			continue;
+
+		cache->refCount++;
+		cache->lastUse = ++fs_pkzCacheTime;
+		return cache;
+	}
+
+	// Make room, least recently used first
+	for ( ; ; ) {
+		oldest = NULL;
+		cache = NULL;
+		for (i=0 ; i<FS_MAX_PKZCACHE ; i++) {
+			if (!fs_pkzCache[i].data) {
+				if (!cache)
+					cache = &fs_pkzCache[i];
+				continue;
+			}
+			if (fs_pkzCache[i].refCount)
+				continue;
+			if (!oldest || fs_pkzCache[i].lastUse < oldest->lastUse)
+				oldest = &fs_pkzCache[i];
+		}
+
+		if (cache && fs_pkzCacheBytes + searchFile->fileLen <= limit)
+			break;
+		if (!oldest)
+			return NULL;
+
+		FS_FreePkzCache (oldest);
+	}
+
+	// Inflate the whole entry
+	pkzFile = unzOpen (package->name);
+	if (!pkzFile)
+		return NULL;
+	if (unzSetOffset (pkzFile, searchFile->filePos) != UNZ_OK || unzOpenCurrentFile (pkzFile) != UNZ_OK) {
+		unzClose (pkzFile);
+		return NULL;
+	}
+
+	data = Mem_PoolAlloc (searchFile->fileLen, com_fileSysPool, 0);
+	i = unzReadCurrentFile (pkzFile, data, searchFile->fileLen);
+	unzCloseCurrentFile (pkzFile);
+	unzClose (pkzFile);
+	if (i != searchFile->fileLen) {
+		Mem_Free (data);
+		return NULL;
+	}
+
+	cache->package = package;
+	cache->filePos = searchFile->filePos;
+	cache->data = data;
+	cache->dataLen = searchFile->fileLen;
+	cache->refCount = 1;
+	cache->lastUse = ++fs_pkzCacheTime;
+	fs_pkzCacheBytes += cache->dataLen;
+	return cache;
+}
+
+
+/*
+===========
+FS_OpenPkzStream
+===========
+*/
+static int FS_OpenPkzStream (fsHandleIndex_t *handle, mPack_t *package, mPackFile_t *searchFile)
+{
+	if (fs_developer->intVal)
+		Com_Printf (0, "FS_OpenFileRead: pkz file %s : %s\n", package->name, handle->name);
+
+	handle->pkzFile = unzOpen (package->name);
+	if (handle->pkzFile) {
+		if (unzSetOffset (handle->pkzFile, searchFile->filePos) == UNZ_OK) {
+			if (unzOpenCurrentFile (handle->pkzFile) == UNZ_OK)
+				return searchFile->fileLen;
+		}
+
+		// Failed to locate/open
+		unzClose (handle->pkzFile);
+		handle->pkzFile = NULL;
+	}
+
+	Com_Error (ERR_FATAL, "FS_OpenFileRead: couldn't reopen \"%s\"", handle->name);
+	return -1;
+}
+
+
+/*
+===========
+FS_OpenPkzEntry
+
+Inflates a cacheable pkz entry on its first use, or streams it if the cache
+has no room.
+===========
+*/
+static void FS_OpenPkzEntry (fsHandleIndex_t *handle)
+{
+	mPack_t		*package;
+	mPackFile_t	*searchFile;
+
+	package = handle->pkzPack;
+	searchFile = handle->pkzEntry;
+	handle->pkzPack = NULL;
+	handle->pkzEntry = NULL;
+
+	handle->pkzCache = FS_CachePkzFile (package, searchFile);
+	if (handle->pkzCache) {
+		if (fs_developer->intVal)
+			Com_Printf (0, "FS_OpenFileRead: cached pkz file %s : %s\n", package->name, handle->name);
+
+		handle->mapData = handle->pkzCache->data;
+		handle->mapLen = handle->pkzCache->dataLen;
+		handle->mapPos = 0;
+		return;
+	}
+
+	FS_OpenPkzStream (handle, package, searchFile);
+}
+
+
+/*
+===========
+FS_OpenPackFile
+===========
+*/
+qBool	fs_fileFromPak = qFalse;
+static int FS_OpenPackFile (fsHandleIndex_t *handle, mPack_t *package, mPackFile_t *searchFile)
+{
+	fs_fileFromPak = qTrue;
+
+	if (package->mapBase) {
+		if (fs_developer->intVal)
+			Com_Printf (0, "FS_OpenFileRead: mapped pack file %s : %s\n", package->name, handle->name);
+
+		// Read straight out of the mapping, FS_LoadPAK checked the range
+		handle->mapData = package->mapBase + searchFile->filePos;
+		handle->mapLen = searchFile->fileLen;
+		handle->mapPos = 0;
+		handle->mapPack = package;
+		package->numViews++;
+		return searchFile->fileLen;
+	}
+	else if (package->pak) {
+		if (fs_developer->intVal)
+			Com_Printf (0, "FS_OpenFileRead: pack file %s : %s\n", package->name, handle->name);
+
+		// Open a new file on the pakfile
+		handle->regFile = fopen (package->name, "rb");
+		if (handle->regFile) {
+			fseek (handle->regFile, searchFile->filePos, SEEK_SET);
+			return searchFile->fileLen;
+		}
+	}
+	else if (package->pkz) {
+		// Cacheable entries wait for FS_OpenPkzEntry
+		if (!fs_noPkzCache && searchFile->fileLen > 0 && (size_t)searchFile->fileLen <= FS_PkzCacheLimit ()/4) {
+			handle->pkzEntry = searchFile;
+			handle->pkzPack = package;
+			return searchFile->fileLen;
+		}
+
+		return FS_OpenPkzStream (handle, package, searchFile);
+	}
+
+	Com_Error (ERR_FATAL, "FS_OpenFileRead: couldn't reopen \"%s\"", handle->name);
+	return -1;
+}
+
+
+/*
+===========
+FS_OpenIndexedFile
+
+Looks the file up in the search index. Returns -2 if the index can't
+answer for it and the search path has to be walked.
+===========
+*/
+static int FS_OpenIndexedFile (fsHandleIndex_t *handle)
+{
+	fsIndexEntry_t	*entry;
+	fsPath_t		*searchPath;
+	char			netPath[MAX_OSPATH];
+
+	FS_CheckIndex ();
+	entry = FS_IndexLookup (handle->name);
+
+	// Directories too big to index still get asked directly
+	for (searchPath=fs_searchPaths ; searchPath ; searchPath=searchPath->next) {
+		if (entry && searchPath == entry->searchPath)
+			break;
+		if (searchPath->indexed)
+			continue;
+
+		Q_snprintfz (netPath, sizeof (netPath), "%s/%s", searchPath->pathName, handle->name);
+		handle->regFile = fopen (netPath, "rb");
+		if (handle->regFile) {
+			if (fs_developer->intVal)
+				Com_Printf (0, "FS_OpenFileRead: %s\n", netPath);
+			return __FileLen (handle->regFile);
+		}
+	}
+
+	if (!entry) {
+		if (fs_developer->intVal)
+			Com_Printf (0, "FS_OpenFileRead: can't find %s\n", handle->name);
+		return -1;
+	}
+
+	if (entry->packFile)
+		return FS_OpenPackFile (handle, entry->searchPath->package, entry->packFile);
+
+	handle->regFile = fopen (entry->netPath, "rb");
+	if (handle->regFile) {
+		if (fs_developer->intVal)
+			Com_Printf (0, "FS_OpenFileRead: %s\n", entry->netPath);
+		return __FileLen (handle->regFile);
+	}
+
+	// Removed since the index was built
+	fs_indexValid = qFalse;
+	return -2;
+}
+
+
+/*
+===========
+FS_OpenFileRead
+
+Finds the file in the search path.
+returns filesize and an open FILE *
+Used for streaming data out of either a pak file or
+a seperate file.
+===========
+*/
+static int FS_OpenFileRead (fsHandleIndex_t *handle)
+{
+	fsPath_t		*searchPath;
+	char			netPath[MAX_OSPATH];
+	mPack_t			*package;
+	mPackFile_t		*searchFile;
+	fsLink_t		*link;
+	uint32			hashValue;
+	int				fileLen;
+
+	fs_fileFromPak = qFalse;
+	// Check for links first
+	for (link=fs_fileLinks ; link ; link=link->next) {
+		if (!strncmp (handle->name, link->from, link->fromLength)) {
+			Q_snprintfz (netPath, sizeof (netPath), "%s%s", link->to, handle->name+link->fromLength);
+
+			// Open
+			handle->regFile = fopen (netPath, "rb");
+
+			// Return length
+			if (fs_developer->intVal)
+				Com_Printf (0, "FS_OpenFileRead: link file: %s\n", netPath);
+			if (handle->regFile)
+				return __FileLen (handle->regFile);
+
+			// Failed to load
+			return -1;
+		}
+	}
+
+	// The index matches names the way pack files do, leave anything
+	// with backslashes to the full search
+	if (fs_index->intVal && !strchr (handle->name, '\\')) {
+		fileLen = FS_OpenIndexedFile (handle);
+		if (fileLen != -2)
+			return fileLen;
+	}
+
+	// Calculate hash value
+	hashValue = Com_HashFileName (handle->name, FS_MAX_HASHSIZE);
+
+	// Search through the path, one element at a time
+	for (searchPath=fs_searchPaths ; searchPath ; searchPath=searchPath->next) {
+		// Is the element a pak file?
+		if (searchPath->package) {
+			// Look through all the pak file elements
+			package = searchPath->package;
+
+			for (searchFile=package->fileHashTree[hashValue] ; searchFile ; searchFile=searchFile->hashNext) {
+				if (Q_stricmp (searchFile->fileName, handle->name))
+					continue;
+
+				// Found it!
+				return FS_OpenPackFile (handle, package, searchFile);
+			}
+		}
+		else {
+			// Check a file in the directory tree
+			Q_snprintfz (netPath, sizeof (netPath), "%s/%s", searchPath->pathName, handle->name);
+
+			handle->regFile = fopen (netPath, "rb");
 			if (handle->regFile) {
 				// Found it!
 				if (fs_developer->intVal)
@@ -848,39 +1561,432 @@ int FS_OpenFile (char *fileName, fileHandle_t *fileNum, fsOpenMode_t openMode)
 		*fileNum = 0;
 	}
 
-	return fileSize;
+	return fileSize;
+}
+
+
+/*
+==============
+FS_CloseFile
+==============
+*/
+void FS_CloseFile (fileHandle_t fileNum)
+{
+	fsHandleIndex_t	*handle;
+
+	// Get local handle
+	handle = FS_GetHandle (fileNum);
+	if (!handle->inUse)
+		return;
+
+	// Close file/zip
+	if (handle->regFile)
+		fclose (handle->regFile);
+	else if (handle->pkzFile) {
+		unzCloseCurrentFile (handle->pkzFile);
+		unzClose (handle->pkzFile);
+	}
+	else if (handle->pkzCache)
+		FS_ReleasePkzCache (handle->pkzCache);
+	else if (handle->mapPack)
+		FS_ReleaseMappedPack (handle->mapPack);
+	else if (!handle->mapData && !handle->pkzEntry)
+		assert (0);
+
+	// Clear handle
+	handle->inUse = qFalse;
+	handle->name[0] = '\0';
+	handle->pkzFile = NULL;
+	handle->regFile = NULL;
+	handle->mapData = NULL;
+	handle->mapPack = NULL;
+	handle->pkzCache = NULL;
+	handle->pkzEntry = NULL;
+	handle->pkzPack = NULL;
+}
+
+/*
+=============================================================================
+
+	ASYNCHRONOUS LOADING
+
+	FS_LoadFileAsync only queues a load. FS_PollLoads, run every frame,
+	opens and sizes up to FS_MAX_ASYNCBATCH queued files on the main thread
+	and leaves the reading to fs_threads workers, then hands each finished
+	file to its callback on the main thread in the order they were queued.
+	FS_FinishLoads waits for everything queued.
+
+	FS_Prefetch queues a list of files that way and keeps them, FS_LoadFile
+	and FS_LoadFileView hand out a prefetched file instead of reading it
+	again. One that's still on its way is waited for, with the main thread
+	reading the files ahead of it that no worker took yet.
+=============================================================================
+*/
+
+typedef struct fsAsyncLoad_s {
+	char					name[MAX_QPATH];
+	char					terminate[FS_PREFETCH_PAD];
+	size_t					termLen;
+	size_t					padLen;			// zeroed bytes allocated past termLen
+
+	void					(*callback) (void *arg, void *buffer, int fileLen);
+	void					*arg;
+
+	fileHandle_t			fileNum;
+	int						fileLen;
+	byte					*buffer;
+	volatile int			done;			// set by the job once it's read
+} fsAsyncLoad_t;
+
+static fsAsyncLoad_t	fs_asyncLoads[FS_MAX_ASYNCLOADS];
+static int				fs_numAsyncLoads;
+
+static fsAsyncLoad_t	fs_asyncBatch[FS_MAX_ASYNCBATCH];
+static int				fs_numAsyncBatch;		// being read, 0 if no batch is out
+static int				fs_asyncBatchDone;		// handed to their callbacks
+
+typedef struct fsPrefetch_s {
+	char					name[MAX_QPATH];
+	byte					*data;			// FS_PREFETCH_PAD zeroed bytes past the end
+	int						fileLen;
+	qBool					pending;		// still queued or being read
+
+	struct fsPrefetch_s		*hashNext;
+} fsPrefetch_t;
+
+static fsPrefetch_t		fs_prefetch[FS_MAX_PREFETCH];
+static fsPrefetch_t		*fs_prefetchHash[FS_MAX_HASHSIZE];
+static int				fs_numPrefetch;
+static int				fs_numPrefetchHashed;	// pending or loaded and not taken
+
+/*
+============
+FS_QueueLoad
+============
+*/
+static void FS_QueueLoad (char *path, char *terminate, size_t padLen, void (*callback) (void *arg, void *buffer, int fileLen), void *arg)
+{
+	fsAsyncLoad_t	*load;
+
+	if (fs_numAsyncLoads == FS_MAX_ASYNCLOADS)
+		FS_FinishLoads ();
+
+	load = &fs_asyncLoads[fs_numAsyncLoads++];
+	memset (load, 0, sizeof (fsAsyncLoad_t));
+	Q_strncpyz (load->name, path, sizeof (load->name));
+	if (terminate) {
+		load->termLen = strlen (terminate);
+		if (load->termLen > sizeof (load->terminate))
+			Com_Error (ERR_FATAL, "FS_LoadFileAsync: terminator too long for \"%s\"", path);
+		memcpy (load->terminate, terminate, load->termLen);
+	}
+	load->padLen = padLen;
+	load->callback = callback;
+	load->arg = arg;
+}
+
+
+/*
+============
+FS_LoadFileAsync
+
+Queues path to be loaded in the background. Its callback is passed what
+FS_LoadFile would have returned, on the main thread, from a later
+FS_PollLoads or FS_FinishLoads. The callback owns the buffer and frees
+it with FS_FreeFile.
+============
+*/
+void FS_LoadFileAsync (char *path, char *terminate, void (*callback) (void *arg, void *buffer, int fileLen), void *arg)
+{
+	FS_QueueLoad (path, terminate, 0, callback, arg);
+}
+
+
+/*
+============
+FS_ReadJob
+
+Runs on worker threads, so only reads. The handle was opened and the
+buffer allocated on the main thread.
+============
+*/
+static void FS_ReadJob (int job, int thread)
+{
+	fsAsyncLoad_t	*load;
+	fsHandleIndex_t	*handle;
+	size_t			remaining, read;
+	byte			*buf;
+	int				r;
+
+	load = &fs_asyncBatch[job];
+	if (!load->fileNum)
+		return;
+
+	handle = &fs_fileIndices[load->fileNum-1];
+	remaining = load->fileLen;
+	buf = load->buffer;
+
+	if (handle->mapData) {
+		memcpy (buf, handle->mapData, remaining);
+	}
+	else if (handle->regFile) {
+		while (remaining) {
+			read = fread (buf, 1, remaining, handle->regFile);
+			if (!read)
+				break;
+			remaining -= read;
+			buf += read;
+		}
+	}
+	else if (handle->pkzFile) {
+		while (remaining) {
+			r = unzReadCurrentFile (handle->pkzFile, buf, (uint32)remaining);
+			if (r <= 0)
+				break;
+			remaining -= r;
+			buf += r;
+		}
+	}
+
+	// The main thread reads the buffer once it sees this
+	Sys_AtomicAdd (&load->done, 1);
+}
+
+
+/*
+============
+FS_StartLoads
+
+Opens the next batch from the queue and hands it to the workers
+============
+*/
+static void FS_StartLoads (void)
+{
+	fsAsyncLoad_t	*load;
+	int				numLoads, numThreads;
+	int				i;
+
+	numLoads = min (fs_numAsyncLoads, FS_MAX_ASYNCBATCH);
+	memcpy (fs_asyncBatch, fs_asyncLoads, sizeof (fsAsyncLoad_t) * numLoads);
+	fs_numAsyncLoads -= numLoads;
+	memmove (fs_asyncLoads, fs_asyncLoads+numLoads, sizeof (fsAsyncLoad_t) * fs_numAsyncLoads);
+
+	// Open and size everything here, the jobs only read. Compressed
+	// entries are inflated in the jobs instead of into the pkz cache
+	fs_noPkzCache = qTrue;
+	for (i=0, load=fs_asyncBatch ; i<numLoads ; i++, load++) {
+		load->fileLen = FS_OpenFile (load->name, &load->fileNum, FS_MODE_READ_BINARY);
+		if (load->fileNum && load->fileLen > 0) {
+			load->buffer = Mem_PoolAlloc (load->fileLen + load->termLen + load->padLen, com_fileSysPool, 0);
+			continue;
+		}
+
+		if (load->fileNum)
+			FS_CloseFile (load->fileNum);
+		load->fileNum = 0;
+		load->fileLen = (load->fileLen >= 0) ? 0 : -1;
+		load->done = 1;
+	}
+	fs_noPkzCache = qFalse;
+
+	fs_numAsyncBatch = numLoads;
+	fs_asyncBatchDone = 0;
+
+	numThreads = fs_threads->intVal;
+	if (numThreads <= 0)
+		numThreads = Sys_NumProcessors ();
+	numThreads = clamp (numThreads, 1, SYS_MAX_JOB_THREADS);
+
+	Sys_StartJobs (numLoads, numThreads, FS_ReadJob);
+}
+
+
+/*
+============
+FS_PollLoads
+
+Hands out the loads that are done, in queue order, and starts the next
+batch once they all are. Never waits.
+============
+*/
+void FS_PollLoads (void)
+{
+	fsAsyncLoad_t	*load;
+
+	while (fs_asyncBatchDone < fs_numAsyncBatch) {
+		load = &fs_asyncBatch[fs_asyncBatchDone];
+		if (!Sys_AtomicAdd (&load->done, 0))
+			return;
+		fs_asyncBatchDone++;
+
+		if (load->fileNum) {
+			FS_CloseFile (load->fileNum);
+
+			if (load->termLen) {
+				memcpy (load->buffer+load->fileLen, load->terminate, load->termLen);
+				load->fileLen += (int)load->termLen;
+			}
+		}
+
+		// May queue more, or poll again
+		load->callback (load->arg, load->buffer, load->fileLen);
+	}
+
+	if (fs_numAsyncBatch) {
+		// Every job is done, the workers are only on their way out
+		Sys_WaitJobs ();
+		fs_numAsyncBatch = 0;
+		fs_asyncBatchDone = 0;
+	}
+
+	if (fs_numAsyncLoads)
+		FS_StartLoads ();
+}
+
+
+/*
+============
+FS_FinishLoads
+
+Waits for everything queued by FS_LoadFileAsync and FS_Prefetch. Loads
+queued by the callbacks are finished too before this returns.
+============
+*/
+void FS_FinishLoads (void)
+{
+	FS_PollLoads ();
+	while (fs_numAsyncBatch) {
+		Sys_WaitJobs ();
+		FS_PollLoads ();
+	}
+}
+
+// ==========================================================================
+
+/*
+============
+FS_PrefetchDone
+============
+*/
+static void FS_PrefetchDone (void *arg, void *buffer, int fileLen)
+{
+	fsPrefetch_t	*prefetch = (fsPrefetch_t *)arg;
+
+	prefetch->data = buffer;
+	prefetch->fileLen = fileLen;
+	prefetch->pending = qFalse;
+}
+
+
+/*
+============
+FS_Prefetch
+
+Queues every file in the list and returns, they're kept for FS_LoadFile
+and FS_LoadFileView until they're taken or FS_ClearPrefetch is called.
+============
+*/
+void FS_Prefetch (char **list, int numFiles)
+{
+	fsPrefetch_t	*prefetch;
+	uint32			hashValue;
+	int				i;
+
+	for (i=0 ; i<numFiles && fs_numPrefetch<FS_MAX_PREFETCH ; i++) {
+		prefetch = &fs_prefetch[fs_numPrefetch++];
+		Q_strncpyz (prefetch->name, list[i], sizeof (prefetch->name));
+		prefetch->data = NULL;
+		prefetch->pending = qTrue;
+
+		hashValue = Com_HashFileName (prefetch->name, FS_MAX_HASHSIZE);
+		prefetch->hashNext = fs_prefetchHash[hashValue];
+		fs_prefetchHash[hashValue] = prefetch;
+		fs_numPrefetchHashed++;
+
+		FS_QueueLoad (list[i], NULL, FS_PREFETCH_PAD, FS_PrefetchDone, prefetch);
+	}
+
+	// Get the workers going
+	FS_PollLoads ();
+
+	if (fs_developer->intVal)
+		Com_Printf (0, "FS_Prefetch: queued %i of %i files\n", i, numFiles);
+}
+
+
+/*
+============
+FS_WaitPrefetch
+============
+*/
+static void FS_WaitPrefetch (fsPrefetch_t *prefetch)
+{
+	for ( ; ; ) {
+		FS_PollLoads ();
+		if (!prefetch->pending)
+			return;
+
+		// Read what's ahead of it, or wait for the workers that are
+		if (!Sys_RunJob ())
+			Sys_WaitJobs ();
+	}
+}
+
+
+/*
+============
+FS_TakePrefetch
+
+Returns the prefetched file and gives up ownership of it
+============
+*/
+static byte *FS_TakePrefetch (char *path, int *fileLen)
+{
+	fsPrefetch_t	*prefetch, **prev;
+	byte			*data;
+
+	prev = &fs_prefetchHash[Com_HashFileName (path, FS_MAX_HASHSIZE)];
+	for (prefetch=*prev ; prefetch ; prev=&prefetch->hashNext, prefetch=prefetch->hashNext) {
+		if (Q_stricmp (prefetch->name, path))
+			continue;
+
+		if (prefetch->pending)
+			FS_WaitPrefetch (prefetch);
+
+		*prev = prefetch->hashNext;
+		data = prefetch->data;
+		*fileLen = prefetch->fileLen;
+		prefetch->data = NULL;
+		fs_numPrefetchHashed--;
+		return data;
+	}
+
+	return NULL;
 }
 
 
 /*
-==============
-FS_CloseFile
-==============
+============
+FS_ClearPrefetch
+
+Frees whatever was prefetched and never asked for
+============
 */
-void FS_CloseFile (fileHandle_t fileNum)
+void FS_ClearPrefetch (void)
 {
-	fsHandleIndex_t	*handle;
+	int		i;
 
-	// Get local handle
-	handle = FS_GetHandle (fileNum);
-	if (!handle->inUse)
-		return;
+	// Nothing may still be reading into them
+	FS_FinishLoads ();
 
-	// Close file/zip
-	if (handle->regFile)
-		fclose (handle->regFile);
-	else if (handle->pkzFile) {
-		unzCloseCurrentFile (handle->pkzFile);
-		unzClose (handle->pkzFile);
+	for (i=0 ; i<fs_numPrefetch ; i++) {
+		if (fs_prefetch[i].data)
+			Mem_Free (fs_prefetch[i].data);
 	}
-	else
-		assert (0);
 
-	// Clear handle
-	handle->inUse = qFalse;
-	handle->name[0] = '\0';
-	handle->pkzFile = NULL;
-	handle->regFile = NULL;
+	memset (fs_prefetchHash, 0, sizeof (fs_prefetchHash));
+	fs_numPrefetch = 0;
+	fs_numPrefetchHashed = 0;
 }
 
 // ==========================================================================
@@ -901,6 +2007,22 @@ int FS_LoadFile (char *path, void **buffer, char *terminate)
 	fileHandle_t	fileNum;
 	size_t			termLen;
 
+	if (terminate)
+		termLen = strlen (terminate);
+	else
+		termLen = 0;
+
+	// Already loaded by FS_Prefetch?
+	if (buffer && fs_numPrefetchHashed && termLen <= FS_PREFETCH_PAD) {
+		buf = FS_TakePrefetch (path, &fileLen);
+		if (buf) {
+			if (termLen)
+				memcpy (buf+fileLen, terminate, termLen);
+			*buffer = buf;
+			return (int) ((size_t) fileLen + termLen);
+		}
+	}
+
 	// Look for it in the filesystem or pack files
 	fileLen = FS_OpenFile (path, &fileNum, FS_MODE_READ_BINARY);
 	if (!fileNum || fileLen <= 0) {
@@ -921,10 +2043,6 @@ int FS_LoadFile (char *path, void **buffer, char *terminate)
 
 	// Allocate a local buffer
 	// If we're terminating, pad by one byte. Mem_PoolAlloc below will zero-fill...
-	if (terminate)
-		termLen = strlen (terminate);
-	else
-		termLen = 0;
 	buf = Mem_PoolAlloc (fileLen+termLen, com_fileSysPool, 0);
 	*buffer = buf;
 
@@ -952,6 +2070,191 @@ void _FS_FreeFile (void *buffer, const char *fileName, const int fileLine)
 
 // ==========================================================================
 
+/*
+============
+FS_UnmapPack
+
+Releases a pack's mapping, and the pack itself if FS_SetGamedir already
+dropped it from the search path while handles or views were still out.
+============
+*/
+static void FS_UnmapPack (mPack_t *package)
+{
+	mPack_t	**prev;
+
+	for (prev=&fs_mappedPacks ; *prev ; prev=&(*prev)->mapNext) {
+		if (*prev != package)
+			continue;
+
+		*prev = package->mapNext;
+		break;
+	}
+
+	Sys_UnmapFile (package->mapBase, package->mapSize);
+	package->mapBase = NULL;
+	package->mapSize = 0;
+
+	if (package->orphaned) {
+		Mem_Free (package->files);
+		Mem_Free (package);
+	}
+}
+
+
+/*
+============
+FS_ReleaseMappedPack
+
+Drops a handle's or view's hold on a mapped pack.
+============
+*/
+static void FS_ReleaseMappedPack (mPack_t *package)
+{
+	assert (package->numViews > 0);
+	if (--package->numViews == 0 && package->orphaned)
+		FS_UnmapPack (package);
+}
+
+
+/*
+============
+FS_OpenView
+
+Opens path and, if it landed on a mapped pack entry, returns a pointer to
+it and holds the pack mapped. Otherwise the open handle is left in fileNum
+for the caller to read from.
+============
+*/
+static int FS_OpenView (char *path, const void **buffer, fileHandle_t *fileNum)
+{
+	fsHandleIndex_t	*handle;
+	int				fileLen;
+
+	*buffer = NULL;
+
+	fileLen = FS_OpenFile (path, fileNum, FS_MODE_READ_BINARY);
+	if (!*fileNum || fileLen <= 0) {
+		if (*fileNum)
+			FS_CloseFile (*fileNum);
+		*fileNum = 0;
+		return (fileLen >= 0) ? 0 : -1;
+	}
+
+	handle = FS_GetHandle (*fileNum);
+	if (handle->pkzEntry)
+		FS_OpenPkzEntry (handle);
+	if (!handle->mapData)
+		return fileLen;
+
+	// The view takes over the handle's hold on the data
+	*buffer = handle->mapData;
+	if (handle->mapPack)
+		handle->mapPack = NULL;
+	else
+		handle->pkzCache->refCount++;
+
+	FS_CloseFile (*fileNum);
+	*fileNum = 0;
+	return fileLen;
+}
+
+
+/*
+============
+FS_MapFile
+
+Like FS_LoadFile, but only succeeds for files found in a mapped pak or the
+pkz cache, and hands back a read-only pointer to them instead of a copy.
+Anything else returns -1 with a NULL buffer. Release with FS_FreeFileView.
+============
+*/
+int FS_MapFile (char *path, const void **buffer)
+{
+	fileHandle_t	fileNum;
+	int				fileLen;
+
+	fileLen = FS_OpenView (path, buffer, &fileNum);
+	if (fileNum) {
+		FS_CloseFile (fileNum);
+		return -1;
+	}
+
+	return *buffer ? fileLen : -1;
+}
+
+
+/*
+============
+FS_LoadFileView
+
+Read-only FS_LoadFile. Files in a mapped pak or the pkz cache are returned
+without copying, anything else is loaded into a buffer as usual. Either way
+the data must not be written to, isn't terminated, and is released with
+FS_FreeFileView.
+============
+*/
+int FS_LoadFileView (char *path, const void **buffer)
+{
+	fileHandle_t	fileNum;
+	byte			*buf;
+	int				fileLen;
+
+	// Already loaded by FS_Prefetch?
+	if (fs_numPrefetchHashed) {
+		buf = FS_TakePrefetch (path, &fileLen);
+		if (buf) {
+			*buffer = buf;
+			return fileLen;
+		}
+	}
+
+	fileLen = FS_OpenView (path, buffer, &fileNum);
+	if (!fileNum)
+		return fileLen;
+
+	buf = Mem_PoolAlloc (fileLen, com_fileSysPool, 0);
+	FS_Read (buf, fileLen, fileNum);
+	FS_CloseFile (fileNum);
+
+	*buffer = buf;
+	return fileLen;
+}
+
+
+/*
+============
+_FS_FreeFileView
+============
+*/
+void _FS_FreeFileView (const void *buffer, const char *fileName, const int fileLine)
+{
+	mPack_t	*package;
+	int		i;
+
+	if (!buffer)
+		return;
+
+	for (package=fs_mappedPacks ; package ; package=package->mapNext) {
+		if ((byte *)buffer < package->mapBase || (byte *)buffer >= package->mapBase + package->mapSize)
+			continue;
+
+		FS_ReleaseMappedPack (package);
+		return;
+	}
+
+	for (i=0 ; i<FS_MAX_PKZCACHE ; i++) {
+		if (fs_pkzCache[i].data != buffer)
+			continue;
+
+		FS_ReleasePkzCache (&fs_pkzCache[i]);
+		return;
+	}
+
+	_Mem_Free ((void *)buffer, fileName, fileLine);
+}
+
+// ==========================================================================
+
 /*
 ============
 FS_FileExists
@@ -1061,6 +2364,28 @@ mPack_t *FS_LoadPAK (char *fileName, qBool complain)
 		outPackFile++;
 	}
 
+	// Map the whole pak so entries can be read without a fopen each, if
+	// any entry runs past the end just leave it to the stdio path
+	outPack->mapBase = Sys_MapFile (fileName, &outPack->mapSize);
+	if (outPack->mapBase) {
+		for (i=0 ; i<numFiles ; i++) {
+			if (outPack->files[i].filePos < 0 || outPack->files[i].fileLen < 0
+			|| (size_t)outPack->files[i].filePos + (size_t)outPack->files[i].fileLen > outPack->mapSize)
+				break;
+		}
+
+		if (i == numFiles) {
+			outPack->mapNext = fs_mappedPacks;
+			fs_mappedPacks = outPack;
+		}
+		else {
+			Com_Printf (PRNT_WARNING, "FS_LoadPAK: \"%s\" has entries past the end of the file, not mapping\n", fileName);
+			Sys_UnmapFile (outPack->mapBase, outPack->mapSize);
+			outPack->mapBase = NULL;
+			outPack->mapSize = 0;
+		}
+	}
+
 	Com_Printf (0, "FS_LoadPAK: loaded \"%s\"\n", fileName);
 	return outPack;
 }
@@ -1207,7 +2532,7 @@ static void FS_AddGameDirectory (char *dir, char *gamePath)
 			fs_searchPaths = search;
 		}
 
-		FS_FreeFileList (packFiles, numPacks);
+		FS_FreeSysFileList (packFiles, numPacks);
 	}
 
 	// Load *.pkz files
@@ -1225,7 +2550,7 @@ static void FS_AddGameDirectory (char *dir, char *gamePath)
 		fs_searchPaths = search;
 	}
 
-	FS_FreeFileList (packFiles, numPacks);
+	FS_FreeSysFileList (packFiles, numPacks);
 
 	// Load *.pk3 files
 	numPacks = Sys_FindFiles (dir, "*/*.pk3", packFiles, FS_MAX_PAKS, 0, qFalse, qTrue, qFalse);
@@ -1242,7 +2567,7 @@ static void FS_AddGameDirectory (char *dir, char *gamePath)
 		fs_searchPaths = search;
 	}
 
-	FS_FreeFileList (packFiles, numPacks);
+	FS_FreeSysFileList (packFiles, numPacks);
 }
 
 /*
@@ -1288,10 +2613,15 @@ void FS_SetGamedir (char *dir, qBool firstTime)
 	}
 
 	// Free old inverted paths
-	if (fs_invSearchPaths)
+	if (fs_invSearchPaths) {
 		Mem_Free (fs_invSearchPaths);
+		fs_invSearchPaths = NULL;
+	}
 
 	// Free up any current game dir info
+	FS_ClearPrefetch ();
+	FS_ClearIndex ();
+	FS_FlushPkzCache ();
 	for ( ; fs_searchPaths != fs_baseSearchPath ; fs_searchPaths=next) {
 		next = fs_searchPaths->next;
 
@@ -1303,8 +2633,19 @@ void FS_SetGamedir (char *dir, qBool firstTime)
 			else if (package->pkz)
 				unzClose (package->pkz);
 
-			Mem_Free (package->files);
-			Mem_Free (package);
+			// Outstanding handles and views keep the mapping until the last is freed
+			if (package->mapBase && package->numViews) {
+				package->orphaned = qTrue;
+				package->pak = NULL;
+				package->pkz = NULL;
+			}
+			else {
+				if (package->mapBase)
+					FS_UnmapPack (package);
+
+				Mem_Free (package->files);
+				Mem_Free (package);
+			}
 		}
 
 		Mem_Free (fs_searchPaths);
@@ -1392,22 +2733,109 @@ void FS_ExecAutoexec (void)
 =============================================================================
 */
 
+/*
+================
+FS_FindMatch
+================
+*/
+static qBool FS_FindMatch (char *name, char *filter, char *extension)
+{
+	char	ext[MAX_QEXT];
+
+	// Match extension
+	if (extension) {
+		Com_FileExtension (name, ext, sizeof (ext));
+
+		// Filter or compare
+		if (strchr (extension, '*')) {
+			if (!Q_WildcardMatch (extension, ext, 1))
+				return qFalse;
+		}
+		else if (Q_stricmp (extension, ext))
+			return qFalse;
+	}
+
+	// Match filter
+	if (filter && !Q_WildcardMatch (filter, name, 1))
+		return qFalse;
+
+	return qTrue;
+}
+
+
+/*
+================
+FS_FindIndexed
+
+Binary searches for the first sorted entry under path/, the rest of them
+follow it
+================
+*/
+static fsFindEntry_t *FS_FindIndexed (fsPath_t *search, char *prefix, int prefixLen, int *count)
+{
+	fsFindEntry_t	*entries;
+	int				low, high, mid;
+
+	entries = search->findEntries;
+	low = 0;
+	high = search->numFindEntries;
+	while (low < high) {
+		mid = (low + high) >> 1;
+		if (Q_strnicmp (entries[mid].name, prefix, prefixLen) < 0)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	for (high=low ; high<search->numFindEntries ; high++) {
+		if (Q_strnicmp (entries[high].name, prefix, prefixLen))
+			break;
+	}
+
+	*count = high - low;
+	return entries + low;
+}
+
+
+static char		*fs_findNames[FS_MAX_FINDFILES];
+static fsPath_t	*fs_findPaths[FS_MAX_FINDFILES];
+static int		fs_findHashNext[FS_MAX_FINDFILES];
+static int		fs_findHash[FS_MAX_FINDHASH];
+static char		*fs_findDirFiles[FS_MAX_FINDFILES];
+
+// Callers may sort a list, so FS_FreeFileList finds its block by address
+typedef struct fsFindBlock_s {
+	struct fsFindBlock_s	*next;
+	size_t					size;		// of the names that follow
+} fsFindBlock_t;
+
+static fsFindBlock_t	*fs_findBlocks;
+
 /*
 ================
 FS_FindFiles
+
+Indexed search paths are answered from their sorted listing without going to
+disk, and the names all come back in one allocation that FS_FreeFileList
+releases. Recursive searches match the path anywhere in a pack name, like
+they always have, so indexed packs are walked whole for them.
 ================
 */
 size_t FS_FindFiles (char *path, char *filter, char *extension, char **fileList, size_t maxFiles, qBool addGameDir, qBool recurse)
 {
-	fsPath_t	*search;
-	mPackFile_t	*packFile;
-	mPack_t		*pack;
-	size_t		fileCount;
-	char		*name;
-	char		dir[MAX_OSPATH];
-	char		ext[MAX_QEXT];
-	static char	*dirFiles[FS_MAX_FINDFILES];
-	size_t		dirCount, i, j, k;
+	fsPath_t		*search;
+	fsFindEntry_t	*entries;
+	fsFindBlock_t	*findBlock;
+	mPack_t			*pack;
+	size_t			fileCount, blockSize;
+	qBool			anywhere;
+	char			*name, *block;
+	char			prefix[MAX_OSPATH];
+	char			dir[MAX_OSPATH];
+	char			ext[MAX_QEXT];
+	int				prefixLen, numEntries, numDirFiles, dirCount;
+	int				i, j, k;
+	uint32			hashValue;
 
 	// Sanity check
 	if (maxFiles > FS_MAX_FINDFILES) {
@@ -1415,108 +2843,135 @@ size_t FS_FindFiles (char *path, char *filter, char *extension, char **fileList,
 		maxFiles = FS_MAX_FINDFILES;
 	}
 
+	if (fs_index->intVal)
+		FS_CheckIndex ();
+
+	// Indexed names start with "path/"
+	Q_strncpyz (prefix, path, sizeof (prefix));
+	prefixLen = (int)strlen (prefix);
+	while (prefixLen && (prefix[prefixLen-1] == '/' || prefix[prefixLen-1] == '\\'))
+		prefix[--prefixLen] = '\0';
+	if (prefixLen && prefixLen < sizeof (prefix)-1) {
+		prefix[prefixLen++] = '/';
+		prefix[prefixLen] = '\0';
+	}
+
+	memset (fs_findHash, -1, sizeof (fs_findHash));
+
 	// Search through the path, one element at a time
 	fileCount = 0;
-	for (k=0 ; k<fs_numInvSearchPaths ; k++) {
+	numDirFiles = 0;
+	for (k=0 ; k<(int)fs_numInvSearchPaths && fileCount<maxFiles ; k++) {
 		search = fs_invSearchPaths[k];
 
-		if (search->package) {
-			// Pack file
-			pack = search->package;
-			for (i=0, packFile=pack->files ; i<pack->numFiles ; i++, packFile++) {
-				// Match path
-				if (!recurse) {
-					Com_FilePath (packFile->fileName, dir, sizeof (dir));
-					if (Q_stricmp (path, dir))
-						continue;
-				}
-				// Check path
-				else if (!strstr (packFile->fileName, path))
-					continue;
-
-				// Match extension
-				if (extension) {
-					Com_FileExtension (packFile->fileName, ext, sizeof (ext));
-
-					// Filter or compare
-					if (strchr (extension, '*')) {
-						if (!Q_WildcardMatch (extension, ext, 1))
-							continue;
-					}
-					else {
-						if (Q_stricmp (extension, ext))
-							continue;
-					}
-				}
-
-				// Match filter
-				if (filter) {
-					if (!Q_WildcardMatch (filter, packFile->fileName, 1))
-						continue;
-				}
-
-				// Found something
-				name = packFile->fileName;
-				if (fileCount < maxFiles) {
-					// Ignore duplicates
-					for (j=0 ; j<fileCount ; j++) {
-						if (!Q_stricmp (fileList[j], name))
-							break;
-					}
-
-					if (j == fileCount) {
-						if (addGameDir)
-							fileList[fileCount++] = Mem_PoolStrDup (Q_VarArgs ("%s/%s", search->gamePath, name), com_fileSysPool, 0);
-						else
-							fileList[fileCount++] = Mem_PoolStrDup (name, com_fileSysPool, 0);
-					}
-				}
+		pack = NULL;
+		entries = NULL;
+		anywhere = (recurse && search->package) ? qTrue : qFalse;
+		if (fs_index->intVal && fs_indexValid && search->indexed) {
+			if (anywhere) {
+				entries = search->findEntries;
+				numEntries = search->numFindEntries;
 			}
+			else
+				entries = FS_FindIndexed (search, prefix, prefixLen, &numEntries);
+		}
+		else if (search->package) {
+			// Unindexed packages are walked whole
+			pack = search->package;
+			numEntries = (int)pack->numFiles;
 		}
 		else {
-			// Directory tree
+			// Directory tree that isn't indexed
 			Q_snprintfz (dir, sizeof (dir), "%s/%s", search->pathName, path);
 
 			if (extension) {
 				Q_snprintfz (ext, sizeof (ext), "*.%s", extension);
-				dirCount = Sys_FindFiles (dir, ext, dirFiles, FS_MAX_FINDFILES, 0, recurse, qTrue, qFalse);
+				dirCount = Sys_FindFiles (dir, ext, fs_findDirFiles+numDirFiles, FS_MAX_FINDFILES-numDirFiles, 0, recurse, qTrue, qFalse);
 			}
 			else {
-				dirCount = Sys_FindFiles (dir, "*", dirFiles, FS_MAX_FINDFILES, 0, recurse, qTrue, qTrue);
+				dirCount = Sys_FindFiles (dir, "*", fs_findDirFiles+numDirFiles, FS_MAX_FINDFILES-numDirFiles, 0, recurse, qTrue, qTrue);
 			}
 
-			for (i=0 ; i<dirCount ; i++) {
-				// Match filter
-				if (filter) {
-					if (!Q_WildcardMatch (filter, dirFiles[i]+strlen(search->pathName)+1, 1)) {
-						Mem_Free (dirFiles[i]);
-						continue;
-					}
-				}
+			numEntries = dirCount;
+		}
 
-				// Found something
-				name = dirFiles[i] + strlen (search->pathName) + 1;
-
-				if (fileCount < maxFiles) {
-					// Ignore duplicates
-					for (j=0 ; j<fileCount ; j++) {
-						if (!Q_stricmp (fileList[j], name))
-							break;
-					}
-
-					if (j == fileCount) {
-						if (addGameDir)
-							fileList[fileCount++] = Mem_PoolStrDup (Q_VarArgs ("%s/%s", search->gamePath, name), com_fileSysPool, 0);
-						else
-							fileList[fileCount++] = Mem_PoolStrDup (name, com_fileSysPool, 0);
-					}
-				}
+		for (i=0 ; i<numEntries && fileCount<maxFiles ; i++) {
+			if (entries) {
+				name = entries[i].name;
+
+				// Only loose directories are marked, and they're only listed without an extension
+				if (entries[i].isDir && extension)
+					continue;
+				if (anywhere && !strstr (name, path))
+					continue;
+			}
+			else if (pack) {
+				name = pack->files[i].fileName;
+				if (anywhere ? !strstr (name, path) : Q_strnicmp (name, prefix, prefixLen))
+					continue;
+			}
+			else
+				name = fs_findDirFiles[numDirFiles+i] + strlen (search->pathName) + 1;
+
+			// Sys_FindFiles already matched the path and extension
+			if (entries || pack) {
+				if (!recurse && strchr (name+prefixLen, '/'))
+					continue;
+				if (!FS_FindMatch (name, filter, extension))
+					continue;
+			}
+			else if (!FS_FindMatch (name, filter, NULL))
+				continue;
 
-				Mem_Free (dirFiles[i]);
+			// Ignore duplicates
+			hashValue = Com_HashFileName (name, FS_MAX_FINDHASH);
+			for (j=fs_findHash[hashValue] ; j!=-1 ; j=fs_findHashNext[j]) {
+				if (Q_stricmp (fs_findNames[j], name))
+					continue;
+				if (addGameDir && Q_stricmp (fs_findPaths[j]->gamePath, search->gamePath))
+					continue;
+				break;
 			}
+			if (j != -1)
+				continue;
+
+			// Found something
+			fs_findNames[fileCount] = name;
+			fs_findPaths[fileCount] = search;
+			fs_findHashNext[fileCount] = fs_findHash[hashValue];
+			fs_findHash[hashValue] = (int)fileCount;
+			fileCount++;
+		}
+
+		if (!entries && !pack)
+			numDirFiles += dirCount;
+	}
+
+	// Pack the names into one block
+	if (fileCount) {
+		blockSize = 0;
+		for (i=0 ; i<(int)fileCount ; i++) {
+			blockSize += strlen (fs_findNames[i]) + 1;
+			if (addGameDir)
+				blockSize += strlen (fs_findPaths[i]->gamePath) + 1;
+		}
+
+		findBlock = Mem_PoolAlloc (sizeof (fsFindBlock_t) + blockSize, com_fileSysPool, 0);
+		findBlock->size = blockSize;
+		findBlock->next = fs_findBlocks;
+		fs_findBlocks = findBlock;
+
+		block = (char *)(findBlock + 1);
+		for (i=0 ; i<(int)fileCount ; i++) {
+			fileList[i] = block;
+			if (addGameDir)
+				block += sprintf (block, "%s/%s", fs_findPaths[i]->gamePath, fs_findNames[i]) + 1;
+			else
+				block += sprintf (block, "%s", fs_findNames[i]) + 1;
 		}
 	}
 
+	FS_FreeSysFileList (fs_findDirFiles, numDirFiles);
 	return fileCount;
 }
 
@@ -1524,19 +2979,37 @@ size_t FS_FindFiles (char *path, char *filter, char *extension, char **fileList,
 /*
 =============
 _FS_FreeFileList
+
+Frees a FS_FindFiles list. The names all live in one block, found from
+whichever name is left in the list.
 =============
 */
 void _FS_FreeFileList (char **list, size_t num, const char *fileName, const int fileLine)
 {
-	size_t		i;
+	fsFindBlock_t	*findBlock, **prev;
+	char			*name;
+	size_t			i;
 
 	for (i=0 ; i<num ; i++) {
-		if (!list[i])
+		if (list[i])
+			break;
+	}
+	if (i == num)
+		return;
+
+	name = list[i];
+	for (prev=&fs_findBlocks ; *prev ; prev=&(*prev)->next) {
+		findBlock = *prev;
+		if (name < (char *)(findBlock + 1) || name >= (char *)(findBlock + 1) + findBlock->size)
 			continue;
 
-		_Mem_Free (list[i], fileName, fileLine);
-		list[i] = NULL;
+		*prev = findBlock->next;
+		_Mem_Free (findBlock, fileName, fileLine);
+		memset (list, 0, sizeof (char *) * num);
+		return;
 	}
+
+	Com_Error (ERR_FATAL, "FS_FreeFileList: list not from FS_FindFiles (%s:%i)", fileName, fileLine);
 }
 
 
@@ -1643,7 +3116,12 @@ static void FS_ListHandles_f (void)
 		case FS_MODE_WRITE_TEXT:	Com_Printf (0, "WT ");	break;
 		case FS_MODE_APPEND_TEXT:	Com_Printf (0, "AT ");	break;
 		}
-		Com_Printf (0, "%s\n", index->name);
+		if (index->pkzCache)
+			Com_Printf (0, "%s (cached)\n", index->name);
+		else if (index->mapData)
+			Com_Printf (0, "%s (mapped)\n", index->name);
+		else
+			Com_Printf (0, "%s\n", index->name);
 	}
 }
 
@@ -1674,6 +3152,17 @@ static void FS_Path_f (void)
 		Com_Printf (0, "%s : %s\n", l->from, l->to);
 }
 
+
+/*
+============
+FS_Rescan_f
+============
+*/
+static void FS_Rescan_f (void)
+{
+	FS_InvalidateIndex ();
+}
+
 /*
 =============================================================================
 
@@ -1700,12 +3189,16 @@ void FS_Init (void)
 	Cmd_AddCommand ("link",			FS_Link_f,			"");
 	Cmd_AddCommand ("listHandles",	FS_ListHandles_f,	"Lists active files");
 	Cmd_AddCommand ("path",			FS_Path_f,			"");
+	Cmd_AddCommand ("fs_rescan",	FS_Rescan_f,		"Picks up files changed outside the game");
 
 	fs_basedir		= Cvar_Register ("basedir",			".",	CVAR_READONLY);
 	fs_cddir		= Cvar_Register ("cddir",			"",		CVAR_READONLY);
 	fs_game			= Cvar_Register ("game",			"",		CVAR_LATCH_SERVER|CVAR_SERVERINFO|CVAR_RESET_GAMEDIR);
 	fs_gamedircvar	= Cvar_Register ("gamedir",			"",		CVAR_SERVERINFO|CVAR_READONLY);
 	fs_defaultPaks	= Cvar_Register ("fs_defaultPaks",	"1",	CVAR_ARCHIVE);
+	fs_index		= Cvar_Register ("fs_index",		"1",	0);
+	fs_pkzCacheSize	= Cvar_Register ("fs_pkzCacheSize",	"8192",	CVAR_ARCHIVE);
+	fs_threads		= Cvar_Register ("fs_threads",		"0",	CVAR_ARCHIVE);
 
 	// Load pak files
 	if (fs_cddir->string[0])
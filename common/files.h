@@ -724,6 +724,7 @@ typedef struct dQ3BspGridLight_s {
 */
 
 #define FS_FreeFile(buffer) _FS_FreeFile ((buffer),__FILE__,__LINE__)
+#define FS_FreeFileView(buffer) _FS_FreeFileView ((buffer),__FILE__,__LINE__)
 #define FS_FreeFileList(list,num) _FS_FreeFileList ((list),(num),__FILE__,__LINE__)
 
 int			FS_ZLibDecompress (byte *in, int inlen, byte *out, int outlen, int wbits);
@@ -744,8 +745,20 @@ void		FS_CloseFile (fileHandle_t fileNum);
 int			FS_LoadFile (char *path, void **buffer, char *terminate);
 void		_FS_FreeFile (void *buffer, const char *fileName, const int fileLine);
 
+int			FS_MapFile (char *path, const void **buffer);
+int			FS_LoadFileView (char *path, const void **buffer);
+void		_FS_FreeFileView (const void *buffer, const char *fileName, const int fileLine);
+
 int			FS_FileExists (char *path);
 
+void		FS_InvalidateIndex (void);
+
+void		FS_LoadFileAsync (char *path, char *terminate, void (*callback) (void *arg, void *buffer, int fileLen), void *arg);
+void		FS_PollLoads (void);
+void		FS_FinishLoads (void);
+void		FS_Prefetch (char **list, int numFiles);
+void		FS_ClearPrefetch (void);
+
 char		*FS_Gamedir (void);
 void		FS_SetGamedir (char *dir, qBool firstTime);
 
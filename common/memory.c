@@ -20,7 +20,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 //
 // memory.c
 // Memory handling with sentinel checking and pools with tags for grouped free'ing
-// FIXME TODO: other neat features like maximum size, hunk management?
+// Arena pools bump-allocate out of per-tag slabs that are only released as a whole
+// FIXME TODO: other neat features like maximum size?
 //
 
 #include "common.h"
@@ -28,31 +29,79 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #define MEM_HEAD_SENTINEL_TOP	0xFEBDFAED
 #define MEM_HEAD_SENTINEL_BOT	0xD0BAF0FF
 #define MEM_FOOT_SENTINEL		0xF00DF00D
+#define MEM_ARENA_SENTINEL		0xA4E4A4E4
+#define MEM_ARENA_FREED			0xA4E4DEAD
+
+// Debug builds keep full headers on arena blocks so integrity checks and per-block stats still work
+#ifndef NDEBUG
+# define MEM_ARENA_HEADERS
+#endif
+
+#define MEM_ARENA_MIN_SLAB		8192
 
 typedef struct memBlockFoot_s {
 	uint32				sentinel;					// For memory integrity checking
 } memBlockFoot_t;
 
+// NOTE: botSentinel must stay the last 4 bytes before memPointer, Mem_Free tells
+// full headers from compact arena headers by the uint32 preceding the pointer
 typedef struct memBlock_s {
-	struct memBlock_s	*next;
-
-	uint32				topSentinel;				// For memory integrity checking
+	struct memBlock_s	*next;						// Pool block list
+	struct memBlock_s	*prev;
+	struct memBlock_s	*tagNext;					// Tag block list
+	struct memBlock_s	*tagPrev;
 
 	struct memPool_s	*pool;						// Owner pool
-	int					tagNum;						// For group free
+	struct memTag_s		*tag;						// Owner tag list
 	size_t				size;						// Size of allocation including this header
 
 	const char			*allocFile;					// File the memory was allocated in
-	int					allocLine;					// Line the memory was allocated at
 
 	void				*memPointer;				// pointer to allocated memory
 	size_t				memSize;					// Size minus the header
 
 	memBlockFoot_t		*footer;					// Allocated in the space AFTER the block to check for overflow
 
+	uint32				topSentinel;				// For memory integrity checking
+	int					tagNum;						// For group free
+	int					allocLine;					// Line the memory was allocated at
 	uint32				botSentinel;				// For memory integrity checking
 } memBlock_t;
 
+// Header used on arena allocations when MEM_ARENA_HEADERS is not set
+typedef struct memArenaHead_s {
+	struct memTag_s		*tag;						// Owner tag list
+	uint32				size;						// Size of allocation including this header
+	uint32				sentinel;					// MEM_ARENA_SENTINEL, must be last
+} memArenaHead_t;
+
+#define MEM_ARENA_HEADSIZE	((sizeof (memArenaHead_t) + 15) & ~15)
+
+typedef struct memSlab_s {
+	struct memSlab_s	*next;
+
+	byte				*base;						// 32 byte aligned start of the slab
+	size_t				size;						// Usable bytes
+	size_t				used;						// Bytes handed out so far
+} memSlab_t;
+
+#define MEM_TAG_HASH_SIZE	64
+
+typedef struct memTag_s {
+	int					tagNum;
+	struct memTag_s		*hashNext;
+	struct memPool_s	*pool;						// Owner pool
+
+	memBlock_t			*blocks;					// Blocks allocated with this tag
+	memSlab_t			*slabs;						// Arena slabs, head is the one being bumped
+
+	size_t				blockCount;					// Total allocated blocks with this tag
+	size_t				byteCount;					// Total allocated bytes with this tag
+
+	size_t				compactBlocks;				// Arena blocks without a full header (not in the block lists)
+	size_t				compactBytes;
+} memTag_t;
+
 #define MEM_MAX_POOLCOUNT	32
 #define MEM_MAX_POOLNAME	64
 
@@ -61,10 +110,17 @@ typedef struct memPool_s {
 	qBool				inUse;						// Slot in use?
 
 	memBlock_t			*blocks;					// Allocated blocks
+	memTag_t			*tagHash[MEM_TAG_HASH_SIZE];	// Per-tag block lists
 
 	size_t				blockCount;					// Total allocated blocks
 	size_t				byteCount;					// Total allocated bytes
 
+	size_t				arenaSlabSize;				// Non-zero for arena pools
+	size_t				slabCount;					// Arena slabs currently held
+	size_t				slabBytes;					// Arena slab bytes currently held
+	size_t				compactBlocks;				// Arena blocks without a full header
+	size_t				compactBytes;
+
 	const char			*createFile;				// File this pool was created on
 	int					createLine;					// Line this pool was created on
 } memPool_t;
@@ -72,6 +128,86 @@ typedef struct memPool_s {
 static memPool_t	m_poolList[MEM_MAX_POOLCOUNT];
 static uint32		m_numPools;
 
+#define MEM_OBJ_SENTINEL		0x0B1EC7ED
+#define MEM_OBJ_ALIGN			64					// Cache line
+#define MEM_OBJ_SLABSIZE		(128*1024)			// Slabs are aligned to their size, so objects can find them
+#define MEM_OBJ_MAXSIZE			16384
+#define MEM_OBJ_MAXCLASSES		16
+
+typedef struct memObjSlab_s {
+	uint32				sentinel;
+	struct memObjClass_s	*objClass;				// NULL on oversize slabs
+	size_t				size;						// Total size of the slab
+
+	struct memObjSlab_s	*next;						// Class list of slabs with free objects
+	struct memObjSlab_s	*prev;
+
+	void				*freeObjs;					// Released objects
+	byte				*freshObjs;					// Never handed out objects start here
+	uint32				numUsed;
+	qBool				onList;
+} memObjSlab_t;
+
+#define MEM_OBJ_HEADSIZE		((sizeof (memObjSlab_t) + MEM_OBJ_ALIGN-1) & ~(MEM_OBJ_ALIGN-1))
+
+typedef struct memObjClass_s {
+	size_t				objSize;
+	uint32				objsPerSlab;
+
+	memObjSlab_t		*partial;					// Slabs with free objects
+
+	size_t				numSlabs;
+	size_t				numUsed;
+	size_t				peakUsed;
+	size_t				numAllocs;					// Lifetime counters
+	size_t				numFrees;
+} memObjClass_t;
+
+static const size_t	m_objClassSizes[MEM_OBJ_MAXCLASSES] = {
+	64, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072, 4096, 6144, 8192, 12288, MEM_OBJ_MAXSIZE
+};
+static memObjClass_t	m_objClasses[MEM_OBJ_MAXCLASSES];
+static byte				m_objClassForSize[MEM_OBJ_MAXSIZE/MEM_OBJ_ALIGN+1];
+
+static size_t		m_objOversizeCount;
+static size_t		m_objOversizeBytes;
+
+#define MEM_MAX_SITES			4096
+#define MEM_SITE_HASH_SIZE		1024
+
+typedef struct memSite_s {
+	const char			*filePtr;					// Key, may dangle once a module unloads
+	int					line;
+	char				file[MAX_QPATH];			// Copy for printing
+	struct memSite_s	*hashNext;
+
+	int64				liveBytes;					// Blocks with a full header only
+	int64				liveBlocks;
+	size_t				totalAllocs;
+	size_t				totalBytes;
+
+	size_t				frameAllocs;				// Since the start of this frame
+	size_t				frameBytes;
+	size_t				lastFrameAllocs;
+	size_t				peakFrameAllocs;
+
+	int64				snapBytes;					// Live counts at mem_snapshot
+	int64				snapBlocks;
+} memSite_t;
+
+static cVar_t		*mem_profile;
+
+static qBool		m_profiling;
+static memSite_t	m_sites[MEM_MAX_SITES];
+static memSite_t	*m_siteHash[MEM_SITE_HASH_SIZE];
+static uint32		m_numSites;
+static memSite_t	m_overflowSite;
+static uint32		m_profileFrames;
+static size_t		m_frameAllocs, m_frameBytes;
+static size_t		m_lastFrameAllocs, m_lastFrameBytes;
+static size_t		m_peakFrameAllocs, m_peakFrameBytes;
+static qBool		m_haveSnapshot;
+
 memPool_t			*m_genericPool;
 
 /*
@@ -105,12 +241,201 @@ static memPool_t *Mem_FindPool (const char *name)
 }
 
 
+/*
+========================
+Mem_FindTag
+
+Returns the block list for a tag within a pool, optionally creating it
+========================
+*/
+static memTag_t *Mem_FindTag (memPool_t *pool, const int tagNum, const qBool create)
+{
+	memTag_t	*tag;
+	uint32		hash;
+
+	hash = (uint32)tagNum & (MEM_TAG_HASH_SIZE-1);
+	for (tag=pool->tagHash[hash] ; tag ; tag=tag->hashNext) {
+		if (tag->tagNum == tagNum)
+			return tag;
+	}
+
+	if (!create)
+		return NULL;
+
+	tag = calloc (1, sizeof (memTag_t));
+	if (!tag)
+		Com_Error (ERR_FATAL, "Mem_FindTag: failed on allocation of tag %i in pool '%s'\n", tagNum, pool->name);
+
+	tag->tagNum = tagNum;
+	tag->pool = pool;
+	tag->hashNext = pool->tagHash[hash];
+	pool->tagHash[hash] = tag;
+	return tag;
+}
+
+
+/*
+========================
+Mem_ReleaseSlabs
+
+Releases the arena slabs of a tag, along with every compact block in them
+========================
+*/
+static size_t Mem_ReleaseSlabs (memTag_t *tag)
+{
+	memPool_t	*pool = tag->pool;
+	memSlab_t	*slab, *next;
+	size_t		size;
+
+	for (slab=tag->slabs ; slab ; slab=next) {
+		next = slab->next;
+
+		pool->slabCount--;
+		pool->slabBytes -= slab->size;
+		free (slab);
+	}
+	tag->slabs = NULL;
+
+	size = tag->compactBytes;
+	pool->blockCount -= tag->compactBlocks;
+	pool->byteCount -= tag->compactBytes;
+	pool->compactBlocks -= tag->compactBlocks;
+	pool->compactBytes -= tag->compactBytes;
+	tag->blockCount -= tag->compactBlocks;
+	tag->byteCount -= tag->compactBytes;
+	tag->compactBlocks = 0;
+	tag->compactBytes = 0;
+
+	return size;
+}
+
+
+/*
+========================
+Mem_ReleaseTags
+========================
+*/
+static void Mem_ReleaseTags (memPool_t *pool)
+{
+	memTag_t	*tag, *next;
+	uint32		i;
+
+	for (i=0 ; i<MEM_TAG_HASH_SIZE ; i++) {
+		for (tag=pool->tagHash[i] ; tag ; tag=next) {
+			next = tag->hashNext;
+			Mem_ReleaseSlabs (tag);
+			free (tag);
+		}
+		pool->tagHash[i] = NULL;
+	}
+}
+
+
+/*
+========================
+Mem_ArenaAlloc
+
+Bumps the tag's current slab, starting a new one when it runs out. Slabs double
+in size up to the pool's slab size, anything larger than half a slab gets one of
+its own so the current slab can keep being filled.
+========================
+*/
+static byte *Mem_ArenaAlloc (memPool_t *pool, memTag_t *tag, const size_t size, const char *fileName, const int fileLine)
+{
+	memSlab_t	*slab;
+	size_t		slabSize;
+	byte		*out;
+
+	slab = tag->slabs;
+	if (!slab || slab->used + size > slab->size) {
+		if (size > pool->arenaSlabSize/2) {
+			slabSize = size;
+		}
+		else {
+			slabSize = slab ? slab->size*2 : MEM_ARENA_MIN_SLAB;
+			if (slabSize > pool->arenaSlabSize)
+				slabSize = pool->arenaSlabSize;
+			if (slabSize < size)
+				slabSize = size;
+		}
+
+		// Fresh slabs are zero filled, and never handed out twice
+		slab = calloc (1, sizeof (memSlab_t) + slabSize + 31);
+		if (!slab)
+			Com_Error (ERR_FATAL, "Mem_Alloc: failed on arena slab allocation of %i bytes\n" "alloc: %s:#%i", slabSize, fileName, fileLine);
+
+		slab->base = (byte *)(((size_t)(slab+1) + 31) & ~31);
+		slab->size = slabSize;
+		slab->used = 0;
+
+		pool->slabCount++;
+		pool->slabBytes += slabSize;
+
+		// Dedicated slabs go behind the one being bumped
+		if (slabSize == size && tag->slabs) {
+			slab->next = tag->slabs->next;
+			tag->slabs->next = slab;
+		}
+		else {
+			slab->next = tag->slabs;
+			tag->slabs = slab;
+		}
+	}
+
+	out = slab->base + slab->used;
+	slab->used += size;
+	return out;
+}
+
+
+/*
+========================
+Mem_LinkTag
+========================
+*/
+static void Mem_LinkTag (memTag_t *tag, memBlock_t *mem)
+{
+	mem->tag = tag;
+	mem->tagNum = tag->tagNum;
+	mem->tagPrev = NULL;
+	mem->tagNext = tag->blocks;
+	if (tag->blocks)
+		tag->blocks->tagPrev = mem;
+	tag->blocks = mem;
+
+	tag->blockCount++;
+	tag->byteCount += mem->size;
+}
+
+
+/*
+========================
+Mem_UnlinkTag
+========================
+*/
+static void Mem_UnlinkTag (memBlock_t *mem)
+{
+	memTag_t	*tag = mem->tag;
+
+	if (mem->tagPrev)
+		mem->tagPrev->tagNext = mem->tagNext;
+	else
+		tag->blocks = mem->tagNext;
+	if (mem->tagNext)
+		mem->tagNext->tagPrev = mem->tagPrev;
+
+	tag->blockCount--;
+	tag->byteCount -= mem->size;
+	mem->tag = NULL;
+}
+
+
 /*
 ========================
 _Mem_CreatePool
 ========================
 */
-memPool_t *_Mem_CreatePool (const char *name, const char *fileName, const int fileLine)
+memPool_t *_Mem_CreatePool (const char *name, const size_t arenaSlabSize, const char *fileName, const int fileLine)
 {
 	memPool_t	*pool;
 	uint32		i;
@@ -124,6 +449,8 @@ memPool_t *_Mem_CreatePool (const char *name, const char *fileName, const int fi
 	// See if it already exists
 	pool = Mem_FindPool (name);
 	if (pool) {
+		if (pool->arenaSlabSize != arenaSlabSize && !pool->blockCount)
+			pool->arenaSlabSize = arenaSlabSize;
 		return pool;
 	}
 
@@ -140,8 +467,14 @@ memPool_t *_Mem_CreatePool (const char *name, const char *fileName, const int fi
 
 	// Store values
 	pool->blocks = NULL;
+	memset (pool->tagHash, 0, sizeof (pool->tagHash));
 	pool->blockCount = 0;
 	pool->byteCount = 0;
+	pool->arenaSlabSize = arenaSlabSize;
+	pool->slabCount = 0;
+	pool->slabBytes = 0;
+	pool->compactBlocks = 0;
+	pool->compactBytes = 0;
 	pool->createFile = fileName;
 	pool->createLine = fileLine;
 	pool->inUse = qTrue;
@@ -166,6 +499,7 @@ size_t _Mem_DeletePool (struct memPool_s *pool, const char *fileName, const int
 	size = _Mem_FreePool (pool, fileName, fileLine);
 
 	// Simple, yes?
+	Mem_ReleaseTags (pool);
 	pool->inUse = qFalse;
 	pool->name[0] = '\0';
 
@@ -173,6 +507,176 @@ size_t _Mem_DeletePool (struct memPool_s *pool, const char *fileName, const int
 }
 
 
+/*
+==============================================================================
+
+	ALLOCATION PROFILING
+
+	With mem_profile set every allocation is aggregated by the file and line it
+	came from. Live counts only cover blocks with a full header, compact arena
+	blocks and object class allocations show up in the allocation counts only.
+==============================================================================
+*/
+
+/*
+========================
+Mem_FindSite
+========================
+*/
+static memSite_t *Mem_FindSite (const char *fileName, const int fileLine)
+{
+	memSite_t	*site;
+	uint32		hash;
+
+	if (!fileName)
+		fileName = "UNKNOWN";
+
+	hash = ((uint32)((size_t)fileName >> 3) ^ ((uint32)fileLine * 2654435761U)) & (MEM_SITE_HASH_SIZE-1);
+	for (site=m_siteHash[hash] ; site ; site=site->hashNext) {
+		// The pointer match is fast, the name check covers modules reloaded at the same address
+		if (site->filePtr == fileName && site->line == fileLine && !strncmp (site->file, fileName, sizeof (site->file)-1))
+			return site;
+	}
+
+	if (m_numSites >= MEM_MAX_SITES)
+		return &m_overflowSite;
+
+	site = &m_sites[m_numSites++];
+	memset (site, 0, sizeof (memSite_t));
+	site->filePtr = fileName;
+	site->line = fileLine;
+	Q_strncpyz (site->file, fileName, sizeof (site->file));
+
+	site->hashNext = m_siteHash[hash];
+	m_siteHash[hash] = site;
+	return site;
+}
+
+
+/*
+========================
+Mem_ProfileAlloc
+========================
+*/
+static void Mem_ProfileAlloc (const char *fileName, const int fileLine, const size_t size, const qBool live)
+{
+	memSite_t	*site;
+
+	site = Mem_FindSite (fileName, fileLine);
+	site->totalAllocs++;
+	site->totalBytes += size;
+	site->frameAllocs++;
+	site->frameBytes += size;
+	if (live) {
+		site->liveBlocks++;
+		site->liveBytes += size;
+	}
+
+	m_frameAllocs++;
+	m_frameBytes += size;
+}
+
+
+/*
+========================
+Mem_ProfileFree
+========================
+*/
+static void Mem_ProfileFree (const char *fileName, const int fileLine, const size_t size)
+{
+	memSite_t	*site;
+
+	site = Mem_FindSite (fileName, fileLine);
+	site->liveBlocks--;
+	site->liveBytes -= size;
+}
+
+
+/*
+========================
+Mem_ProfileStart
+
+Clears the site table and seeds it with every block that is already live
+========================
+*/
+static void Mem_ProfileStart (void)
+{
+	memPool_t	*pool;
+	memBlock_t	*mem;
+	uint32		i;
+
+	memset (m_siteHash, 0, sizeof (m_siteHash));
+	memset (&m_overflowSite, 0, sizeof (m_overflowSite));
+	Q_strncpyz (m_overflowSite.file, "(site table full)", sizeof (m_overflowSite.file));
+	m_numSites = 0;
+	m_profileFrames = 0;
+	m_frameAllocs = m_frameBytes = 0;
+	m_lastFrameAllocs = m_lastFrameBytes = 0;
+	m_peakFrameAllocs = m_peakFrameBytes = 0;
+	m_haveSnapshot = qFalse;
+
+	for (i=0, pool=&m_poolList[0] ; i<m_numPools ; pool++, i++) {
+		if (!pool->inUse)
+			continue;
+
+		for (mem=pool->blocks ; mem ; mem=mem->next) {
+			memSite_t	*site = Mem_FindSite (mem->allocFile, mem->allocLine);
+
+			site->liveBlocks++;
+			site->liveBytes += mem->size;
+		}
+	}
+
+	m_profiling = qTrue;
+}
+
+
+/*
+========================
+Mem_Frame
+
+Rolls the per-frame profiling counters over
+========================
+*/
+void Mem_Frame (void)
+{
+	memSite_t	*site;
+	uint32		i;
+
+	if (mem_profile && mem_profile->modified) {
+		mem_profile->modified = qFalse;
+		if (mem_profile->intVal && !m_profiling) {
+			Mem_ProfileStart ();
+			Com_Printf (0, "Memory profiling started, %i sites already live\n", m_numSites);
+		}
+		else if (!mem_profile->intVal && m_profiling) {
+			m_profiling = qFalse;
+			Com_Printf (0, "Memory profiling stopped\n");
+		}
+	}
+
+	if (!m_profiling)
+		return;
+
+	for (i=0, site=&m_sites[0] ; i<m_numSites ; site++, i++) {
+		site->lastFrameAllocs = site->frameAllocs;
+		if (site->frameAllocs > site->peakFrameAllocs)
+			site->peakFrameAllocs = site->frameAllocs;
+		site->frameAllocs = 0;
+		site->frameBytes = 0;
+	}
+
+	m_lastFrameAllocs = m_frameAllocs;
+	m_lastFrameBytes = m_frameBytes;
+	if (m_frameAllocs > m_peakFrameAllocs)
+		m_peakFrameAllocs = m_frameAllocs;
+	if (m_frameBytes > m_peakFrameBytes)
+		m_peakFrameBytes = m_frameBytes;
+	m_frameAllocs = 0;
+	m_frameBytes = 0;
+	m_profileFrames++;
+}
+
 /*
 ==============================================================================
 
@@ -189,14 +693,41 @@ _Mem_Free
 size_t _Mem_Free (const void *ptr, const char *fileName, const int fileLine)
 {
 	memBlock_t	*mem;
-	memBlock_t	*search;
-	memBlock_t	**prev;
 	size_t		size;
 
 	assert (ptr);
 	if (!ptr)
 		return 0;
 
+	// Compact arena blocks are only accounted for here, their slab goes with the tag
+	switch (((const uint32 *)ptr)[-1]) {
+	case MEM_ARENA_SENTINEL:
+		{
+			memArenaHead_t	*head = (memArenaHead_t *)((byte *)ptr - sizeof (memArenaHead_t));
+			memTag_t		*tag = head->tag;
+
+			head->sentinel = MEM_ARENA_FREED;
+			size = head->size;
+
+			tag->blockCount--;
+			tag->byteCount -= size;
+			tag->compactBlocks--;
+			tag->compactBytes -= size;
+			tag->pool->blockCount--;
+			tag->pool->byteCount -= size;
+			tag->pool->compactBlocks--;
+			tag->pool->compactBytes -= size;
+		}
+		return size;
+
+	case MEM_ARENA_FREED:
+		Com_Error (ERR_FATAL,
+			"Mem_Free: arena block freed twice\n"
+			"free: %s:#%i",
+			fileName, fileLine);
+		break;
+	}
+
 	// Check sentinels
 	mem = (memBlock_t *)((byte *)ptr - sizeof (memBlock_t));
 	if (mem->topSentinel != MEM_HEAD_SENTINEL_TOP) {
@@ -228,27 +759,26 @@ size_t _Mem_Free (const void *ptr, const char *fileName, const int fileLine)
 			mem->pool ? mem->pool->name : "UNKNOWN", mem->allocFile, mem->allocLine, fileName, fileLine);
 	}
 
+	if (m_profiling)
+		Mem_ProfileFree (mem->allocFile, mem->allocLine, mem->size);
+
 	// Decrement counters
 	mem->pool->blockCount--;
 	mem->pool->byteCount -= mem->size;
 	size = mem->size;
 
 	// De-link it
-	prev = &mem->pool->blocks;
-	for ( ; ; ) {
-		search = *prev;
-		if (!search)
-			break;
-
-		if (search == mem) {
-			*prev = search->next;
-			break;
-		}
-		prev = &search->next;
-	}
-
-	// Free it
-	free (mem);
+	if (mem->prev)
+		mem->prev->next = mem->next;
+	else
+		mem->pool->blocks = mem->next;
+	if (mem->next)
+		mem->next->prev = mem->prev;
+	Mem_UnlinkTag (mem);
+
+	// Free it, arena blocks live on until their slab is released
+	if (!mem->pool->arenaSlabSize)
+		free (mem);
 	return size;
 }
 
@@ -262,19 +792,26 @@ Free memory blocks assigned to a specified tag within a pool
 */
 size_t _Mem_FreeTag (struct memPool_s *pool, const int tagNum, const char *fileName, const int fileLine)
 {
+	memTag_t	*tag;
 	memBlock_t	*mem, *next;
 	size_t		size;
 
 	if (!pool)
 		return 0;
 
+	tag = Mem_FindTag (pool, tagNum, qFalse);
+	if (!tag)
+		return 0;
+
 	size = 0;
-	for (mem=pool->blocks; mem ; mem=next) {
-		next = mem->next;
-		if (mem->tagNum == tagNum)
-			size += _Mem_Free (mem->memPointer, fileName, fileLine);
+	for (mem=tag->blocks ; mem ; mem=next) {
+		next = mem->tagNext;
+		size += _Mem_Free (mem->memPointer, fileName, fileLine);
 	}
+	size += Mem_ReleaseSlabs (tag);
 
+	assert (tag->blockCount == 0);
+	assert (tag->byteCount == 0);
 	return size;
 }
 
@@ -289,7 +826,9 @@ Free all items within a pool
 size_t _Mem_FreePool (struct memPool_s *pool, const char *fileName, const int fileLine)
 {
 	memBlock_t	*mem, *next;
+	memTag_t	*tag;
 	size_t		size;
+	uint32		i;
 
 	if (!pool)
 		return 0;
@@ -300,6 +839,14 @@ size_t _Mem_FreePool (struct memPool_s *pool, const char *fileName, const int fi
 		size += _Mem_Free (mem->memPointer, fileName, fileLine);
 	}
 
+	// Drop the arena slabs in one go
+	if (pool->arenaSlabSize) {
+		for (i=0 ; i<MEM_TAG_HASH_SIZE ; i++) {
+			for (tag=pool->tagHash[i] ; tag ; tag=tag->hashNext)
+				size += Mem_ReleaseSlabs (tag);
+		}
+	}
+
 	assert (pool->blockCount == 0);
 	assert (pool->byteCount == 0);
 	return size;
@@ -316,6 +863,7 @@ Optionally returns 0 filled memory allocated in a pool with a tag
 void *_Mem_Alloc (size_t size, struct memPool_s *pool, const int tagNum, const char *fileName, const int fileLine)
 {
 	memBlock_t	*mem;
+	memTag_t	*tag;
 
 	// Check pool
 	if (!pool)
@@ -329,9 +877,43 @@ void *_Mem_Alloc (size_t size, struct memPool_s *pool, const int tagNum, const c
 	if (size > 0x40000000)
 		Com_Error (ERR_FATAL, "Mem_Alloc: Attempted allocation of '%i' bytes!\n" "alloc: %s:#%i\n", size, fileName, fileLine);
 
+	tag = Mem_FindTag (pool, tagNum, qTrue);
+
+#ifndef MEM_ARENA_HEADERS
+	// Arena blocks only get a compact header
+	if (pool->arenaSlabSize) {
+		memArenaHead_t	*head;
+		byte			*out;
+
+		size = (size + MEM_ARENA_HEADSIZE + 15) & ~15;
+		out = Mem_ArenaAlloc (pool, tag, size, fileName, fileLine) + MEM_ARENA_HEADSIZE;
+
+		head = (memArenaHead_t *)(out - sizeof (memArenaHead_t));
+		head->tag = tag;
+		head->size = (uint32)size;
+		head->sentinel = MEM_ARENA_SENTINEL;
+
+		pool->blockCount++;
+		pool->byteCount += size;
+		pool->compactBlocks++;
+		pool->compactBytes += size;
+		tag->blockCount++;
+		tag->byteCount += size;
+		tag->compactBlocks++;
+		tag->compactBytes += size;
+
+		if (m_profiling)
+			Mem_ProfileAlloc (fileName, fileLine, size, qFalse);
+		return out;
+	}
+#endif
+
 	// Add header and round to cacheline
 	size = (size + sizeof (memBlock_t) + sizeof (memBlockFoot_t) + 31) & ~31;
-	mem = calloc (1, size);
+	if (pool->arenaSlabSize)
+		mem = (memBlock_t *)Mem_ArenaAlloc (pool, tag, size, fileName, fileLine);
+	else
+		mem = calloc (1, size);
 
 	if (!mem)
 		Com_Error (ERR_FATAL, "Mem_Alloc: failed on allocation of %i bytes\n" "alloc: %s:#%i", size, fileName, fileLine);
@@ -355,13 +937,233 @@ void *_Mem_Alloc (size_t size, struct memPool_s *pool, const int tagNum, const c
 	// Fill in the footer
 	mem->footer->sentinel = MEM_FOOT_SENTINEL;
 
-	// Link it in to the appropriate pool
+	if (m_profiling)
+		Mem_ProfileAlloc (fileName, fileLine, size, qTrue);
+
+	// Link it in to the appropriate pool and tag
+	mem->prev = NULL;
 	mem->next = pool->blocks;
+	if (pool->blocks)
+		pool->blocks->prev = mem;
 	pool->blocks = mem;
+	Mem_LinkTag (tag, mem);
 
 	return mem->memPointer;
 }
 
+/*
+==============================================================================
+
+	OBJECT CLASS ALLOCATION
+
+	Small fixed-size objects that come and go constantly are handed out of
+	per-size-class slabs instead of going through a pool and calloc. There are
+	no per-object headers, the slab is found by aligning the pointer down.
+==============================================================================
+*/
+
+/*
+========================
+Mem_ObjSlabAlloc
+========================
+*/
+static memObjSlab_t *Mem_ObjSlabAlloc (const size_t size, const char *fileName, const int fileLine)
+{
+	void	*slab;
+
+#ifdef _WIN32
+	slab = _aligned_malloc (size, MEM_OBJ_SLABSIZE);
+#else
+	if (posix_memalign (&slab, MEM_OBJ_SLABSIZE, size))
+		slab = NULL;
+#endif
+	if (!slab)
+		Com_Error (ERR_FATAL, "Mem_ObjAlloc: failed on slab allocation of %i bytes\n" "alloc: %s:#%i", size, fileName, fileLine);
+
+	memset (slab, 0, MEM_OBJ_HEADSIZE);
+	return (memObjSlab_t *)slab;
+}
+
+
+/*
+========================
+Mem_ObjSlabFree
+========================
+*/
+static void Mem_ObjSlabFree (memObjSlab_t *slab)
+{
+	slab->sentinel = 0;
+#ifdef _WIN32
+	_aligned_free (slab);
+#else
+	free (slab);
+#endif
+}
+
+
+/*
+========================
+Mem_ObjUnlinkSlab
+========================
+*/
+static void Mem_ObjUnlinkSlab (memObjClass_t *objClass, memObjSlab_t *slab)
+{
+	if (slab->prev)
+		slab->prev->next = slab->next;
+	else
+		objClass->partial = slab->next;
+	if (slab->next)
+		slab->next->prev = slab->prev;
+
+	slab->next = slab->prev = NULL;
+	slab->onList = qFalse;
+}
+
+
+/*
+========================
+_Mem_ObjAlloc
+
+Returns zero filled, cache line aligned memory from the smallest class that fits.
+Anything above MEM_OBJ_MAXSIZE gets an oversize slab of its own.
+========================
+*/
+void *_Mem_ObjAlloc (size_t size, const char *fileName, const int fileLine)
+{
+	memObjClass_t	*objClass;
+	memObjSlab_t	*slab;
+	byte			*obj;
+
+	// Check size
+	if (size <= 0) {
+		Com_DevPrintf (PRNT_WARNING, "Mem_ObjAlloc: Attempted allocation of '%i' memory ignored\n" "alloc: %s:#%i\n", size, fileName, fileLine);
+		return NULL;
+	}
+	if (size > 0x40000000)
+		Com_Error (ERR_FATAL, "Mem_ObjAlloc: Attempted allocation of '%i' bytes!\n" "alloc: %s:#%i\n", size, fileName, fileLine);
+
+	if (size > MEM_OBJ_MAXSIZE) {
+		size = (size + MEM_OBJ_HEADSIZE + MEM_OBJ_ALIGN-1) & ~(MEM_OBJ_ALIGN-1);
+		slab = Mem_ObjSlabAlloc (size, fileName, fileLine);
+		slab->sentinel = MEM_OBJ_SENTINEL;
+		slab->size = size;
+
+		m_objOversizeCount++;
+		m_objOversizeBytes += size;
+		if (m_profiling)
+			Mem_ProfileAlloc (fileName, fileLine, size, qFalse);
+
+		obj = (byte *)slab + MEM_OBJ_HEADSIZE;
+		memset (obj, 0, size - MEM_OBJ_HEADSIZE);
+		return obj;
+	}
+
+	objClass = &m_objClasses[m_objClassForSize[(size + MEM_OBJ_ALIGN-1) / MEM_OBJ_ALIGN]];
+
+	// Find a slab with room, or start a new one
+	slab = objClass->partial;
+	if (!slab) {
+		slab = Mem_ObjSlabAlloc (MEM_OBJ_SLABSIZE, fileName, fileLine);
+		slab->sentinel = MEM_OBJ_SENTINEL;
+		slab->objClass = objClass;
+		slab->size = MEM_OBJ_SLABSIZE;
+		slab->freshObjs = (byte *)slab + MEM_OBJ_HEADSIZE;
+
+		slab->next = NULL;
+		slab->prev = NULL;
+		slab->onList = qTrue;
+		objClass->partial = slab;
+		objClass->numSlabs++;
+	}
+
+	// Reuse released objects first, then carve fresh ones
+	if (slab->freeObjs) {
+		obj = slab->freeObjs;
+		slab->freeObjs = *(void **)obj;
+	}
+	else {
+		obj = slab->freshObjs;
+		slab->freshObjs += objClass->objSize;
+	}
+
+	slab->numUsed++;
+	if (slab->numUsed == objClass->objsPerSlab)
+		Mem_ObjUnlinkSlab (objClass, slab);
+
+	objClass->numUsed++;
+	objClass->numAllocs++;
+	if (m_profiling)
+		Mem_ProfileAlloc (fileName, fileLine, objClass->objSize, qFalse);
+	if (objClass->numUsed > objClass->peakUsed)
+		objClass->peakUsed = objClass->numUsed;
+
+	memset (obj, 0, objClass->objSize);
+	return obj;
+}
+
+
+/*
+========================
+_Mem_ObjFree
+========================
+*/
+size_t _Mem_ObjFree (const void *ptr, const char *fileName, const int fileLine)
+{
+	memObjClass_t	*objClass;
+	memObjSlab_t	*slab;
+	size_t			size;
+
+	assert (ptr);
+	if (!ptr)
+		return 0;
+
+	slab = (memObjSlab_t *)((size_t)ptr & ~(size_t)(MEM_OBJ_SLABSIZE-1));
+	if (slab->sentinel != MEM_OBJ_SENTINEL) {
+		Com_Error (ERR_FATAL,
+			"Mem_ObjFree: pointer not allocated with Mem_ObjAlloc\n"
+			"free: %s:#%i",
+			fileName, fileLine);
+	}
+
+	// Oversize slabs hold a single object
+	objClass = slab->objClass;
+	if (!objClass) {
+		size = slab->size;
+		m_objOversizeCount--;
+		m_objOversizeBytes -= size;
+		Mem_ObjSlabFree (slab);
+		return size;
+	}
+
+	*(void **)ptr = slab->freeObjs;
+	slab->freeObjs = (void *)ptr;
+	slab->numUsed--;
+
+	objClass->numUsed--;
+	objClass->numFrees++;
+
+	// Release empty slabs, keeping one around so a single object can't thrash
+	if (!slab->numUsed && objClass->numSlabs > 1) {
+		if (slab->onList)
+			Mem_ObjUnlinkSlab (objClass, slab);
+		objClass->numSlabs--;
+		Mem_ObjSlabFree (slab);
+		return objClass->objSize;
+	}
+
+	// Was full, has room again
+	if (!slab->onList) {
+		slab->prev = NULL;
+		slab->next = objClass->partial;
+		if (objClass->partial)
+			objClass->partial->prev = slab;
+		objClass->partial = slab;
+		slab->onList = qTrue;
+	}
+
+	return objClass->objSize;
+}
+
 /*
 ==============================================================================
 
@@ -409,19 +1211,16 @@ _Mem_TagSize
 */
 size_t _Mem_TagSize (struct memPool_s *pool, const int tagNum)
 {
-	memBlock_t	*mem;
-	size_t		size;
+	memTag_t	*tag;
 
 	if (!pool)
 		return 0;
 
-	size = 0;
-	for (mem=pool->blocks ; mem ; mem=mem->next) {
-		if (mem->tagNum == tagNum)
-			size += mem->size;
-	}
+	tag = Mem_FindTag (pool, tagNum, qFalse);
+	if (!tag)
+		return 0;
 
-	return size;
+	return tag->byteCount;
 }
 
 
@@ -432,18 +1231,67 @@ _Mem_ChangeTag
 */
 size_t _Mem_ChangeTag (struct memPool_s *pool, const int tagFrom, const int tagTo)
 {
-	memBlock_t	*mem;
+	memTag_t	*from, *to;
+	memBlock_t	*mem, *next;
 	uint32		numChanged;
 
 	if (!pool)
 		return 0;
 
+	from = Mem_FindTag (pool, tagFrom, qFalse);
+	if (!from || !from->blockCount)
+		return 0;
+
+	// Nothing moves, but the count is still every block carrying the tag
+	if (tagFrom == tagTo)
+		return from->blockCount;
+
+	to = Mem_FindTag (pool, tagTo, qTrue);
+
+	// Move each block over to the new tag list
 	numChanged = 0;
-	for (mem=pool->blocks ; mem ; mem=mem->next) {
-		if (mem->tagNum == tagFrom) {
-			mem->tagNum = tagTo;
-			numChanged++;
+	for (mem=from->blocks ; mem ; mem=next) {
+		next = mem->tagNext;
+		Mem_UnlinkTag (mem);
+		Mem_LinkTag (to, mem);
+		numChanged++;
+	}
+
+	// Arena slabs and their compact blocks follow, the new tag keeps bumping its own slab
+	if (from->slabs) {
+		memSlab_t	*slab;
+#ifndef MEM_ARENA_HEADERS
+		memArenaHead_t	*head;
+		size_t			offset;
+
+		// Compact headers name their tag, so re-point every one in the moved slabs
+		for (slab=from->slabs ; slab ; slab=slab->next) {
+			for (offset=0 ; offset<slab->used ; offset+=head->size) {
+				head = (memArenaHead_t *)(slab->base + offset + MEM_ARENA_HEADSIZE - sizeof (memArenaHead_t));
+				head->tag = to;
+			}
+		}
+#endif
+
+		for (slab=from->slabs ; slab->next ; slab=slab->next) ;
+		if (to->slabs) {
+			slab->next = to->slabs->next;
+			to->slabs->next = from->slabs;
 		}
+		else {
+			to->slabs = from->slabs;
+		}
+		from->slabs = NULL;
+
+		numChanged += from->compactBlocks;
+		to->blockCount += from->compactBlocks;
+		to->byteCount += from->compactBytes;
+		to->compactBlocks += from->compactBlocks;
+		to->compactBytes += from->compactBytes;
+		from->blockCount -= from->compactBlocks;
+		from->byteCount -= from->compactBytes;
+		from->compactBlocks = 0;
+		from->compactBytes = 0;
 	}
 
 	return numChanged;
@@ -499,6 +1347,8 @@ void _Mem_CheckPoolIntegrity (struct memPool_s *pool, const char *fileName, cons
 	}
 
 	// Check block/byte counts
+	blocks += pool->compactBlocks;
+	size += pool->compactBytes;
 	if (pool->blockCount != blocks)
 		Com_Error (ERR_FATAL, "Mem_CheckPoolIntegrity: bad block count\n" "check: %s:#%i", fileName, fileLine);
 	if (pool->byteCount != size)
@@ -669,6 +1519,8 @@ static void Mem_Stats_f (void)
 			Com_Printf (0, S_COLOR_GREY);
 
 		Com_Printf (0, "#%2i %6i %9iB (%6.3fMB) %s\n", poolNum, pool->blockCount, pool->byteCount, pool->byteCount/1048576.0f, pool->name);
+		if (pool->arenaSlabSize)
+			Com_Printf (0, "    arena: %i slabs, %iB held\n", pool->slabCount, pool->slabBytes);
 
 		totalBlocks += pool->blockCount;
 		totalBytes += pool->byteCount;
@@ -676,6 +1528,234 @@ static void Mem_Stats_f (void)
 
 	Com_Printf (0, "----------------------------------------\n");
 	Com_Printf (0, "Total: %i pools, %i blocks, %i bytes (%6.3fMB)\n", i, totalBlocks, totalBytes, totalBytes/1048576.0f);
+
+	Com_Printf (0, "\nObject classes:\n");
+	Com_Printf (0, "size  slabs in use  peak    allocs     frees\n");
+	Com_Printf (0, "----- ----- ------- ------- ---------- ----------\n");
+
+	totalBytes = 0;
+	for (i=0 ; i<MEM_OBJ_MAXCLASSES ; i++) {
+		memObjClass_t	*objClass = &m_objClasses[i];
+
+		if (!objClass->numAllocs)
+			continue;
+
+		if (i & 1)
+			Com_Printf (0, S_COLOR_GREY);
+		Com_Printf (0, "%5i %5i %7i %7i %10i %10i\n", objClass->objSize, objClass->numSlabs, objClass->numUsed, objClass->peakUsed, objClass->numAllocs, objClass->numFrees);
+
+		totalBytes += objClass->numSlabs * MEM_OBJ_SLABSIZE;
+	}
+
+	Com_Printf (0, "----------------------------------------\n");
+	Com_Printf (0, "Total: %i bytes in slabs (%6.3fMB), %i oversize objects %i bytes\n", totalBytes, totalBytes/1048576.0f, m_objOversizeCount, m_objOversizeBytes);
+}
+
+/*
+========================
+Mem_SortSitesByLive
+========================
+*/
+static int Mem_SortSitesByLive (const void *_a, const void *_b)
+{
+	const memSite_t	*a = *(const memSite_t **)_a;
+	const memSite_t	*b = *(const memSite_t **)_b;
+
+	if (a->liveBytes == b->liveBytes)
+		return 0;
+	return (a->liveBytes > b->liveBytes) ? -1 : 1;
+}
+
+
+/*
+========================
+Mem_SortSitesByRate
+========================
+*/
+static int Mem_SortSitesByRate (const void *_a, const void *_b)
+{
+	const memSite_t	*a = *(const memSite_t **)_a;
+	const memSite_t	*b = *(const memSite_t **)_b;
+
+	if (a->totalAllocs == b->totalAllocs)
+		return 0;
+	return (a->totalAllocs > b->totalAllocs) ? -1 : 1;
+}
+
+
+/*
+========================
+Mem_SortSitesByGrowth
+========================
+*/
+static int Mem_SortSitesByGrowth (const void *_a, const void *_b)
+{
+	const memSite_t	*a = *(const memSite_t **)_a;
+	const memSite_t	*b = *(const memSite_t **)_b;
+	int64			growthA = a->liveBytes - a->snapBytes;
+	int64			growthB = b->liveBytes - b->snapBytes;
+
+	if (growthA == growthB)
+		return 0;
+	return (growthA > growthB) ? -1 : 1;
+}
+
+
+/*
+========================
+Mem_SortedSites
+
+Returns a malloc'd list of sites, the caller frees it
+========================
+*/
+static memSite_t **Mem_SortedSites (int (*compare) (const void *, const void *), uint32 *numSites)
+{
+	memSite_t	**list;
+	uint32		i;
+
+	*numSites = 0;
+	if (!m_profiling) {
+		Com_Printf (0, "Memory profiling is off, set mem_profile 1 first\n");
+		return NULL;
+	}
+
+	list = malloc (sizeof (memSite_t *) * (m_numSites + 1));
+	if (!list)
+		return NULL;
+
+	for (i=0 ; i<m_numSites ; i++)
+		list[i] = &m_sites[i];
+	if (m_overflowSite.totalAllocs)
+		list[i++] = &m_overflowSite;
+
+	qsort (list, i, sizeof (memSite_t *), compare);
+	*numSites = i;
+	return list;
+}
+
+
+/*
+========================
+Mem_Sites_f
+
+mem_sites [count] [live|rate]
+========================
+*/
+static void Mem_Sites_f (void)
+{
+	memSite_t	**list, *site;
+	uint32		numSites, count, i;
+	qBool		byRate;
+	float		frames;
+
+	count = (Cmd_Argc () > 1) ? atoi (Cmd_Argv (1)) : 20;
+	if (count <= 0)
+		count = 20;
+	byRate = (Cmd_Argc () > 2 && !Q_stricmp (Cmd_Argv (2), "rate"));
+
+	list = Mem_SortedSites (byRate ? Mem_SortSitesByRate : Mem_SortSitesByLive, &numSites);
+	if (!list)
+		return;
+
+	frames = m_profileFrames ? (float)m_profileFrames : 1.0f;
+
+	Com_Printf (0, "Allocation sites by %s, over %i frames:\n", byRate ? "allocation count" : "live bytes", m_profileFrames);
+	Com_Printf (0, "live bytes  blocks  allocs     /frame  last peak  line  file\n");
+	Com_Printf (0, "----------- ------- ---------- ------- ---- ----- ----- -----------------\n");
+
+	for (i=0 ; i<numSites && i<count ; i++) {
+		site = list[i];
+		if (i & 1)
+			Com_Printf (0, S_COLOR_GREY);
+
+		Com_Printf (0, "%10iB %7i %10i %7.2f %4i %5i %5i %s\n",
+			(int)site->liveBytes, (int)site->liveBlocks, (int)site->totalAllocs, site->totalAllocs/frames,
+			(int)site->lastFrameAllocs, (int)site->peakFrameAllocs, site->line, site->file);
+	}
+
+	Com_Printf (0, "----------------------------------------\n");
+	Com_Printf (0, "%i sites, last frame %i allocs %iB, peak frame %i allocs %iB\n",
+		m_numSites, m_lastFrameAllocs, m_lastFrameBytes, m_peakFrameAllocs, m_peakFrameBytes);
+
+	free (list);
+}
+
+
+/*
+========================
+Mem_Snapshot_f
+========================
+*/
+static void Mem_Snapshot_f (void)
+{
+	memSite_t	*site;
+	uint32		i;
+
+	if (!m_profiling) {
+		Com_Printf (0, "Memory profiling is off, set mem_profile 1 first\n");
+		return;
+	}
+
+	for (i=0, site=&m_sites[0] ; i<m_numSites ; site++, i++) {
+		site->snapBytes = site->liveBytes;
+		site->snapBlocks = site->liveBlocks;
+	}
+	m_overflowSite.snapBytes = m_overflowSite.liveBytes;
+	m_overflowSite.snapBlocks = m_overflowSite.liveBlocks;
+	m_haveSnapshot = qTrue;
+
+	Com_Printf (0, "Memory snapshot taken of %i sites\n", m_numSites);
+}
+
+
+/*
+========================
+Mem_Diff_f
+
+mem_diff [count], sites whose live memory changed since mem_snapshot
+========================
+*/
+static void Mem_Diff_f (void)
+{
+	memSite_t	**list, *site;
+	uint32		numSites, count, i, numPrinted;
+	int64		growth, totalGrowth;
+
+	if (m_profiling && !m_haveSnapshot) {
+		Com_Printf (0, "No snapshot, use mem_snapshot first\n");
+		return;
+	}
+
+	count = (Cmd_Argc () > 1) ? atoi (Cmd_Argv (1)) : 20;
+	if (count <= 0)
+		count = 20;
+
+	list = Mem_SortedSites (Mem_SortSitesByGrowth, &numSites);
+	if (!list)
+		return;
+
+	Com_Printf (0, "Live memory change since snapshot:\n");
+	Com_Printf (0, "change      blocks  now         line  file\n");
+	Com_Printf (0, "----------- ------- ----------- ----- -----------------\n");
+
+	totalGrowth = 0;
+	for (i=0, numPrinted=0 ; i<numSites ; i++) {
+		site = list[i];
+		growth = site->liveBytes - site->snapBytes;
+		totalGrowth += growth;
+		if (!growth || numPrinted >= count)
+			continue;
+
+		if (numPrinted++ & 1)
+			Com_Printf (0, S_COLOR_GREY);
+		Com_Printf (0, "%+10iB %+7i %10iB %5i %s\n",
+			(int)growth, (int)(site->liveBlocks - site->snapBlocks), (int)site->liveBytes, site->line, site->file);
+	}
+
+	Com_Printf (0, "----------------------------------------\n");
+	Com_Printf (0, "Total change: %+iB (%+6.3fMB)\n", (int)totalGrowth, totalGrowth/1048576.0f);
+
+	free (list);
 }
 
 /*
@@ -695,6 +1775,12 @@ void Mem_Register (void)
 {
 	Cmd_AddCommand ("memcheck",		Mem_Check_f,		"Checks global memory integrity");
 	Cmd_AddCommand ("memstats",		Mem_Stats_f,		"Prints out current internal memory statistics");
+	Cmd_AddCommand ("mem_sites",	Mem_Sites_f,		"Prints the top allocation sites, sorted by live bytes or 'rate'");
+	Cmd_AddCommand ("mem_snapshot",	Mem_Snapshot_f,		"Records live memory per allocation site for mem_diff");
+	Cmd_AddCommand ("mem_diff",		Mem_Diff_f,			"Prints allocation sites whose live memory changed since mem_snapshot");
+
+	mem_profile = Cvar_Register ("mem_profile",	"0",	0);
+	mem_profile->modified = qTrue;
 }
 
 
@@ -705,4 +1791,19 @@ Mem_Init
 */
 void Mem_Init (void)
 {
+	memObjClass_t	*objClass;
+	uint32			i, j;
+
+	// Mem_Free relies on this to tell compact arena headers apart
+	assert (sizeof (memBlock_t) == offsetof (memBlock_t, botSentinel) + sizeof (uint32));
+
+	// Setup the object classes and the size to class lookup
+	for (i=0, j=0, objClass=&m_objClasses[0] ; i<MEM_OBJ_MAXCLASSES ; i++, objClass++) {
+		memset (objClass, 0, sizeof (memObjClass_t));
+		objClass->objSize = m_objClassSizes[i];
+		objClass->objsPerSlab = (MEM_OBJ_SLABSIZE - MEM_OBJ_HEADSIZE) / objClass->objSize;
+
+		for ( ; j*MEM_OBJ_ALIGN<=objClass->objSize ; j++)
+			m_objClassForSize[j] = i;
+	}
 }
@@ -22,7 +22,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 //
 
 // constants
-#define Mem_CreatePool(name)							_Mem_CreatePool((name),__FILE__,__LINE__)
+#define Mem_CreatePool(name)							_Mem_CreatePool((name),0,__FILE__,__LINE__)
+#define Mem_CreateArenaPool(name,slabSize)				_Mem_CreatePool((name),(slabSize),__FILE__,__LINE__)
 #define Mem_DeletePool(pool)							_Mem_DeletePool((pool),__FILE__,__LINE__)
 
 #define Mem_Free(ptr)									_Mem_Free((ptr),__FILE__,__LINE__)
@@ -37,6 +38,9 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #define Mem_TagSize(pool,tagNum)						_Mem_TagSize((pool),(tagNum))
 #define Mem_ChangeTag(pool,tagFrom,tagTo)				_Mem_ChangeTag((pool),(tagFrom),(tagTo))
 
+#define Mem_ObjAlloc(size)								_Mem_ObjAlloc((size),__FILE__,__LINE__)
+#define Mem_ObjFree(ptr)								_Mem_ObjFree((ptr),__FILE__,__LINE__)
+
 #define Mem_CheckPoolIntegrity(pool)					_Mem_CheckPoolIntegrity((pool),__FILE__,__LINE__)
 #define Mem_CheckGlobalIntegrity()						_Mem_CheckGlobalIntegrity(__FILE__,__LINE__)
 
@@ -44,7 +48,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #define Mem_TouchGlobal()								_Mem_TouchGlobal(__FILE__,__LINE__)
 
 // functions
-struct memPool_s *_Mem_CreatePool (const char *name, const char *fileName, const int fileLine);
+struct memPool_s *_Mem_CreatePool (const char *name, const size_t arenaSlabSize, const char *fileName, const int fileLine);
 size_t		_Mem_DeletePool (struct memPool_s *pool, const char *fileName, const int fileLine);
 
 size_t		_Mem_Free (const void *ptr, const char *fileName, const int fileLine);
@@ -52,6 +56,9 @@ size_t		_Mem_FreeTag (struct memPool_s *pool, const int tagNum, const char *file
 size_t		_Mem_FreePool (struct memPool_s *pool, const char *fileName, const int fileLine);
 void		*_Mem_Alloc (size_t size, struct memPool_s *pool, const int tagNum, const char *fileName, const int fileLine);
 
+void		*_Mem_ObjAlloc (size_t size, const char *fileName, const int fileLine);
+size_t		_Mem_ObjFree (const void *ptr, const char *fileName, const int fileLine);
+
 char		*_Mem_PoolStrDup (const char *in, struct memPool_s *pool, const int tagNum, const char *fileName, const int fileLine);
 size_t		_Mem_PoolSize (struct memPool_s *pool);
 size_t		_Mem_TagSize (struct memPool_s *pool, const int tagNum);
@@ -63,5 +70,6 @@ void		_Mem_CheckGlobalIntegrity (const char *fileName, const int fileLine);
 void		_Mem_TouchPool (struct memPool_s *pool, const char *fileName, const int fileLine);
 void		_Mem_TouchGlobal (const char *fileName, const int fileLine);
 
+void		Mem_Frame (void);
 void		Mem_Register (void);
 void		Mem_Init (void);
@@ -242,6 +242,10 @@ typedef struct netStats_s {
 
 	uint32			packetsIn;
 	uint32			packetsOut;
+
+	uint32			recvCalls;		// Socket syscalls, a batched call counts once
+	uint32			sendCalls;
+	uint32			batchFrames;	// Number of NET_FlushPackets calls
 } netStats_t;
 
 extern netStats_t	netStats;
@@ -319,6 +323,8 @@ netConfig_t NET_Config (netConfig_t openFlags);
 
 qBool		NET_GetPacket (netSrc_t sock, netAdr_t *fromAddr, netMsg_t *message);
 int			NET_SendPacket (netSrc_t sock, size_t length, void *data, netAdr_t *to);
+void		NET_BeginBatch (netSrc_t sock);
+void		NET_FlushPackets (netSrc_t sock);
 
 char		*NET_AdrToString (netAdr_t *a);
 qBool		NET_StringToAdr (char *s, netAdr_t *a);
@@ -233,7 +233,7 @@ void Cmd_Give_f (edict_t *ent)
 	{
 		it = FindItem("Power Shield");
 		it_ent = G_Spawn();
-		it_ent->classname = it->classname;
+		G_SetClassname (it_ent, it->classname);
 		SpawnItem (it_ent, it);
 		Touch_Item (it_ent, ent, NULL, NULL);
 		if (it_ent->inUse)
@@ -287,7 +287,7 @@ void Cmd_Give_f (edict_t *ent)
 	else
 	{
 		it_ent = G_Spawn();
-		it_ent->classname = it->classname;
+		G_SetClassname (it_ent, it->classname);
 		SpawnItem (it_ent, it);
 		Touch_Item (it_ent, ent, NULL, NULL);
 		if (it_ent->inUse)
@@ -927,8 +927,7 @@ void ClientCommand (edict_t *ent)
             return;
         }
         e = G_Spawn();
-        e->classname = gi.TagMalloc(strlen(gi.argv(1)) + 1, TAG_LEVEL);
-        strcpy(e->classname, gi.argv(1));
+        G_SetClassname(e, G_CopyString(gi.argv(1)));
         Angles_Vectors(ent->client->v_angle, forward, NULL, NULL);
         //Vec3Angle(ent->client->v_angle, forward, NULL, NULL);
         Vec3MA(ent->s.origin, 128, forward, e->s.origin);
@@ -616,6 +616,14 @@ void Touch_Item (edict_t *ent, edict_t *other, cBspPlane_t *plane, cBspSurface_t
 qBool	KillBox (edict_t *ent);
 void	G_ProjectSource (vec3_t point, vec3_t distance, vec3_t forward, vec3_t right, vec3_t result);
 edict_t *G_Find (edict_t *from, ptrdiff_t fieldofs, char *match);
+void	G_SetClassname (edict_t *ent, char *classname);
+void	G_SetTargetname (edict_t *ent, char *targetname);
+void	G_IndexEdict (edict_t *ent);
+void	G_SyncEntityIndex (void);
+void	G_ClearEntityIndex (void);
+void	G_InitEntityIndex (void);
+void	G_RadiusDirty (edict_t *ent, qBool dirty);
+void	G_HookLinks (void);
 edict_t *findradius (edict_t *from, vec3_t org, float rad);
 edict_t *G_PickTarget (char *targetname);
 void	G_UseTargets (edict_t *ent, edict_t *activator);
@@ -746,6 +754,22 @@ void ClientBeginServerFrame (edict_t *ent);
 void player_pain (edict_t *self, edict_t *other, float kick, int damage);
 void player_die (edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
 
+//
+// g_profile.c
+//
+typedef struct profileSample_s {
+	uint32		usec;
+	int			traces;
+} profileSample_t;
+
+extern	cVar_t	*g_profile;
+
+void	G_ProfileBegin (profileSample_t *sample);
+void	G_ProfileEntity (profileSample_t *sample, char *classname);
+void	G_ProfileThink (profileSample_t *sample, char *classname, void (*think) (edict_t *self));
+void	G_ProfileFrame (profileSample_t *sample);
+void	G_Profile_f (void);
+
 //
 // g_svcmds.c
 //
@@ -110,7 +110,17 @@ and global variables
 */
 gameExport_t *GetGameAPI (gameImport_t *import)
 {
-	gi = *import;
+	cVar_t	*ext;
+
+	// Engines without the extensions hand over a shorter struct
+	ext = import->cvar (GAME_EXTCVAR, "0", CVAR_READONLY);
+	if (ext->floatVal >= GAME_EXTVERSION)
+		gi = *import;
+	else if (ext->floatVal >= 1)
+		memcpy (&gi, import, offsetof (gameImport_t, ObjMalloc));
+	else
+		memcpy (&gi, import, offsetof (gameImport_t, TraceBatch));
+	G_HookLinks ();
 
 	Swap_Init ();
 
@@ -218,7 +228,7 @@ edict_t *CreateTargetChangeLevel(char *map)
 	edict_t *ent;
 
 	ent = G_Spawn ();
-	ent->classname = "target_changelevel";
+	G_SetClassname (ent, "target_changelevel");
 	Q_snprintfz(level.nextmap, sizeof(level.nextmap), "%s", map);
 	ent->map = level.nextmap;
 	return ent;
@@ -395,12 +405,22 @@ Advances the world by 0.1 seconds
 */
 void G_RunFrame (void)
 {
-	int		i;
-	edict_t	*ent;
+	int				i;
+	edict_t			*ent;
+	qBool			profile;
+	profileSample_t	frameSample, sample;
+	char			*classname;
 
 	level.framenum++;
 	level.time = level.framenum*FRAMETIME;
 
+	// pick up any name changes that skipped G_SetClassname/G_SetTargetname
+	G_SyncEntityIndex ();
+
+	profile = (g_profile->intVal && gi.Microseconds) ? qTrue : qFalse;
+	if (profile)
+		G_ProfileBegin (&frameSample);
+
 	// choose a client for monsters to target this frame
 	AI_SetSightClient ();
 
@@ -436,13 +456,19 @@ void G_RunFrame (void)
 			}
 		}
 
-		if (i > 0 && i <= maxclients->floatVal)
+		if (profile)
 		{
-			ClientBeginServerFrame (ent);
-			continue;
+			classname = ent->classname;
+			G_ProfileBegin (&sample);
 		}
 
-		G_RunEntity (ent);
+		if (i > 0 && i <= maxclients->floatVal)
+			ClientBeginServerFrame (ent);
+		else
+			G_RunEntity (ent);
+
+		if (profile)
+			G_ProfileEntity (&sample, classname);
 	}
 
 	// see if it is time to end a deathmatch
@@ -453,5 +479,8 @@ void G_RunFrame (void)
 
 	// build the playerstate_t structures for all players
 	ClientEndServerFrames ();
+
+	if (profile)
+		G_ProfileFrame (&frameSample);
 }
 
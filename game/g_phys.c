@@ -106,7 +106,18 @@ qBool SV_RunThink (edict_t *ent)
 	if (!ent->think)
 		Com_Error (ERR_FATAL, "NULL ent->think");
 
-	ent->think (ent);
+	if (g_profile->intVal && gi.Microseconds)
+	{
+		profileSample_t	sample;
+		void			(*think) (edict_t *self) = ent->think;
+		char			*classname = ent->classname;
+
+		G_ProfileBegin (&sample);
+		think (ent);
+		G_ProfileThink (&sample, classname, think);
+	}
+	else
+		ent->think (ent);
 
 	return qFalse;
 }
@@ -0,0 +1,332 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// g_profile.c -- per entity frame profiling
+
+#include "g_local.h"
+
+/*
+==============================================================================
+
+ENTITY PROFILING
+
+With g_profile set, G_RunFrame times every entity it runs and SV_RunThink
+times every think call. Wall time and collision traces are summed per
+classname and per think function across frames until "sv profile reset".
+
+sv profile [count]	prints the worst classnames, think functions and
+					the frame time and trace histograms
+sv profile reset	clears everything
+
+Entity times include any thinks, touches and damage they set off, so the
+think table is the one to read for where the time really goes.
+==============================================================================
+*/
+
+#define PROFILE_MAX_ENTRIES	512
+#define PROFILE_HASH_SIZE	256
+#define PROFILE_HIST_SIZE	8
+
+typedef struct profileEntry_s {
+	char					name[64];		// classname, or the first one seen running the think
+	void					(*think) (edict_t *self);
+
+	int						calls;
+	double					totalUsec;
+	uint32					maxUsec;
+	int						traces;
+
+	struct profileEntry_s	*hashNext;
+} profileEntry_t;
+
+typedef struct profileTable_s {
+	int						numEntries;
+	profileEntry_t			entries[PROFILE_MAX_ENTRIES];
+	profileEntry_t			*hashTable[PROFILE_HASH_SIZE];
+} profileTable_t;
+
+static profileTable_t	g_classProfile;
+static profileTable_t	g_thinkProfile;
+
+static const uint32	g_frameHistUsec[PROFILE_HIST_SIZE-1] = { 1000, 2000, 5000, 10000, 20000, 50000, 100000 };
+static const int	g_traceHistCount[PROFILE_HIST_SIZE-1] = { 50, 100, 250, 500, 1000, 2500, 5000 };
+
+static int			g_frameHist[PROFILE_HIST_SIZE];
+static int			g_traceHist[PROFILE_HIST_SIZE];
+static int			g_profileFrames;
+static uint32		g_profileWorstFrame;
+
+cVar_t	*g_profile;
+
+void InitGame (void);
+
+/*
+=================
+G_ProfileEntry
+=================
+*/
+static profileEntry_t *G_ProfileEntry (profileTable_t *table, char *name, void (*think) (edict_t *self))
+{
+	profileEntry_t	*entry;
+	uint32			hash;
+	char			*s;
+
+	if (think)
+		hash = (uint32)(((size_t)think >> 4) & (PROFILE_HASH_SIZE-1));
+	else
+	{
+		for (hash=0, s=name ; *s ; s++)
+			hash = hash * 31 + *s;
+		hash &= PROFILE_HASH_SIZE-1;
+	}
+
+	for (entry=table->hashTable[hash] ; entry ; entry=entry->hashNext)
+	{
+		if (think)
+		{
+			if (entry->think == think)
+				return entry;
+		}
+		else if (!strcmp (entry->name, name))
+			return entry;
+	}
+
+	if (table->numEntries == PROFILE_MAX_ENTRIES)
+		return NULL;
+
+	entry = &table->entries[table->numEntries++];
+	Q_strncpyz (entry->name, name, sizeof (entry->name));
+	entry->think = think;
+	entry->hashNext = table->hashTable[hash];
+	table->hashTable[hash] = entry;
+	return entry;
+}
+
+
+/*
+=================
+G_ProfileAdd
+=================
+*/
+static void G_ProfileAdd (profileTable_t *table, profileSample_t *sample, char *name, void (*think) (edict_t *self))
+{
+	profileEntry_t	*entry;
+	uint32			usec;
+
+	usec = gi.Microseconds () - sample->usec;
+	entry = G_ProfileEntry (table, name ? name : "noclass", think);
+	if (!entry)
+		return;
+
+	entry->calls++;
+	entry->totalUsec += usec;
+	if (usec > entry->maxUsec)
+		entry->maxUsec = usec;
+	entry->traces += gi.NumTraces () - sample->traces;
+}
+
+
+/*
+=================
+G_ProfileBegin
+=================
+*/
+void G_ProfileBegin (profileSample_t *sample)
+{
+	sample->usec = gi.Microseconds ();
+	sample->traces = gi.NumTraces ();
+}
+
+
+/*
+=================
+G_ProfileEntity
+
+classname is taken before the entity runs, it may be freed by then
+=================
+*/
+void G_ProfileEntity (profileSample_t *sample, char *classname)
+{
+	G_ProfileAdd (&g_classProfile, sample, classname, NULL);
+}
+
+
+/*
+=================
+G_ProfileThink
+=================
+*/
+void G_ProfileThink (profileSample_t *sample, char *classname, void (*think) (edict_t *self))
+{
+	G_ProfileAdd (&g_thinkProfile, sample, classname, think);
+}
+
+
+/*
+=================
+G_ProfileFrame
+=================
+*/
+void G_ProfileFrame (profileSample_t *sample)
+{
+	uint32	usec;
+	int		traces;
+	int		i;
+
+	usec = gi.Microseconds () - sample->usec;
+	traces = gi.NumTraces () - sample->traces;
+
+	for (i=0 ; i<PROFILE_HIST_SIZE-1 ; i++)
+		if (usec < g_frameHistUsec[i])
+			break;
+	g_frameHist[i]++;
+
+	for (i=0 ; i<PROFILE_HIST_SIZE-1 ; i++)
+		if (traces < g_traceHistCount[i])
+			break;
+	g_traceHist[i]++;
+
+	g_profileFrames++;
+	if (usec > g_profileWorstFrame)
+		g_profileWorstFrame = usec;
+}
+
+// ==========================================================================
+
+/*
+=================
+G_ProfileSort
+=================
+*/
+static int G_ProfileSort (const void *a, const void *b)
+{
+	const profileEntry_t	*e1 = *(const profileEntry_t **)a;
+	const profileEntry_t	*e2 = *(const profileEntry_t **)b;
+
+	if (e1->totalUsec > e2->totalUsec)
+		return -1;
+	return e1->totalUsec < e2->totalUsec;
+}
+
+
+/*
+=================
+G_ProfilePrintTable
+=================
+*/
+static void G_ProfilePrintTable (profileTable_t *table, int count)
+{
+	profileEntry_t	*sorted[PROFILE_MAX_ENTRIES];
+	profileEntry_t	*entry;
+	char			func[16];
+	int				i;
+
+	for (i=0 ; i<table->numEntries ; i++)
+		sorted[i] = &table->entries[i];
+	qsort (sorted, table->numEntries, sizeof (sorted[0]), G_ProfileSort);
+
+	gi.cprintf (NULL, PRINT_HIGH, "  total ms   calls  avg us  max us  traces  name\n");
+	for (i=0 ; i<table->numEntries && i<count ; i++)
+	{
+		entry = sorted[i];
+
+		// think functions show as offsets from InitGame, like savegames store them
+		if (entry->think)
+			Q_snprintfz (func, sizeof (func), " %+i", (int)((byte *)entry->think - (byte *)InitGame));
+		else
+			func[0] = 0;
+
+		gi.cprintf (NULL, PRINT_HIGH, "%9.2f %7i %7i %7i %7i  %s%s\n",
+			entry->totalUsec / 1000.0,
+			entry->calls,
+			(int)(entry->totalUsec / entry->calls),
+			entry->maxUsec,
+			entry->traces,
+			entry->name, func);
+	}
+}
+
+
+/*
+=================
+G_ProfilePrintHist
+=================
+*/
+static void G_ProfilePrintHist (char *title, const int *hist, const char **labels)
+{
+	int		i;
+
+	gi.cprintf (NULL, PRINT_HIGH, "%s\n", title);
+	for (i=0 ; i<PROFILE_HIST_SIZE ; i++)
+		gi.cprintf (NULL, PRINT_HIGH, "  %-10s %7i  %5.1f%%\n", labels[i], hist[i], g_profileFrames ? hist[i] * 100.0 / g_profileFrames : 0.0);
+}
+
+
+/*
+=================
+G_Profile_f
+
+"sv profile [count]" or "sv profile reset"
+=================
+*/
+void G_Profile_f (void)
+{
+	static const char	*frameLabels[PROFILE_HIST_SIZE] = { "< 1ms", "< 2ms", "< 5ms", "< 10ms", "< 20ms", "< 50ms", "< 100ms", ">= 100ms" };
+	static const char	*traceLabels[PROFILE_HIST_SIZE] = { "< 50", "< 100", "< 250", "< 500", "< 1000", "< 2500", "< 5000", ">= 5000" };
+	int					count;
+
+	if (!Q_stricmp (gi.argv(2), "reset"))
+	{
+		memset (&g_classProfile, 0, sizeof (g_classProfile));
+		memset (&g_thinkProfile, 0, sizeof (g_thinkProfile));
+		memset (g_frameHist, 0, sizeof (g_frameHist));
+		memset (g_traceHist, 0, sizeof (g_traceHist));
+		g_profileFrames = 0;
+		g_profileWorstFrame = 0;
+		gi.cprintf (NULL, PRINT_HIGH, "Profile reset.\n");
+		return;
+	}
+
+	if (!gi.Microseconds)
+	{
+		gi.cprintf (NULL, PRINT_HIGH, "Profiling needs an engine with the EGL game extensions.\n");
+		return;
+	}
+	if (!g_profileFrames)
+	{
+		gi.cprintf (NULL, PRINT_HIGH, "Nothing profiled, set g_profile 1 first.\n");
+		return;
+	}
+
+	count = (gi.argc () > 2) ? atoi (gi.argv(2)) : 15;
+	if (count < 1)
+		count = 15;
+
+	gi.cprintf (NULL, PRINT_HIGH, "%i frames, worst %.2fms\n", g_profileFrames, g_profileWorstFrame / 1000.0);
+
+	gi.cprintf (NULL, PRINT_HIGH, "\nBy classname:\n");
+	G_ProfilePrintTable (&g_classProfile, count);
+
+	gi.cprintf (NULL, PRINT_HIGH, "\nBy think function:\n");
+	G_ProfilePrintTable (&g_thinkProfile, count);
+
+	gi.cprintf (NULL, PRINT_HIGH, "\n");
+	G_ProfilePrintHist ("Frame time:", g_frameHist, frameLabels);
+	G_ProfilePrintHist ("Traces per frame:", g_traceHist, traceLabels);
+}
@@ -194,6 +194,7 @@ void InitGame (void)
 	filterban = gi.cvar ("filterban", "1", 0);
 
 	g_select_empty = gi.cvar ("g_select_empty", "0", CVAR_ARCHIVE);
+	g_profile = gi.cvar ("g_profile", "0", 0);
 
 	run_pitch = gi.cvar ("run_pitch", "0.002", 0);
 	run_roll = gi.cvar ("run_roll", "0.005", 0);
@@ -221,6 +222,7 @@ void InitGame (void)
 	g_edicts =  gi.TagMalloc (game.maxentities * sizeof(g_edicts[0]), TAG_GAME);
 	globals.edicts = g_edicts;
 	globals.maxEdicts = game.maxentities;
+	G_InitEntityIndex ();
 
 	// initialize all clients for this game
 	game.maxclients = maxclients->floatVal;
@@ -514,6 +516,7 @@ void ReadGame (char *filename)
 
 	g_edicts =  gi.TagMalloc (game.maxentities * sizeof(g_edicts[0]), TAG_GAME);
 	globals.edicts = g_edicts;
+	G_InitEntityIndex ();
 
 	fread (&game, sizeof(game), 1, f);
 	game.clients = gi.TagMalloc (game.maxclients * sizeof(game.clients[0]), TAG_GAME);
@@ -706,6 +709,7 @@ void ReadLevel (char *filename)
 
 	// wipe all the entities
 	memset (g_edicts, 0, game.maxentities*sizeof(g_edicts[0]));
+	G_ClearEntityIndex ();
 	globals.numEdicts = maxclients->floatVal+1;
 
 	// check edict size
@@ -754,6 +758,9 @@ void ReadLevel (char *filename)
 
 	fclose (f);
 
+	// the name fields were restored behind the index's back
+	G_SyncEntityIndex ();
+
 	// mark all clients as unconnected
 	for (i=0 ; i<maxclients->floatVal ; i++)
 	{
@@ -465,6 +465,7 @@ static char *ED_ParseEdict (char *data, edict_t *ent)
 	if (!init)
 		memset (ent, 0, sizeof(*ent));
 
+	G_IndexEdict (ent);
 	return data;
 }
 
@@ -479,11 +480,30 @@ All but the first will have the FL_TEAMSLAVE flag set.
 All but the last will have the teamchain field set to the next one
 ================
 */
+#define TEAM_HASH_SIZE	256
+
+typedef struct teamHash_s {
+	edict_t				*master;
+	edict_t				*last;
+	struct teamHash_s	*hashNext;
+} teamHash_t;
+
 void G_FindTeams (void)
 {
-	edict_t	*e, *e2, *chain;
-	int		i, j;
-	int		c, c2;
+	teamHash_t	*hashTable[TEAM_HASH_SIZE];
+	teamHash_t	*teams, *team;
+	edict_t		*e;
+	char		*s;
+	uint32		hash;
+	int			i;
+	int			c, c2;
+
+	// One pass in edict order, the first edict seen of a team is its master
+	memset (hashTable, 0, sizeof (hashTable));
+	if (gi.ObjMalloc)
+		teams = gi.ObjMalloc (globals.numEdicts * sizeof (teamHash_t));
+	else
+		teams = gi.TagMalloc (globals.numEdicts * sizeof (teamHash_t), TAG_LEVEL);
 
 	c = 0;
 	c2 = 0;
@@ -495,29 +515,39 @@ void G_FindTeams (void)
 			continue;
 		if (e->flags & FL_TEAMSLAVE)
 			continue;
-		chain = e;
-		e->teammaster = e;
-		c++;
+
+		for (hash=0, s=e->team ; *s ; s++)
+			hash = hash * 31 + *s;
+		hash &= TEAM_HASH_SIZE-1;
+
+		for (team=hashTable[hash] ; team ; team=team->hashNext) {
+			if (!strcmp (team->master->team, e->team))
+				break;
+		}
+
 		c2++;
-		for (j=i+1, e2=e+1 ; j < globals.numEdicts ; j++,e2++)
+		if (!team)
 		{
-			if (!e2->inUse)
-				continue;
-			if (!e2->team)
-				continue;
-			if (e2->flags & FL_TEAMSLAVE)
-				continue;
-			if (!strcmp(e->team, e2->team))
-			{
-				c2++;
-				chain->teamchain = e2;
-				e2->teammaster = e;
-				chain = e2;
-				e2->flags |= FL_TEAMSLAVE;
-			}
+			team = &teams[c++];
+			team->master = e;
+			team->last = e;
+			team->hashNext = hashTable[hash];
+			hashTable[hash] = team;
+			e->teammaster = e;
+			continue;
 		}
+
+		team->last->teamchain = e;
+		e->teammaster = team->master;
+		team->last = e;
+		e->flags |= FL_TEAMSLAVE;
 	}
 
+	if (gi.ObjFree)
+		gi.ObjFree (teams);
+	else
+		gi.TagFree (teams);
+
 	gi.dprintf ("%i teams with %i entities\n", c, c2);
 }
 
@@ -552,6 +582,7 @@ void SpawnEntities (char *mapname, char *entities, char *spawnpoint)
 
 	memset (&level, 0, sizeof(level));
 	memset (g_edicts, 0, game.maxentities * sizeof (g_edicts[0]));
+	G_ClearEntityIndex ();
 
 	strncpy (level.mapname, mapname, sizeof(level.mapname)-1);
 	strncpy (game.spawnpoint, spawnpoint, sizeof(game.spawnpoint)-1);
@@ -622,6 +653,7 @@ void SpawnEntities (char *mapname, char *entities, char *spawnpoint)
 	}
 #endif
 
+	G_SyncEntityIndex ();
 	G_FindTeams ();
 
 	PlayerTrail_Init ();
@@ -382,7 +382,7 @@ void use_target_spawner (edict_t *self, edict_t *other, edict_t *activator)
 	edict_t	*ent;
 
 	ent = G_Spawn();
-	ent->classname = self->target;
+	G_SetClassname (ent, self->target);
 	Vec3Copy (self->s.origin, ent->s.origin);
 	Vec3Copy (self->s.angles, ent->s.angles);
 	ED_CallSpawn (ent);
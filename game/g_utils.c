@@ -30,6 +30,294 @@ void G_ProjectSource (vec3_t point, vec3_t distance, vec3_t forward, vec3_t righ
 }
 
 
+/*
+=============================================================================
+
+	ENTITY NAME INDEX
+
+	Chains edicts by classname and targetname so G_Find doesn't have to
+	compare against every edict. Each distinct name (ignoring case) is
+	interned once per level as a key that lists its edicts in edict order.
+	Change these fields with G_SetClassname/G_SetTargetname to keep the
+	index current; G_SyncEntityIndex picks up any other writes once a frame.
+=============================================================================
+*/
+
+#define NAME_HASH_SIZE	512
+
+enum {
+	NAME_CLASSNAME,
+	NAME_TARGETNAME,
+
+	NAME_MAX_FIELDS
+};
+
+typedef struct nameKey_s {
+	char				*name;
+	int					first, last;	// edict numbers, -1 if none
+	struct nameKey_s	*hashNext;
+} nameKey_t;
+
+typedef struct nameLink_s {
+	nameKey_t			*key;
+	char				*value;			// field pointer as of the last index
+	int					prev, next;
+} nameLink_t;
+
+static nameKey_t	*g_nameHash[NAME_MAX_FIELDS][NAME_HASH_SIZE];
+static nameLink_t	*g_nameLinks[NAME_MAX_FIELDS];		// [game.maxentities]
+
+// findradius dirty list, sized and cleared with the index
+static int			*g_dirtyEdicts;		// [game.maxentities] edict numbers
+static int			*g_dirtySlots;		// [game.maxentities] 1 + place in g_dirtyEdicts, 0 if clean
+static int			g_numDirtyEdicts;
+
+/*
+=============
+G_NameField
+=============
+*/
+static int G_NameField (ptrdiff_t fieldofs)
+{
+	if (fieldofs == FOFS(classname))
+		return NAME_CLASSNAME;
+	if (fieldofs == FOFS(targetname))
+		return NAME_TARGETNAME;
+	return -1;
+}
+
+
+/*
+=============
+G_NameHash
+=============
+*/
+static uint32 G_NameHash (char *name)
+{
+	uint32	hash;
+	int		c;
+
+	for (hash=0 ; *name ; name++) {
+		c = *name;
+		if (c >= 'A' && c <= 'Z')
+			c += 'a' - 'A';
+		hash = hash * 31 + c;
+	}
+
+	return hash & (NAME_HASH_SIZE-1);
+}
+
+
+/*
+=============
+G_FindNameKey
+=============
+*/
+static nameKey_t *G_FindNameKey (int field, char *name, qBool create)
+{
+	nameKey_t	*key;
+	uint32		hash;
+
+	hash = G_NameHash (name);
+	for (key=g_nameHash[field][hash] ; key ; key=key->hashNext) {
+		if (!Q_stricmp (key->name, name))
+			return key;
+	}
+
+	if (!create)
+		return NULL;
+
+	key = gi.TagMalloc (sizeof (nameKey_t), TAG_LEVEL);
+	key->name = G_CopyString (name);
+	key->first = key->last = -1;
+	key->hashNext = g_nameHash[field][hash];
+	g_nameHash[field][hash] = key;
+	return key;
+}
+
+
+/*
+=============
+G_UnlinkName
+=============
+*/
+static void G_UnlinkName (int field, int num)
+{
+	nameLink_t	*links = g_nameLinks[field];
+	nameLink_t	*link = &links[num];
+
+	if (link->key) {
+		if (link->prev != -1)
+			links[link->prev].next = link->next;
+		else
+			link->key->first = link->next;
+		if (link->next != -1)
+			links[link->next].prev = link->prev;
+		else
+			link->key->last = link->prev;
+	}
+
+	link->key = NULL;
+	link->value = NULL;
+	link->prev = link->next = -1;
+}
+
+
+/*
+=============
+G_LinkName
+=============
+*/
+static void G_LinkName (int field, int num, char *value)
+{
+	nameLink_t	*links = g_nameLinks[field];
+	nameLink_t	*link = &links[num];
+	nameKey_t	*key;
+	int			after;
+
+	link->value = value;
+	if (!value)
+		return;
+
+	key = G_FindNameKey (field, value, qTrue);
+	link->key = key;
+
+	// Keep the chain in edict order, edicts are mostly indexed in order
+	after = key->last;
+	while (after != -1 && after > num)
+		after = links[after].prev;
+
+	link->prev = after;
+	if (after != -1) {
+		link->next = links[after].next;
+		links[after].next = num;
+	}
+	else {
+		link->next = key->first;
+		key->first = num;
+	}
+	if (link->next != -1)
+		links[link->next].prev = num;
+	else
+		key->last = num;
+}
+
+
+/*
+=============
+G_IndexEdict
+
+Re-indexes ent if its classname or targetname changed.
+=============
+*/
+void G_IndexEdict (edict_t *ent)
+{
+	int		num;
+
+	if (!g_nameLinks[0])
+		return;
+
+	num = ent - g_edicts;
+	if (ent->classname != g_nameLinks[NAME_CLASSNAME][num].value) {
+		G_UnlinkName (NAME_CLASSNAME, num);
+		G_LinkName (NAME_CLASSNAME, num, ent->classname);
+	}
+	if (ent->targetname != g_nameLinks[NAME_TARGETNAME][num].value) {
+		G_UnlinkName (NAME_TARGETNAME, num);
+		G_LinkName (NAME_TARGETNAME, num, ent->targetname);
+	}
+}
+
+
+/*
+=============
+G_SetClassname
+=============
+*/
+void G_SetClassname (edict_t *ent, char *classname)
+{
+	ent->classname = classname;
+	G_IndexEdict (ent);
+}
+
+
+/*
+=============
+G_SetTargetname
+=============
+*/
+void G_SetTargetname (edict_t *ent, char *targetname)
+{
+	ent->targetname = targetname;
+	G_IndexEdict (ent);
+}
+
+
+/*
+=============
+G_SyncEntityIndex
+
+Catches fields that were written directly or restored from a save.
+=============
+*/
+void G_SyncEntityIndex (void)
+{
+	int		i;
+
+	for (i=0 ; i<globals.numEdicts ; i++)
+		G_IndexEdict (&g_edicts[i]);
+}
+
+
+/*
+=============
+G_ClearEntityIndex
+
+Called whenever g_edicts is wiped. Keys are level allocations, so this
+must also follow every gi.FreeTags (TAG_LEVEL).
+=============
+*/
+void G_ClearEntityIndex (void)
+{
+	int		i, j;
+
+	memset (g_nameHash, 0, sizeof (g_nameHash));
+	if (g_dirtySlots)
+		memset (g_dirtySlots, 0, game.maxentities * sizeof (int));
+	g_numDirtyEdicts = 0;
+
+	for (i=0 ; i<NAME_MAX_FIELDS ; i++) {
+		if (!g_nameLinks[i])
+			continue;
+		for (j=0 ; j<game.maxentities ; j++) {
+			g_nameLinks[i][j].key = NULL;
+			g_nameLinks[i][j].value = NULL;
+			g_nameLinks[i][j].prev = g_nameLinks[i][j].next = -1;
+		}
+	}
+}
+
+
+/*
+=============
+G_InitEntityIndex
+
+Called after g_edicts is allocated.
+=============
+*/
+void G_InitEntityIndex (void)
+{
+	int		i;
+
+	for (i=0 ; i<NAME_MAX_FIELDS ; i++)
+		g_nameLinks[i] = gi.TagMalloc (game.maxentities * sizeof (nameLink_t), TAG_GAME);
+	g_dirtyEdicts = gi.TagMalloc (game.maxentities * sizeof (int), TAG_GAME);
+	g_dirtySlots = gi.TagMalloc (game.maxentities * sizeof (int), TAG_GAME);
+	G_ClearEntityIndex ();
+}
+
+// ==========================================================================
+
 /*
 =============
 G_Find
@@ -40,11 +328,48 @@ the matching string at fieldofs (use the FOFS() macro) in the structure.
 Searches beginning at the edict after from, or the beginning if NULL
 NULL will be returned if the end of the list is reached.
 
+classname and targetname are looked up in the name index.
 =============
 */
 edict_t *G_Find (edict_t *from, ptrdiff_t fieldofs, char *match)
 {
-	char	*s;
+	char		*s;
+	nameKey_t	*key;
+	nameLink_t	*links;
+	edict_t		*ent;
+	int			field;
+	int			num;
+
+	field = G_NameField (fieldofs);
+	if (field != -1 && g_nameLinks[field]) {
+		key = G_FindNameKey (field, match, qFalse);
+		if (!key)
+			return NULL;
+
+		// Pick up after from when it is in this chain
+		links = g_nameLinks[field];
+		if (!from)
+			num = key->first;
+		else if (links[from - g_edicts].key == key)
+			num = links[from - g_edicts].next;
+		else {
+			for (num=key->first ; num != -1 && num <= from - g_edicts ; num=links[num].next) ;
+		}
+
+		for ( ; num != -1 ; num=links[num].next) {
+			ent = &g_edicts[num];
+			if (!ent->inUse)
+				continue;
+
+			// Written directly since it was indexed
+			s = *(char **) ((byte *)ent + fieldofs);
+			if (s != links[num].value && (!s || Q_stricmp (s, match)))
+				continue;
+			return ent;
+		}
+
+		return NULL;
+	}
 
 	if (!from)
 		from = g_edicts;
@@ -73,28 +398,226 @@ findradius
 Returns entities that have origins within a spherical area
 
 findradius (origin, radius)
+
+A search starting at NULL asks the server for the edicts near the sphere
+once, and later calls with the same origin and radius walk that list. The
+server only knows edicts by their links, so the list also takes the solid
+edicts on the dirty list: spawned or unlinked and not linked since. Like
+traces, this relies on the game relinking an edict after moving it or
+making it solid.
 =================
 */
-edict_t *findradius (edict_t *from, vec3_t org, float rad)
+#define RADIUS_SEARCHES	4		// nested searches that keep their list
+
+typedef struct radiusSearch_s {
+	vec3_t		org;
+	float		rad;
+	int			numEdicts;
+	edict_t		*edicts[MAX_CS_EDICTS];
+} radiusSearch_t;
+
+static radiusSearch_t	g_radiusSearches[RADIUS_SEARCHES];
+static int				g_nextRadiusSearch;
+
+static void		(*g_engineLinkEntity) (edict_t *ent);
+static void		(*g_engineUnlinkEntity) (edict_t *ent);
+
+/*
+=============
+G_RadiusDirty
+
+Puts an edict on the dirty list or takes it off.
+=============
+*/
+void G_RadiusDirty (edict_t *ent, qBool dirty)
+{
+	int		num, slot;
+
+	if (!g_dirtySlots)
+		return;
+
+	num = ent - g_edicts;
+	slot = g_dirtySlots[num];
+	if (dirty)
+	{
+		if (!slot)
+		{
+			g_dirtyEdicts[g_numDirtyEdicts++] = num;
+			g_dirtySlots[num] = g_numDirtyEdicts;
+		}
+		return;
+	}
+
+	if (slot)
+	{
+		g_numDirtyEdicts--;
+		g_dirtyEdicts[slot-1] = g_dirtyEdicts[g_numDirtyEdicts];
+		g_dirtySlots[g_dirtyEdicts[slot-1]] = slot;
+		g_dirtySlots[num] = 0;
+	}
+}
+
+static void G_LinkEntity (edict_t *ent)
+{
+	g_engineLinkEntity (ent);
+	G_RadiusDirty (ent, (ent->solid != SOLID_NOT && !ent->area.prev) ? qTrue : qFalse);
+}
+
+static void G_UnlinkEntity (edict_t *ent)
+{
+	g_engineUnlinkEntity (ent);
+	G_RadiusDirty (ent, (ent->inUse && ent->solid != SOLID_NOT) ? qTrue : qFalse);
+}
+
+/*
+=============
+G_HookLinks
+
+Routes gi.linkentity and gi.unlinkentity through the dirty list, called
+once the imports are in.
+=============
+*/
+void G_HookLinks (void)
+{
+	if (!gi.RadiusEdicts)
+		return;
+
+	g_engineLinkEntity = gi.linkentity;
+	g_engineUnlinkEntity = gi.unlinkentity;
+	gi.linkentity = G_LinkEntity;
+	gi.unlinkentity = G_UnlinkEntity;
+}
+
+static qBool findradius_check (edict_t *ent, vec3_t org, float rad)
 {
 	vec3_t	eorg;
 	int		j;
 
-	if (!from)
-		from = g_edicts;
-	else
-		from++;
-	for ( ; from < &g_edicts[globals.numEdicts]; from++)
+	if (!ent->inUse)
+		return qFalse;
+	if (ent->solid == SOLID_NOT)
+		return qFalse;
+	for (j=0 ; j<3 ; j++)
+		eorg[j] = org[j] - (ent->s.origin[j] + (ent->mins[j] + ent->maxs[j])*0.5);
+	if (Vec3Length(eorg) > rad)
+		return qFalse;
+	return qTrue;
+}
+
+static int findradius_cmp (const void *a, const void *b)
+{
+	const edict_t	*e1 = *(const edict_t **)a;
+	const edict_t	*e2 = *(const edict_t **)b;
+
+	if (e1 < e2)
+		return -1;
+	return e1 > e2;
+}
+
+static void findradius_build (radiusSearch_t *search, vec3_t org, float rad)
+{
+	edict_t	*ent;
+	int		num, i;
+
+	Vec3Copy (org, search->org);
+	search->rad = rad;
+
+	// Pad the radius, the server measures to the link bounds
+	num = gi.RadiusEdicts (org, rad + 1, search->edicts, MAX_CS_EDICTS);
+	if (!g_numDirtyEdicts)
 	{
-		if (!from->inUse)
-			continue;
-		if (from->solid == SOLID_NOT)
-			continue;
-		for (j=0 ; j<3 ; j++)
-			eorg[j] = org[j] - (from->s.origin[j] + (from->mins[j] + from->maxs[j])*0.5);
-		if (Vec3Length(eorg) > rad)
+		search->numEdicts = num;
+		return;
+	}
+
+	for (i=0 ; i<g_numDirtyEdicts && num<MAX_CS_EDICTS ; )
+	{
+		ent = &g_edicts[g_dirtyEdicts[i]];
+
+		// Edicts that were never made solid stay out of it
+		if (ent->solid == SOLID_NOT)
+		{
+			G_RadiusDirty (ent, qFalse);
 			continue;
-		return from;
+		}
+
+		search->edicts[num++] = ent;
+		i++;
+	}
+	if (num == MAX_CS_EDICTS)
+	{
+		search->numEdicts = MAX_CS_EDICTS;
+		return;
+	}
+
+	// Back in edict order
+	qsort (search->edicts, num, sizeof (edict_t *), findradius_cmp);
+	search->numEdicts = num;
+}
+
+edict_t *findradius (edict_t *from, vec3_t org, float rad)
+{
+	radiusSearch_t	*search;
+	int				i, lo, hi;
+
+	search = NULL;
+	for (i=0 ; i<RADIUS_SEARCHES && gi.RadiusEdicts ; i++)
+	{
+		if (g_radiusSearches[i].rad == rad && Vec3Compare (g_radiusSearches[i].org, org))
+		{
+			search = &g_radiusSearches[i];
+			break;
+		}
+	}
+
+	if (!from && gi.RadiusEdicts)
+	{
+		if (!search)
+		{
+			search = &g_radiusSearches[g_nextRadiusSearch];
+			g_nextRadiusSearch = (g_nextRadiusSearch + 1) % RADIUS_SEARCHES;
+		}
+		findradius_build (search, org, rad);
+	}
+
+	// The list may have been cut short, scan everything
+	if (search && search->numEdicts == MAX_CS_EDICTS)
+		search = NULL;
+
+	if (!search)
+	{
+		if (!from)
+			from = g_edicts;
+		else
+			from++;
+		for ( ; from < &g_edicts[globals.numEdicts]; from++)
+		{
+			if (findradius_check (from, org, rad))
+				return from;
+		}
+
+		return NULL;
+	}
+
+	// Skip past from
+	lo = 0;
+	if (from)
+	{
+		hi = search->numEdicts;
+		while (lo < hi)
+		{
+			i = (lo + hi) / 2;
+			if (search->edicts[i] <= from)
+				lo = i + 1;
+			else
+				hi = i;
+		}
+	}
+
+	for (i=lo ; i<search->numEdicts ; i++)
+	{
+		if (findradius_check (search->edicts[i], org, rad))
+			return search->edicts[i];
 	}
 
 	return NULL;
@@ -181,7 +704,7 @@ void G_UseTargets (edict_t *ent, edict_t *activator)
 	{
 	// create a temp object to fire at a later time
 		t = G_Spawn();
-		t->classname = "DelayedUse";
+		G_SetClassname (t, "DelayedUse");
 		t->nextthink = level.time + ent->delay;
 		t->think = Think_Delay;
 		t->activator = activator;
@@ -346,6 +869,10 @@ void G_InitEdict (edict_t *e)
 	e->classname = "noclass";
 	e->gravity = 1.0;
 	e->s.number = e - g_edicts;
+	G_IndexEdict (e);
+
+	// Not linked yet
+	G_RadiusDirty (e, qTrue);
 }
 
 /*
@@ -405,6 +932,8 @@ void G_FreeEdict (edict_t *ed)
 	ed->classname = "freed";
 	ed->freetime = level.time;
 	ed->inUse = qFalse;
+	G_IndexEdict (ed);
+	G_RadiusDirty (ed, qFalse);
 }
 
 
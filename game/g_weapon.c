@@ -126,116 +126,121 @@ qBool fire_hit (edict_t *self, vec3_t aim, int damage, int kick)
 
 /*
 =================
-fire_lead
+fire_lead_end
 
-This is an internal support routine used for bullet/pellet based weapons.
+Picks where a bullet fired from start along aimdir is headed.
 =================
 */
-static void fire_lead (edict_t *self, vec3_t start, vec3_t aimdir, int damage, int kick, int te_impact, int hspread, int vspread, int mod)
+static void fire_lead_end (vec3_t start, vec3_t aimdir, int hspread, int vspread, vec3_t end)
 {
-	trace_t		tr;
 	vec3_t		dir;
 	vec3_t		forward, right, up;
-	vec3_t		end;
 	float		r;
 	float		u;
-	vec3_t		water_start;
-	qBool	water = qFalse;
-	int			content_mask = MASK_SHOT | MASK_WATER;
 
-	tr = gi.trace (self->s.origin, NULL, NULL, start, self, MASK_SHOT);
-	if (!(tr.fraction < 1.0))
-	{
-		VecToAngles (aimdir, dir);
-		Angles_Vectors (dir, forward, right, up);
+	VecToAngles (aimdir, dir);
+	Angles_Vectors (dir, forward, right, up);
 
-		r = crandom()*hspread;
-		u = crandom()*vspread;
-		Vec3MA (start, 8192, forward, end);
-		Vec3MA (end, r, right, end);
-		Vec3MA (end, u, up, end);
+	r = crandom()*hspread;
+	u = crandom()*vspread;
+	Vec3MA (start, 8192, forward, end);
+	Vec3MA (end, r, right, end);
+	Vec3MA (end, u, up, end);
+}
 
-		if (gi.pointcontents (start) & MASK_WATER)
+
+/*
+=================
+fire_lead_water
+
+Splashes and bends a bullet whose trace from start stopped at water,
+then re-traces the rest of its path ignoring water.
+=================
+*/
+static void fire_lead_water (edict_t *self, vec3_t start, vec3_t end, int hspread, int vspread, trace_t *tr, vec3_t water_start)
+{
+	vec3_t		dir;
+	vec3_t		forward, right, up;
+	float		r;
+	float		u;
+	int			color;
+
+	Vec3Copy (tr->endPos, water_start);
+
+	if (!Vec3Compare (start, tr->endPos))
+	{
+		if (tr->contents & CONTENTS_WATER)
 		{
-			water = qTrue;
-			Vec3Copy (start, water_start);
-			content_mask &= ~MASK_WATER;
+			if (strcmp(tr->surface->name, "*brwater") == 0)
+				color = SPLASH_BROWN_WATER;
+			else
+				color = SPLASH_BLUE_WATER;
 		}
+		else if (tr->contents & CONTENTS_SLIME)
+			color = SPLASH_SLIME;
+		else if (tr->contents & CONTENTS_LAVA)
+			color = SPLASH_LAVA;
+		else
+			color = SPLASH_UNKNOWN;
 
-		tr = gi.trace (start, NULL, NULL, end, self, content_mask);
-
-		// see if we hit water
-		if (tr.contents & MASK_WATER)
+		if (color != SPLASH_UNKNOWN)
 		{
-			int		color;
+			gi.WriteByte (SVC_TEMP_ENTITY);
+			gi.WriteByte (TE_SPLASH);
+			gi.WriteByte (8);
+			gi.WritePosition (tr->endPos);
+			gi.WriteDir (tr->plane.normal);
+			gi.WriteByte (color);
+			gi.multicast (tr->endPos, MULTICAST_PVS);
+		}
 
-			water = qTrue;
-			Vec3Copy (tr.endPos, water_start);
+		// change bullet's course when it enters water
+		Vec3Subtract (end, start, dir);
+		VecToAngles (dir, dir);
+		Angles_Vectors (dir, forward, right, up);
+		r = crandom()*hspread*2;
+		u = crandom()*vspread*2;
+		Vec3MA (water_start, 8192, forward, end);
+		Vec3MA (end, r, right, end);
+		Vec3MA (end, u, up, end);
+	}
 
-			if (!Vec3Compare (start, tr.endPos))
-			{
-				if (tr.contents & CONTENTS_WATER)
-				{
-					if (strcmp(tr.surface->name, "*brwater") == 0)
-						color = SPLASH_BROWN_WATER;
-					else
-						color = SPLASH_BLUE_WATER;
-				}
-				else if (tr.contents & CONTENTS_SLIME)
-					color = SPLASH_SLIME;
-				else if (tr.contents & CONTENTS_LAVA)
-					color = SPLASH_LAVA;
-				else
-					color = SPLASH_UNKNOWN;
-
-				if (color != SPLASH_UNKNOWN)
-				{
-					gi.WriteByte (SVC_TEMP_ENTITY);
-					gi.WriteByte (TE_SPLASH);
-					gi.WriteByte (8);
-					gi.WritePosition (tr.endPos);
-					gi.WriteDir (tr.plane.normal);
-					gi.WriteByte (color);
-					gi.multicast (tr.endPos, MULTICAST_PVS);
-				}
+	// re-trace ignoring water this time
+	*tr = gi.trace (water_start, NULL, NULL, end, self, MASK_SHOT);
+}
 
-				// change bullet's course when it enters water
-				Vec3Subtract (end, start, dir);
-				VecToAngles (dir, dir);
-				Angles_Vectors (dir, forward, right, up);
-				r = crandom()*hspread*2;
-				u = crandom()*vspread*2;
-				Vec3MA (water_start, 8192, forward, end);
-				Vec3MA (end, r, right, end);
-				Vec3MA (end, u, up, end);
-			}
 
-			// re-trace ignoring water this time
-			tr = gi.trace (water_start, NULL, NULL, end, self, MASK_SHOT);
-		}
-	}
+/*
+=================
+fire_lead_impact
 
+Damages whatever the bullet hit or leaves a puff, and draws the bubble
+trail if it went through water.
+=================
+*/
+static void fire_lead_impact (edict_t *self, vec3_t aimdir, int damage, int kick, int te_impact, int mod, trace_t *tr, qBool water, vec3_t water_start)
+{
 	// send gun puff / flash
-	if (!((tr.surface) && (tr.surface->flags & SURF_TEXINFO_SKY)))
+	if (!((tr->surface) && (tr->surface->flags & SURF_TEXINFO_SKY)))
 	{
-		if (tr.fraction < 1.0)
+		if (tr->fraction < 1.0)
 		{
-			if (tr.ent->takedamage)
+			if (tr->ent->takedamage)
 			{
-				T_Damage (tr.ent, self, self, aimdir, tr.endPos, tr.plane.normal, damage, kick, DAMAGE_BULLET, mod);
+				T_Damage (tr->ent, self, self, aimdir, tr->endPos, tr->plane.normal, damage, kick, DAMAGE_BULLET, mod);
 			}
 			else
 			{
-				if (strncmp (tr.surface->name, "sky", 3) != 0)
+				if (strncmp (tr->surface->name, "sky", 3) != 0)
 				{
 					gi.WriteByte (SVC_TEMP_ENTITY);
 					gi.WriteByte (te_impact);
-					gi.WritePosition (tr.endPos);
-					gi.WriteDir (tr.plane.normal);
-					gi.multicast (tr.endPos, MULTICAST_PVS);
+					gi.WritePosition (tr->endPos);
+					gi.WriteDir (tr->plane.normal);
+					gi.multicast (tr->endPos, MULTICAST_PVS);
 
 					if (self->client)
-						PlayerNoise(self, tr.endPos, PNOISE_IMPACT);
+						PlayerNoise(self, tr->endPos, PNOISE_IMPACT);
 				}
 			}
 		}
@@ -244,28 +249,70 @@ static void fire_lead (edict_t *self, vec3_t start, vec3_t aimdir, int damage, i
 	// if went through water, determine where the end and make a bubble trail
 	if (water)
 	{
+		vec3_t	dir;
 		vec3_t	pos;
 
-		Vec3Subtract (tr.endPos, water_start, dir);
+		Vec3Subtract (tr->endPos, water_start, dir);
 		VectorNormalizef (dir, dir);
-		Vec3MA (tr.endPos, -2, dir, pos);
+		Vec3MA (tr->endPos, -2, dir, pos);
 		if (gi.pointcontents (pos) & MASK_WATER)
-			Vec3Copy (pos, tr.endPos);
+			Vec3Copy (pos, tr->endPos);
 		else
-			tr = gi.trace (pos, NULL, NULL, water_start, tr.ent, MASK_WATER);
+			*tr = gi.trace (pos, NULL, NULL, water_start, tr->ent, MASK_WATER);
 
-		Vec3Add (water_start, tr.endPos, pos);
+		Vec3Add (water_start, tr->endPos, pos);
 		Vec3Scale (pos, 0.5, pos);
 
 		gi.WriteByte (SVC_TEMP_ENTITY);
 		gi.WriteByte (TE_BUBBLETRAIL);
 		gi.WritePosition (water_start);
-		gi.WritePosition (tr.endPos);
+		gi.WritePosition (tr->endPos);
 		gi.multicast (pos, MULTICAST_PVS);
 	}
 }
 
 
+/*
+=================
+fire_lead
+
+This is an internal support routine used for bullet/pellet based weapons.
+=================
+*/
+static void fire_lead (edict_t *self, vec3_t start, vec3_t aimdir, int damage, int kick, int te_impact, int hspread, int vspread, int mod)
+{
+	trace_t		tr;
+	vec3_t		end;
+	vec3_t		water_start;
+	qBool	water = qFalse;
+	int			content_mask = MASK_SHOT | MASK_WATER;
+
+	tr = gi.trace (self->s.origin, NULL, NULL, start, self, MASK_SHOT);
+	if (!(tr.fraction < 1.0))
+	{
+		fire_lead_end (start, aimdir, hspread, vspread, end);
+
+		if (gi.pointcontents (start) & MASK_WATER)
+		{
+			water = qTrue;
+			Vec3Copy (start, water_start);
+			content_mask &= ~MASK_WATER;
+		}
+
+		tr = gi.trace (start, NULL, NULL, end, self, content_mask);
+
+		// see if we hit water
+		if (tr.contents & MASK_WATER)
+		{
+			water = qTrue;
+			fire_lead_water (self, start, end, hspread, vspread, &tr, water_start);
+		}
+	}
+
+	fire_lead_impact (self, aimdir, damage, kick, te_impact, mod, &tr, water, water_start);
+}
+
+
 /*
 =================
 fire_bullet
@@ -285,14 +332,76 @@ void fire_bullet (edict_t *self, vec3_t start, vec3_t aimdir, int damage, int ki
 fire_shotgun
 
 Shoots shotgun pellets.  Used by shotgun and super shotgun.
+
+All the pellets leave from the same spot, so their traces go to the
+engine in one batch when it has gi.TraceBatch.
 =================
 */
+#define MAX_SHOTGUN_PELLETS	32
+
 void fire_shotgun (edict_t *self, vec3_t start, vec3_t aimdir, int damage, int kick, int hspread, int vspread, int count, int mod)
 {
-	int		i;
+	traceRequest_t	req[MAX_SHOTGUN_PELLETS];
+	trace_t			results[MAX_SHOTGUN_PELLETS];
+	int				linkCounts[MAX_SHOTGUN_PELLETS];
+	trace_t			tr;
+	vec3_t			water_start;
+	qBool			startWater;
+	qBool			water;
+	int				i;
+
+	if (count > MAX_SHOTGUN_PELLETS || !gi.TraceBatch)
+	{
+		for (i = 0; i < count; i++)
+			fire_lead (self, start, aimdir, damage, kick, TE_SHOTGUN, hspread, vspread, mod);
+		return;
+	}
 
+	tr = gi.trace (self->s.origin, NULL, NULL, start, self, MASK_SHOT);
+	if (tr.fraction < 1.0)
+	{
+		// muzzle is blocked, every pellet hits the same thing
+		for (i = 0; i < count; i++)
+			fire_lead (self, start, aimdir, damage, kick, TE_SHOTGUN, hspread, vspread, mod);
+		return;
+	}
+
+	startWater = (gi.pointcontents (start) & MASK_WATER) ? qTrue : qFalse;
 	for (i = 0; i < count; i++)
-		fire_lead (self, start, aimdir, damage, kick, TE_SHOTGUN, hspread, vspread, mod);
+	{
+		Vec3Copy (start, req[i].start);
+		Vec3Clear (req[i].mins);
+		Vec3Clear (req[i].maxs);
+		fire_lead_end (start, aimdir, hspread, vspread, req[i].end);
+		req[i].passEnt = self;
+		req[i].contentMask = startWater ? MASK_SHOT : (MASK_SHOT | MASK_WATER);
+	}
+
+	gi.TraceBatch (req, results, count);
+	for (i = 0; i < count; i++)
+		linkCounts[i] = results[i].ent ? results[i].ent->linkCount : 0;
+
+	for (i = 0; i < count; i++)
+	{
+		tr = results[i];
+
+		// an earlier pellet may have gibbed, killed or pushed what this one hit
+		if (tr.ent && (!tr.ent->inUse || tr.ent->solid == SOLID_NOT || tr.ent->linkCount != linkCounts[i]))
+			tr = gi.trace (req[i].start, NULL, NULL, req[i].end, self, req[i].contentMask);
+
+		water = startWater;
+		if (startWater)
+			Vec3Copy (start, water_start);
+
+		// see if we hit water
+		if (tr.contents & MASK_WATER)
+		{
+			water = qTrue;
+			fire_lead_water (self, start, req[i].end, hspread, vspread, &tr, water_start);
+		}
+
+		fire_lead_impact (self, aimdir, damage, kick, TE_SHOTGUN, mod, &tr, water, water_start);
+	}
 }
 
 
@@ -373,7 +482,7 @@ void fire_blaster (edict_t *self, vec3_t start, vec3_t dir, int damage, int spee
 	bolt->nextthink = level.time + 2;
 	bolt->think = G_FreeEdict;
 	bolt->dmg = damage;
-	bolt->classname = "bolt";
+	G_SetClassname (bolt, "bolt");
 	if (hyper)
 		bolt->spawnflags = 1;
 	gi.linkentity (bolt);
@@ -511,7 +620,7 @@ void fire_grenade (edict_t *self, vec3_t start, vec3_t aimdir, int damage, int s
 	grenade->think = Grenade_Explode;
 	grenade->dmg = damage;
 	grenade->dmg_radius = damage_radius;
-	grenade->classname = "grenade";
+	G_SetClassname (grenade, "grenade");
 
 	gi.linkentity (grenade);
 }
@@ -544,7 +653,7 @@ void fire_grenade2 (edict_t *self, vec3_t start, vec3_t aimdir, int damage, int
 	grenade->think = Grenade_Explode;
 	grenade->dmg = damage;
 	grenade->dmg_radius = damage_radius;
-	grenade->classname = "hgrenade";
+	G_SetClassname (grenade, "hgrenade");
 	if (held)
 		grenade->spawnflags = 3;
 	else
@@ -641,7 +750,7 @@ void fire_rocket (edict_t *self, vec3_t start, vec3_t dir, int damage, int speed
 	rocket->radius_dmg = radius_damage;
 	rocket->dmg_radius = damage_radius;
 	rocket->s.sound = gi.soundindex ("weapons/rockfly.wav");
-	rocket->classname = "rocket";
+	G_SetClassname (rocket, "rocket");
 
 	if (self->client)
 		check_dodge (self, rocket->s.origin, dir, speed);
@@ -903,7 +1012,7 @@ void fire_bfg (edict_t *self, vec3_t start, vec3_t dir, int damage, int speed, f
 	bfg->think = G_FreeEdict;
 	bfg->radius_dmg = damage;
 	bfg->dmg_radius = damage_radius;
-	bfg->classname = "bfg blast";
+	G_SetClassname (bfg, "bfg blast");
 	bfg->s.sound = gi.soundindex ("weapons/bfg__l1a.wav");
 
 	bfg->think = bfg_think;
@@ -22,6 +22,11 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 
 #define GAME_APIVERSION		3
 
+// Engines that fill in the extensions at the end of gameImport_t set this
+// read-only cvar to the extension version they provide
+#define GAME_EXTCVAR		"sv_gameext"
+#define GAME_EXTVERSION		2
+
 // edict->svFlags
 
 #define SVF_NOCLIENT			0x00000001	// don't send entity to clients, even if it has effects
@@ -93,6 +98,15 @@ typedef struct gclient_s gclient_t;
 
 // ==========================================================================
 
+// one move for gameImport_t::TraceBatch, mins and maxs are relative
+typedef struct traceRequest_s {
+	vec3_t				start;
+	vec3_t				mins, maxs;
+	vec3_t				end;
+	edict_t				*passEnt;
+	int					contentMask;
+} traceRequest_t;
+
 //
 // functions provided by the main engine
 //
@@ -169,6 +183,30 @@ typedef struct gameImport_s {
 	void	(*AddCommandString) (char *text);
 
 	void	(*DebugGraph) (float value, int color);
+
+	//
+	// EGL extensions. Other engines hand over a gameImport_t that ends
+	// above, so the game only copies these when GAME_EXTCVAR says they're
+	// there, and leaves them NULL otherwise
+	//
+
+	// runs numRequests traces, results[i] is what trace would return for
+	// requests[i]; cheaper than separate calls when the moves are close
+	void	(*TraceBatch) (traceRequest_t *requests, trace_t *results, int numRequests);
+
+	// solid and trigger edicts with bounds within radius of origin, in
+	// edict number order
+	int		(*RadiusEdicts) (vec3_t origin, float radius, edict_t **list, int maxCount);
+
+	// for g_profile, a microsecond clock and the collision traces run
+	// so far this frame
+	uint32	(*Microseconds) (void);
+	int		(*NumTraces) (void);
+
+	// GAME_EXTVERSION 2: fixed-size object classes for small allocations
+	// that come and go
+	void	*(*ObjMalloc) (size_t size);
+	void	(*ObjFree) (void *block);
 } gameImport_t;
 
 //
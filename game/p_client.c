@@ -56,7 +56,7 @@ static void SP_FixCoopSpots (edict_t *self)
 			if ((!self->targetname) || Q_stricmp(self->targetname, spot->targetname) != 0)
 			{
 //				gi.dprintf("FixCoopSpots changed %s at %s targetname from %s to %s\n", self->classname, vtos(self->s.origin), self->targetname, spot->targetname);
-				self->targetname = spot->targetname;
+				G_SetTargetname (self, spot->targetname);
 			}
 			return;
 		}
@@ -74,27 +74,27 @@ static void SP_CreateCoopSpots (edict_t *self)
 	if(Q_stricmp(level.mapname, "security") == 0)
 	{
 		spot = G_Spawn();
-		spot->classname = "info_player_coop";
+		G_SetClassname (spot, "info_player_coop");
 		spot->s.origin[0] = 188 - 64;
 		spot->s.origin[1] = -164;
 		spot->s.origin[2] = 80;
-		spot->targetname = "jail3";
+		G_SetTargetname (spot, "jail3");
 		spot->s.angles[1] = 90;
 
 		spot = G_Spawn();
-		spot->classname = "info_player_coop";
+		G_SetClassname (spot, "info_player_coop");
 		spot->s.origin[0] = 188 + 64;
 		spot->s.origin[1] = -164;
 		spot->s.origin[2] = 80;
-		spot->targetname = "jail3";
+		G_SetTargetname (spot, "jail3");
 		spot->s.angles[1] = 90;
 
 		spot = G_Spawn();
-		spot->classname = "info_player_coop";
+		G_SetClassname (spot, "info_player_coop");
 		spot->s.origin[0] = 188 + 128;
 		spot->s.origin[1] = -164;
 		spot->s.origin[2] = 80;
-		spot->targetname = "jail3";
+		G_SetTargetname (spot, "jail3");
 		spot->s.angles[1] = 90;
 
 		return;
@@ -935,7 +935,7 @@ void InitBodyQue (void)
 	for (i=0; i<BODY_QUEUE_SIZE ; i++)
 	{
 		ent = G_Spawn();
-		ent->classname = "bodyque";
+		G_SetClassname (ent, "bodyque");
 	}
 }
 
@@ -1177,7 +1177,7 @@ void PutClientInServer (edict_t *ent)
 	ent->movetype = MOVETYPE_WALK;
 	ent->viewheight = 22;
 	ent->inUse = qTrue;
-	ent->classname = "player";
+	G_SetClassname (ent, "player");
 	ent->mass = 200;
 	ent->solid = SOLID_BBOX;
 	ent->deadflag = DEAD_NO;
@@ -1342,7 +1342,7 @@ void ClientBegin (edict_t *ent)
 		// except for the persistant data that was initialized at
 		// ClientConnect() time
 		G_InitEdict (ent);
-		ent->classname = "player";
+		G_SetClassname (ent, "player");
 		InitClientResp (ent->client);
 		PutClientInServer (ent);
 	}
@@ -1541,7 +1541,7 @@ void ClientDisconnect (edict_t *ent)
 	ent->s.modelIndex = 0;
 	ent->solid = SOLID_NOT;
 	ent->inUse = qFalse;
-	ent->classname = "disconnected";
+	G_SetClassname (ent, "disconnected");
 	ent->client->pers.connected = qFalse;
 
 	playernum = ent-g_edicts-1;
@@ -772,7 +772,6 @@ typedef struct refInfo_s {
 	image_t				*fogTexture;		// fog texture for q3 bsp
 
 	// Memory management
-	struct memPool_s	*decalSysPool;
 	struct memPool_s	*fontSysPool;
 	struct memPool_s	*genericPool;
 	struct memPool_s	*imageSysPool;
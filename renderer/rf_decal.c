@@ -789,12 +789,12 @@ qBool R_CreateDecal (refDecal_t *d, struct material_s *material, vec4_t subUVs,
 	d->poly.numVerts = totalVerts;
 	d->numSurfaces = totalSurfaces;
 
-	// Allocate space
-	buffer = Mem_PoolAlloc ((d->poly.numVerts * sizeof (vec3_t) * 2)
+	// Allocate space, decals come and go constantly so these come from the object classes
+	buffer = Mem_ObjAlloc ((d->poly.numVerts * sizeof (vec3_t) * 2)
 							+ (d->numIndexes * sizeof (index_t))
 							+ (d->poly.numVerts * sizeof (vec2_t))
 							+ (d->poly.numVerts * sizeof (bvec4_t))
-							+ (d->numSurfaces * sizeof (struct mBspSurface_s *)), ri.decalSysPool, 0);
+							+ (d->numSurfaces * sizeof (struct mBspSurface_s *)));
 	outVerts = (float *)buffer;
 	d->poly.vertices = (vec3_t *)buffer;
 
@@ -888,7 +888,7 @@ qBool R_FreeDecal (refDecal_t *d)
 	if (!d || !d->poly.vertices)
 		return qFalse;
 
-	Mem_Free (d->poly.vertices);
+	Mem_ObjFree (d->poly.vertices);
 	d->poly.vertices = NULL;
 	return qTrue;
 }
@@ -2638,6 +2638,7 @@ static void R_ScreenShot_f (void)
 	// Finish
 	fclose (f);
 	Mem_Free (buffer);
+	FS_InvalidateIndex ();
 
 	Com_Printf (0, "Wrote egl%.3d.%s\n", shotNum, ext);
 }
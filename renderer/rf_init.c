@@ -1329,12 +1329,11 @@ rInit_t R_Init (void)
 	ri.cStencilBits = 0;
 
 	// Create memory pools
-	ri.decalSysPool = Mem_CreatePool ("Refresh: Decal system");
 	ri.fontSysPool = Mem_CreatePool ("Refresh: Font system");
 	ri.genericPool = Mem_CreatePool ("Refresh: Generic");
 	ri.imageSysPool = Mem_CreatePool ("Refresh: Image system");
 	ri.lightSysPool = Mem_CreatePool ("Refresh: Light system");
-	ri.modelSysPool = Mem_CreatePool ("Refresh: Model system");
+	ri.modelSysPool = Mem_CreateArenaPool ("Refresh: Model system", 1<<20);
 	ri.programSysPool = Mem_CreatePool ("Refresh: Program system");
 	ri.matSysPool = Mem_CreatePool ("Refresh: Material system");
 
@@ -151,13 +151,13 @@ static qBool R_LoadMD2Model (refModel_t *model)
 	int				fileLen;
 
 	// Load the file
-	fileLen = FS_LoadFile (model->name, (void **)&buffer, NULL);
+	fileLen = FS_LoadFileView (model->name, (const void **)&buffer);
 	if (!buffer || fileLen <= 0)
 		return qFalse;
 
 	// Check the header
 	if (strncmp ((const char *)buffer, MD2_HEADERSTR, 4)) {
-		FS_FreeFile (buffer);
+		FS_FreeFileView (buffer);
 		Com_Printf (PRNT_ERROR, "R_LoadMD2Model: '%s' has invalid header", model->name);
 		return qFalse;
 	}
@@ -166,7 +166,7 @@ static qBool R_LoadMD2Model (refModel_t *model)
 	inModel = (dMd2Header_t *)buffer;
 	version = LittleLong (inModel->version);
 	if (version != MD2_MODEL_VERSION) {
-		FS_FreeFile (buffer);
+		FS_FreeFileView (buffer);
 		Com_Printf (PRNT_ERROR, "R_LoadMD2Model: '%s' has wrong version number (%i != %i)", model->name, version, MD2_MODEL_VERSION);
 		return qFalse;
 	}
@@ -187,14 +187,14 @@ static qBool R_LoadMD2Model (refModel_t *model)
 
 	outMesh->numVerts = LittleLong (inModel->numVerts);
 	if (outMesh->numVerts <= 0 || outMesh->numVerts > MD2_MAX_VERTS) {
-		FS_FreeFile (buffer);
+		FS_FreeFileView (buffer);
 		Com_Printf (PRNT_ERROR, "R_LoadMD2Model: model '%s' has an invalid amount of vertices '%d'", model->name, outMesh->numVerts);
 		return qFalse;
 	}
 
 	outMesh->numTris = LittleLong (inModel->numTris);
 	if (outMesh->numTris <= 0 || outMesh->numTris > MD2_MAX_TRIANGLES) {
-		FS_FreeFile (buffer);
+		FS_FreeFileView (buffer);
 		Com_Printf (PRNT_ERROR, "R_LoadMD2Model: model '%s' has an invalid amount of triangles '%d'", model->name, outMesh->numTris);
 		return qFalse;
 	}
@@ -202,7 +202,7 @@ static qBool R_LoadMD2Model (refModel_t *model)
 	frameSize = LittleLong (inModel->frameSize);
 	outModel->numFrames = LittleLong (inModel->numFrames);
 	if (outModel->numFrames <= 0 || outModel->numFrames > MD2_MAX_FRAMES) {
-		FS_FreeFile (buffer);
+		FS_FreeFileView (buffer);
 		Com_Printf (PRNT_ERROR, "R_LoadMD2Model: model '%s' has an invalid amount of frames '%d'", model->name, outModel->numFrames);
 		return qFalse;
 	}
@@ -213,14 +213,14 @@ static qBool R_LoadMD2Model (refModel_t *model)
 	skinWidth = LittleLong (inModel->skinWidth);
 	skinHeight = LittleLong (inModel->skinHeight);
 	if (skinWidth <= 0 || skinHeight <= 0) {
-		FS_FreeFile (buffer);
+		FS_FreeFileView (buffer);
 		Com_Printf (PRNT_ERROR, "R_LoadMD2Model: model '%s' has invalid skin dimensions '%d x %d'", model->name, skinWidth, skinHeight);
 		return qFalse;
 	}
 
 	outMesh->numSkins = LittleLong (inModel->numSkins);
 	if (outMesh->numSkins < 0 || outMesh->numSkins > MD2_MAX_SKINS) {
-		FS_FreeFile (buffer);
+		FS_FreeFileView (buffer);
 		Com_Printf (PRNT_ERROR, "R_LoadMD2Model: model '%s' has an invalid amount of skins '%d'", model->name, outMesh->numSkins);
 		return qFalse;
 	}
@@ -285,7 +285,7 @@ static qBool R_LoadMD2Model (refModel_t *model)
 	}
 
 	if (numVerts <= 0 || numVerts >= ALIAS_MAX_VERTS) {
-		FS_FreeFile (buffer);
+		FS_FreeFileView (buffer);
 		Com_Printf (PRNT_ERROR, "R_LoadMD2Model: model '%s' has an invalid amount of resampled verts for an alias model '%d' >= ALIAS_MAX_VERTS", numVerts, ALIAS_MAX_VERTS);
 		return qFalse;
 	}
@@ -415,7 +415,7 @@ static qBool R_LoadMD2Model (refModel_t *model)
 	}
 
 	// Done
-	FS_FreeFile (buffer);
+	FS_FreeFileView (buffer);
 	return qTrue;
 }
 
@@ -480,13 +480,13 @@ static qBool R_LoadMD3Model (refModel_t *model)
 	int					fileLen;
 
 	// Load the file
-	fileLen = FS_LoadFile (model->name, (void **)&buffer, NULL);
+	fileLen = FS_LoadFileView (model->name, (const void **)&buffer);
 	if (!buffer || fileLen <= 0)
 		return qFalse;
 
 	// Check the header
 	if (strncmp ((const char *)buffer, MD3_HEADERSTR, 4)) {
-		FS_FreeFile (buffer);
+		FS_FreeFileView (buffer);
 		Com_Printf (PRNT_ERROR, "R_LoadMD3Model: '%s' has invalid header", model->name);
 		return qFalse;
 	}
@@ -495,7 +495,7 @@ static qBool R_LoadMD3Model (refModel_t *model)
 	inModel = (dMd3Header_t *)buffer;
 	version = LittleLong (inModel->version);
 	if (version != MD3_MODEL_VERSION) {
-		FS_FreeFile (buffer);
+		FS_FreeFileView (buffer);
 		Com_Printf (PRNT_ERROR, "R_LoadMD3Model: model '%s' has wrong version number (%i != %i)", model->name, version, MD3_MODEL_VERSION);
 		return qFalse;
 	}
@@ -508,27 +508,27 @@ static qBool R_LoadMD3Model (refModel_t *model)
 	//
 	outModel->numFrames = LittleLong (inModel->numFrames);
 	if (outModel->numFrames <= 0 || outModel->numFrames > MD3_MAX_FRAMES) {
-		FS_FreeFile (buffer);
+		FS_FreeFileView (buffer);
 		Com_Printf (PRNT_ERROR, "R_LoadMD3Model: model '%s' has an invalid amount of frames '%d'", model->name, outModel->numFrames);
 		return qFalse;
 	}
 
 	outModel->numTags = LittleLong (inModel->numTags);
 	if (outModel->numTags < 0 || outModel->numTags > MD3_MAX_TAGS) {
-		FS_FreeFile (buffer);
+		FS_FreeFileView (buffer);
 		Com_Printf (PRNT_ERROR, "R_LoadMD3Model: model '%s' has an invalid amount of tags '%d'", model->name, outModel->numTags);
 		return qFalse;
 	}
 
 	outModel->numMeshes = LittleLong (inModel->numMeshes);
 	if (outModel->numMeshes < 0 || outModel->numMeshes > MD3_MAX_MESHES) {
-		FS_FreeFile (buffer);
+		FS_FreeFileView (buffer);
 		Com_Printf (PRNT_ERROR, "R_LoadMD3Model: model '%s' has an invalid amount of meshes '%d'", model->name, outModel->numMeshes);
 		return qFalse;
 	}
 
 	if (!outModel->numMeshes && !outModel->numTags) {
-		FS_FreeFile (buffer);
+		FS_FreeFileView (buffer);
 		Com_Printf (PRNT_ERROR, "R_LoadMD3Model: model '%s' has no meshes and no tags!", model->name);
 		return qFalse;
 	}
@@ -591,7 +591,7 @@ static qBool R_LoadMD3Model (refModel_t *model)
 	for (i=0 ; i<outModel->numMeshes ; i++, outMesh++) {
 		Q_strncpyz (outMesh->name, inMesh->meshName, sizeof (outMesh->name));
 		if (strncmp ((const char *)inMesh->ident, MD3_HEADERSTR, 4)) {
-			FS_FreeFile (buffer);
+			FS_FreeFileView (buffer);
 			Com_Printf (PRNT_ERROR, "R_LoadMD3Model: mesh '%s' in model '%s' has wrong id (%i != %i)", inMesh->meshName, model->name, LittleLong (*(int* )inMesh->ident), MD3_HEADER);
 			return qFalse;
 		}
@@ -600,27 +600,27 @@ static qBool R_LoadMD3Model (refModel_t *model)
 
 		outMesh->numSkins = LittleLong (inMesh->numSkins);
 		if (outMesh->numSkins <= 0 || outMesh->numSkins > MD3_MAX_SHADERS) {
-			FS_FreeFile (buffer);
+			FS_FreeFileView (buffer);
 			Com_Printf (PRNT_ERROR, "R_LoadMD3Model: mesh '%s' in model '%s' has an invalid amount of skins '%d'", outMesh->name, model->name, outMesh->numSkins);
 			return qFalse;
 		}
 
 		outMesh->numTris = LittleLong (inMesh->numTris);
 		if (outMesh->numTris <= 0 || outMesh->numTris > MD3_MAX_TRIANGLES) {
-			FS_FreeFile (buffer);
+			FS_FreeFileView (buffer);
 			Com_Printf (PRNT_ERROR, "R_LoadMD3Model: mesh '%s' in model '%s' has an invalid amount of triangles '%d'", outMesh->name, model->name, outMesh->numTris);
 			return qFalse;
 		}
 
 		outMesh->numVerts = LittleLong (inMesh->numVerts);
 		if (outMesh->numVerts <= 0 || outMesh->numVerts > MD3_MAX_VERTS) {
-			FS_FreeFile (buffer);
+			FS_FreeFileView (buffer);
 			Com_Printf (PRNT_ERROR, "R_LoadMD3Model: mesh '%s' in model '%s' has an invalid amount of vertices '%d'", outMesh->name, model->name, outMesh->numVerts);
 			return qFalse;
 		}
 
 		if (outMesh->numVerts >= ALIAS_MAX_VERTS) {
-			FS_FreeFile (buffer);
+			FS_FreeFileView (buffer);
 			Com_Printf (PRNT_ERROR, "R_LoadMD3Model: mesh '%s' in model '%s' has an invalid amount verts for an alias model '%d' >= ALIAS_MAX_VERTS", outMesh->name, outMesh->numVerts, ALIAS_MAX_VERTS);
 			return qFalse;
 		}
@@ -756,7 +756,7 @@ static qBool R_LoadMD3Model (refModel_t *model)
 	}
 
 	// Done
-	FS_FreeFile (buffer);
+	FS_FreeFileView (buffer);
 	return qTrue;
 }
 
@@ -786,7 +786,7 @@ static qBool R_LoadSP2Model (refModel_t *model)
 	int				fileLen;
 
 	// Load the file
-	fileLen = FS_LoadFile (model->name, (void **)&buffer, NULL);
+	fileLen = FS_LoadFileView (model->name, (const void **)&buffer);
 	if (!buffer || fileLen <= 0)
 		return qFalse;
 
@@ -797,14 +797,14 @@ static qBool R_LoadSP2Model (refModel_t *model)
 	//
 	version = LittleLong (inModel->version);
 	if (version != SP2_VERSION) {
-		FS_FreeFile (buffer);
+		FS_FreeFileView (buffer);
 		Com_Printf (PRNT_ERROR, "R_LoadSP2Model: '%s' has wrong version number (%i should be %i)", model->name, version, SP2_VERSION);
 		return qFalse;
 	}
 
 	numFrames = LittleLong (inModel->numFrames);
 	if (numFrames > SP2_MAX_FRAMES) {
-		FS_FreeFile (buffer);
+		FS_FreeFileView (buffer);
 		Com_Printf (PRNT_ERROR, "R_LoadSP2Model: '%s' has too many frames (%i > %i)", model->name, numFrames, SP2_MAX_FRAMES);
 		return qFalse;
 	}
@@ -843,6 +843,8 @@ static qBool R_LoadSP2Model (refModel_t *model)
 			Com_DevPrintf (PRNT_WARNING, "R_LoadSP2Model: '%s' could not load skin '%s'\n", model->name, outFrames->name);
 	}
 
+	FS_FreeFileView (buffer);
+
 	// Done
 	return qTrue;
 }
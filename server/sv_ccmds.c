@@ -250,8 +250,10 @@ static void SV_WriteLevelFile (void)
 	FS_CloseFile (fileNum);
 
 	Q_snprintfz (name, sizeof (name), "%s/save/current/%s.sav", FS_Gamedir(), sv.name);
-	if (ge)
+	if (ge) {
 		ge->WriteLevel (name);
+		FS_InvalidateIndex ();
+	}
 }
 
 
@@ -352,8 +354,10 @@ static void SV_WriteServerFile (qBool autoSave)
 
 	// Write game state
 	Q_snprintfz (name, sizeof (name), "%s/save/current/game.ssv", FS_Gamedir());
-	if (ge)
+	if (ge) {
 		ge->WriteGame (name, autoSave);
+		FS_InvalidateIndex ();
+	}
 }
 
 
@@ -1023,6 +1027,9 @@ static void SV_ServerCommand_f (void)
 
 	if (ge)
 		ge->ServerCommand ();
+
+	// The game writes files like listip.cfg around the filesystem
+	FS_InvalidateIndex ();
 }
 
 
@@ -1038,6 +1045,8 @@ void SV_OperatorCommandInit (void)
 	Cmd_AddCommand ("status",		SV_Status_f,		"");
 	Cmd_AddCommand ("serverinfo",	SV_Serverinfo_f,	"");
 	Cmd_AddCommand ("dumpuser",		SV_DumpUser_f,		"");
+	Cmd_AddCommand ("areabench",	SV_AreaBench_f,		"Replays recent entity area queries against the node tree and the loose grid");
+	Cmd_AddCommand ("deltastats",	SV_DeltaStats_f,	"Shows shared delta cache hits and misses, 'reset' clears them");
 
 	Cmd_AddCommand ("map",			SV_Map_f,			"Loads a map");
 	Cmd_AddCommand ("devmap",		SV_Map_f,			"Opens a map with cheats enabled");
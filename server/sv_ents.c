@@ -31,6 +31,183 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 =============================================================================
 */
 
+/*
+=============================================================================
+
+	SHARED DELTA CACHE
+
+	In a busy match most clients get the same entity transitions, from the
+	baseline or from last frame's state. Each from/to pair is encoded once
+	per send pass and the bytes are copied for every other client that
+	needs it. Every frame building thread has its own cache, so they never
+	lock, and a hit compares the full states so it can't send a wrong delta.
+=============================================================================
+*/
+
+#define DELTACACHE_HASH_SIZE	1024		// must be a power of two
+#define DELTACACHE_BYTES		(MAX_CL_MSGLEN*16)
+
+typedef struct svDeltaEntry_s {
+	int					pass;
+	uint32				hash;
+	int					flags;			// force and newEntity
+	entityStateOld_t	from;
+	entityStateOld_t	to;
+	int					offset;
+	int					length;
+} svDeltaEntry_t;
+
+typedef struct svDeltaCache_s {
+	int					pass;
+	int					used;			// bytes of data filled this pass
+	uint32				hits;
+	uint32				misses;
+	uint32				bytesCopied;
+	svDeltaEntry_t		entries[DELTACACHE_HASH_SIZE];
+	byte				data[DELTACACHE_BYTES];
+} svDeltaCache_t;
+
+static svDeltaCache_t	*sv_deltaCaches[SYS_MAX_JOB_THREADS];
+static int				sv_deltaPass;
+static int				sv_deltaPasses;		// since the last deltastats reset
+
+/*
+=============
+SV_BeginDeltaCaches
+
+Starts a new send pass for the caches of the first numThreads threads.
+=============
+*/
+void SV_BeginDeltaCaches (int numThreads)
+{
+	int		i;
+
+	sv_deltaPass++;
+	sv_deltaPasses++;
+	for (i=0 ; i<numThreads ; i++) {
+		if (!sv_deltaCaches[i])
+			sv_deltaCaches[i] = Mem_PoolAlloc (sizeof (svDeltaCache_t), sv_genericPool, 0);
+		sv_deltaCaches[i]->pass = sv_deltaPass;
+		sv_deltaCaches[i]->used = 0;
+	}
+}
+
+
+/*
+=============
+SV_DeltaHash
+=============
+*/
+static uint32 SV_DeltaHash (entityStateOld_t *from, entityStateOld_t *to, int flags)
+{
+	uint32	*words;
+	uint32	hash;
+	int		i;
+
+	hash = 2166136261u ^ flags;
+	words = (uint32 *)from;
+	for (i=0 ; i<sizeof (entityStateOld_t)/4 ; i++)
+		hash = (hash ^ words[i]) * 16777619u;
+	words = (uint32 *)to;
+	for (i=0 ; i<sizeof (entityStateOld_t)/4 ; i++)
+		hash = (hash ^ words[i]) * 16777619u;
+
+	return hash;
+}
+
+
+/*
+=============
+SV_WriteDeltaEntity
+
+MSG_WriteDeltaEntity through the thread's delta cache.
+=============
+*/
+static void SV_WriteDeltaEntity (svDeltaCache_t *cache, netMsg_t *msg, entityStateOld_t *from, entityStateOld_t *to, qBool force, qBool newEntity)
+{
+	svDeltaEntry_t	*entry;
+	uint32			hash;
+	size_t			start;
+	int				flags;
+
+	if (!cache) {
+		MSG_WriteDeltaEntity (msg, from, to, force, newEntity);
+		return;
+	}
+
+	flags = (force ? 1 : 0) | (newEntity ? 2 : 0);
+	hash = SV_DeltaHash (from, to, flags);
+	entry = &cache->entries[hash & (DELTACACHE_HASH_SIZE-1)];
+
+	if (entry->pass == cache->pass
+	&& entry->hash == hash
+	&& entry->flags == flags
+	&& !memcmp (&entry->to, to, sizeof (entityStateOld_t))
+	&& !memcmp (&entry->from, from, sizeof (entityStateOld_t))) {
+		cache->hits++;
+		if (entry->length) {
+			MSG_WriteRaw (msg, cache->data + entry->offset, entry->length);
+			cache->bytesCopied += entry->length;
+		}
+		return;
+	}
+
+	cache->misses++;
+	start = msg->curSize;
+	MSG_WriteDeltaEntity (msg, from, to, force, newEntity);
+	if (msg->overFlowed || msg->curSize < start)
+		return;
+
+	// Keep the encoding for the next client
+	if (cache->used + (msg->curSize - start) > DELTACACHE_BYTES)
+		return;
+
+	entry->pass = cache->pass;
+	entry->hash = hash;
+	entry->flags = flags;
+	entry->from = *from;
+	entry->to = *to;
+	entry->offset = cache->used;
+	entry->length = (int)(msg->curSize - start);
+	memcpy (cache->data + entry->offset, msg->data + start, entry->length);
+	cache->used += entry->length;
+}
+
+
+/*
+=============
+SV_DeltaStats_f
+=============
+*/
+void SV_DeltaStats_f (void)
+{
+	uint32	hits, misses, bytes;
+	int		i;
+
+	hits = misses = bytes = 0;
+	for (i=0 ; i<SYS_MAX_JOB_THREADS ; i++) {
+		if (!sv_deltaCaches[i])
+			continue;
+
+		hits += sv_deltaCaches[i]->hits;
+		misses += sv_deltaCaches[i]->misses;
+		bytes += sv_deltaCaches[i]->bytesCopied;
+		if (Cmd_Argc () > 1 && !Q_stricmp (Cmd_Argv (1), "reset"))
+			sv_deltaCaches[i]->hits = sv_deltaCaches[i]->misses = sv_deltaCaches[i]->bytesCopied = 0;
+	}
+
+	Com_Printf (0, "send passes  : %i\n", sv_deltaPasses);
+	Com_Printf (0, "delta hits   : %u\n", hits);
+	Com_Printf (0, "delta misses : %u\n", misses);
+	Com_Printf (0, "hit rate     : %.1f%%\n", (hits+misses) ? hits*100.0f/(hits+misses) : 0.0f);
+	Com_Printf (0, "bytes copied : %u\n", bytes);
+
+	if (Cmd_Argc () > 1 && !Q_stricmp (Cmd_Argv (1), "reset"))
+		sv_deltaPasses = 0;
+}
+
+// ==========================================================================
+
 /*
 =============
 SV_EmitPacketEntities
@@ -38,7 +215,7 @@ SV_EmitPacketEntities
 Writes a delta update of an entityStateOld_t list to the message.
 =============
 */
-static void SV_EmitPacketEntities (clientFrame_t *from, clientFrame_t *to, netMsg_t *msg)
+static void SV_EmitPacketEntities (svDeltaCache_t *cache, clientFrame_t *from, clientFrame_t *to, netMsg_t *msg)
 {
 	entityStateOld_t	*oldEnt, *newEnt;
 	int		oldIndex, newIndex;
@@ -81,7 +258,7 @@ static void SV_EmitPacketEntities (clientFrame_t *from, clientFrame_t *to, netMs
 			** note that players are always 'newentities', this updates their oldorigin always
 			** and prevents warping
 			*/
-			MSG_WriteDeltaEntity (msg, oldEnt, newEnt, qFalse, newEnt->number <= maxclients->intVal);
+			SV_WriteDeltaEntity (cache, msg, oldEnt, newEnt, qFalse, newEnt->number <= maxclients->intVal);
 			oldIndex++;
 			newIndex++;
 			continue;
@@ -89,7 +266,7 @@ static void SV_EmitPacketEntities (clientFrame_t *from, clientFrame_t *to, netMs
 
 		if (newNum < oldNum) {
 			// This is a new entity, send it from the baseline
-			MSG_WriteDeltaEntity (msg, &sv.baseLines[newNum], newEnt, qTrue, qTrue);
+			SV_WriteDeltaEntity (cache, msg, &sv.baseLines[newNum], newEnt, qTrue, qTrue);
 			newIndex++;
 			continue;
 		}
@@ -304,9 +481,11 @@ static void SV_WritePlayerstateToClient (clientFrame_t *from, clientFrame_t *to,
 /*
 ==================
 SV_WriteFrameToClient
+
+thread picks the delta cache, -1 encodes without one.
 ==================
 */
-void SV_WriteFrameToClient (svClient_t *client, netMsg_t *msg)
+void SV_WriteFrameToClient (svClient_t *client, netMsg_t *msg, int thread)
 {
 	clientFrame_t	*frame, *oldFrame;
 	int				lastFrame;
@@ -344,7 +523,7 @@ void SV_WriteFrameToClient (svClient_t *client, netMsg_t *msg)
 	SV_WritePlayerstateToClient (oldFrame, frame, msg);
 
 	// Delta encode the entities
-	SV_EmitPacketEntities (oldFrame, frame, msg);
+	SV_EmitPacketEntities (thread >= 0 ? sv_deltaCaches[thread] : NULL, oldFrame, frame, msg);
 }
 
 
@@ -356,7 +535,7 @@ void SV_WriteFrameToClient (svClient_t *client, netMsg_t *msg)
 =============================================================================
 */
 
-static byte		sv_fatPVS[65536/8];	// 32767 is Q2BSP_MAX_LEAFS
+static const byte	*sv_fatPVS;
 
 /*
 ============
@@ -369,9 +548,7 @@ so we can't use a single PVS point
 static void SV_FatPVS (vec3_t org)
 {
 	int		leafs[64];
-	int		i, j, count;
-	int		longs;
-	byte	*src;
+	int		i, count;
 	vec3_t	mins, maxs;
 
 	for (i=0 ; i<3 ; i++) {
@@ -382,49 +559,189 @@ static void SV_FatPVS (vec3_t org)
 	count = CM_BoxLeafnums (mins, maxs, leafs, 64, NULL);
 	if (count < 1)
 		Com_Error (ERR_FATAL, "SV_FatPVS: count < 1");
-	longs = (CM_NumClusters()+31)>>5;
 
 	// convert leafs to clusters
 	for (i=0 ; i<count ; i++)
 		leafs[i] = CM_LeafCluster(leafs[i]);
 
-	memcpy (sv_fatPVS, CM_ClusterPVS(leafs[0]), longs<<2);
-	// or in all the other leaf bits
-	for (i=1 ; i<count ; i++) {
-		for (j=0 ; j<i ; j++)
-			if (leafs[i] == leafs[j])
-				break;
-		if (j != i)
-			continue;		// already have the cluster we want
-		src = CM_ClusterPVS(leafs[i]);
-		for (j=0 ; j<longs ; j++)
-			((long *)sv_fatPVS)[j] |= ((long *)src)[j];
+	// clients standing in the same clusters share the merged row
+	sv_fatPVS = CM_MergedClusterPVS (leafs, count);
+}
+
+
+/*
+=============================================================================
+
+	ENTITY VISIBILITY INDEX
+
+	Rebuilt once per send pass, before the first client frame. Every edict
+	that could be sent to anyone is flagged, and the ones that are culled
+	by cluster are chained from each cluster they touch. Beams and edicts
+	that are culled by headnode go on a short list that is still tested
+	per client. SV_BuildClientFrame then only walks the clusters that are
+	both occupied and inside the client's fat PVS.
+=============================================================================
+*/
+
+#define MAX_ENTITY_LINKS	(MAX_CS_EDICTS*MAX_ENT_CLUSTERS)
+
+typedef struct svEntityLink_s {
+	int			entNum;
+	int			next;		// index into sv_entityLinks, -1 ends the chain
+} svEntityLink_t;
+
+static int				sv_numEntityClusters;
+static int				*sv_clusterEntities;	// [sv_numEntityClusters], first link or -1
+static int				sv_numOccupiedEntityClusters;
+static int				sv_occupiedEntityClusters[MAX_ENTITY_LINKS];
+
+static int				sv_numEntityLinks;
+static svEntityLink_t	sv_entityLinks[MAX_ENTITY_LINKS];
+
+static int				sv_numPerClientEntities;
+static int				sv_perClientEntities[MAX_CS_EDICTS];	// beams and headnode culled
+
+static int				sv_numIndexedEdicts;
+static uint32			sv_sendableEntities[MAX_CS_EDICTS/32];
+
+// Per client copies of the vis rows, SV_BuildClientFrame can't call into
+// the collision model's shared PVS caches from a worker thread
+typedef struct svFrameVis_s {
+	vec3_t		origin;
+	int			area;
+	byte		*fatPVS;
+	byte		*phs;
+} svFrameVis_t;
+
+static svFrameVis_t		sv_frameVis[MAX_CS_CLIENTS];
+static int				sv_visRowBytes;
+static int				sv_numVisRowClients;
+static byte				*sv_visRows;			// [sv_numVisRowClients][2][sv_visRowBytes]
+
+/*
+=============
+SV_BuildEntityIndex
+=============
+*/
+void SV_BuildEntityIndex (void)
+{
+	edict_t	*ent;
+	int		numClusters;
+	int		e, i, l;
+
+	numClusters = CM_NumClusters ();
+	if (numClusters != sv_numEntityClusters) {
+		if (sv_clusterEntities)
+			Mem_Free (sv_clusterEntities);
+		sv_clusterEntities = numClusters ? Mem_PoolAlloc (sizeof (int) * numClusters, sv_genericPool, 0) : NULL;
+		sv_numEntityClusters = numClusters;
+		for (i=0 ; i<numClusters ; i++)
+			sv_clusterEntities[i] = -1;
+	}
+	else {
+		for (i=0 ; i<sv_numOccupiedEntityClusters ; i++)
+			sv_clusterEntities[sv_occupiedEntityClusters[i]] = -1;
+	}
+	sv_numOccupiedEntityClusters = 0;
+	sv_numEntityLinks = 0;
+	sv_numPerClientEntities = 0;
+	memset (sv_sendableEntities, 0, sizeof (sv_sendableEntities));
+
+	// Size the per client vis rows
+	l = max ((numClusters+7)>>3, 1);
+	if (l != sv_visRowBytes || maxclients->intVal != sv_numVisRowClients) {
+		if (sv_visRows)
+			Mem_Free (sv_visRows);
+		sv_visRowBytes = l;
+		sv_numVisRowClients = maxclients->intVal;
+		sv_visRows = Mem_PoolAlloc (sv_visRowBytes * 2 * sv_numVisRowClients, sv_genericPool, 0);
+		for (i=0 ; i<sv_numVisRowClients ; i++) {
+			sv_frameVis[i].fatPVS = sv_visRows + sv_visRowBytes*(i*2);
+			sv_frameVis[i].phs = sv_visRows + sv_visRowBytes*(i*2+1);
+		}
+	}
+
+	sv_numIndexedEdicts = min (ge->numEdicts, MAX_CS_EDICTS);
+	for (e=1 ; e<sv_numIndexedEdicts ; e++) {
+		ent = EDICT_NUM(e);
+
+		// ignore ents without visible models
+		if (ent->svFlags & SVF_NOCLIENT)
+			continue;
+
+		// ignore ents without visible models unless they have an effect
+		if (!ent->s.modelIndex && !ent->s.effects && !ent->s.sound && !ent->s.event)
+			continue;
+
+		if (ent->s.number != e) {
+			Com_DevPrintf (0, "FIXING ENT->S.NUMBER!!!\n");
+			ent->s.number = e;
+		}
+		sv_sendableEntities[e >> 5] |= 1U << (e & 31);
+
+		// beams just check one point for PHS, and ents with too many leafs
+		// for individual checks go by headnode, both are tested per client
+		if (ent->s.renderFx & RF_BEAM || ent->numClusters == -1) {
+			sv_perClientEntities[sv_numPerClientEntities++] = e;
+			continue;
+		}
+
+		for (i=0 ; i<ent->numClusters ; i++) {
+			l = ent->clusterNums[i];
+			if (l < 0 || l >= sv_numEntityClusters)
+				continue;
+
+			if (sv_clusterEntities[l] == -1)
+				sv_occupiedEntityClusters[sv_numOccupiedEntityClusters++] = l;
+			sv_entityLinks[sv_numEntityLinks].entNum = e;
+			sv_entityLinks[sv_numEntityLinks].next = sv_clusterEntities[l];
+			sv_clusterEntities[l] = sv_numEntityLinks++;
+		}
 	}
 }
 
 
 /*
 =============
-SV_BuildClientFrame
+SV_ClearEntityIndex
+=============
+*/
+void SV_ClearEntityIndex (void)
+{
+	if (sv_clusterEntities)
+		Mem_Free (sv_clusterEntities);
+	sv_clusterEntities = NULL;
+	sv_numEntityClusters = 0;
+	sv_numOccupiedEntityClusters = 0;
+	sv_numEntityLinks = 0;
+	sv_numPerClientEntities = 0;
+	sv_numIndexedEdicts = 0;
+
+	if (sv_visRows)
+		Mem_Free (sv_visRows);
+	sv_visRows = NULL;
+	sv_visRowBytes = 0;
+	sv_numVisRowClients = 0;
+}
 
-Decides which entities are going to be visible to the client, and
-copies off the playerstat and areaBits.
+
+/*
+=============
+SV_BeginClientFrame
+
+Does the parts of a client frame that go through the collision model's
+shared caches: finds the view leaf, copies off the playerstate and
+areaBits, and saves the fat PVS and PHS rows for SV_BuildClientFrame.
+Main thread only, after SV_BuildEntityIndex.
 =============
 */
-void SV_BuildClientFrame (svClient_t *client)
+void SV_BeginClientFrame (svClient_t *client)
 {
-	int			e, i;
-	vec3_t		org;
-	edict_t		*ent;
-	edict_t		*clent;
+	edict_t			*clent;
 	clientFrame_t	*frame;
-	entityStateOld_t	*state;
-	int			l;
-	int			clientarea, clientcluster;
-	int			leafnum;
-	int			c_fullsend;
-	byte		*clientphs;
-	byte		*bitvector;
+	svFrameVis_t	*vis;
+	int				leafnum;
+	int				clientcluster;
 
 	clent = client->edict;
 	if (!clent->client)
@@ -436,111 +753,153 @@ void SV_BuildClientFrame (svClient_t *client)
 	frame->sentTime = svs.realTime; // save it for ping calc later
 
 	// Find the client's PVS
-	org[0] = clent->client->playerState.pMove.origin[0]*(1.0f/8.0f) + clent->client->playerState.viewOffset[0];
-	org[1] = clent->client->playerState.pMove.origin[1]*(1.0f/8.0f) + clent->client->playerState.viewOffset[1];
-	org[2] = clent->client->playerState.pMove.origin[2]*(1.0f/8.0f) + clent->client->playerState.viewOffset[2];
+	vis = &sv_frameVis[client - svs.clients];
+	vis->origin[0] = clent->client->playerState.pMove.origin[0]*(1.0f/8.0f) + clent->client->playerState.viewOffset[0];
+	vis->origin[1] = clent->client->playerState.pMove.origin[1]*(1.0f/8.0f) + clent->client->playerState.viewOffset[1];
+	vis->origin[2] = clent->client->playerState.pMove.origin[2]*(1.0f/8.0f) + clent->client->playerState.viewOffset[2];
 
-	leafnum = CM_PointLeafnum (org);
-	clientarea = CM_LeafArea (leafnum);
+	leafnum = CM_PointLeafnum (vis->origin);
+	vis->area = CM_LeafArea (leafnum);
 	clientcluster = CM_LeafCluster (leafnum);
 
 	// calculate the visible areas
-	frame->areaBytes = CM_WriteAreaBits (frame->areaBits, clientarea);
+	frame->areaBytes = CM_WriteAreaBits (frame->areaBits, vis->area);
 
 	// grab the current playerState_t
 	frame->playerState = clent->client->playerState;
 
-	SV_FatPVS (org);
-	clientphs = CM_ClusterPHS (clientcluster);
+	SV_FatPVS (vis->origin);
+	if (sv_numEntityClusters) {
+		memcpy (vis->fatPVS, sv_fatPVS, sv_visRowBytes);
+		memcpy (vis->phs, CM_ClusterPHS (clientcluster), sv_visRowBytes);
+	}
+}
 
-	// build up the list of visible entities
-	frame->numEntities = 0;
-	frame->firstEntity = svs.nextClientEntities;
 
-	c_fullsend = 0;
+/*
+=============
+SV_BuildClientFrame
 
-	for (e=1 ; e<ge->numEdicts ; e++) {
-		ent = EDICT_NUM(e);
+Decides which entities are going to be visible to the client, and copies
+them into a slice of svs.clientEntities. Clients can be built on different
+threads at once, after SV_BeginClientFrame for each of them.
+=============
+*/
+void SV_BuildClientFrame (svClient_t *client)
+{
+	int			e, i;
+	edict_t		*ent;
+	edict_t		*clent;
+	clientFrame_t	*frame;
+	svFrameVis_t	*vis;
+	entityStateOld_t	*state;
+	int			l, link;
+	int			c_fullsend;
+	const byte	*fatpvs, *clientphs;
+	uint32		visible[MAX_CS_EDICTS/32];
+	uint32		bits;
+	int			sendList[MAX_CS_EDICTS];
+	int			numSend, first;
 
-		// ignore ents without visible models
-		if (ent->svFlags & SVF_NOCLIENT)
-			continue;
+	clent = client->edict;
+	if (!clent->client)
+		return;		// not in game yet
 
-		// ignore ents without visible models unless they have an effect
-		if (!ent->s.modelIndex && !ent->s.effects && !ent->s.sound && !ent->s.event)
+	// This is the frame we are creating
+	frame = &client->frames[sv.frameNum & UPDATE_MASK];
+
+	vis = &sv_frameVis[client - svs.clients];
+	fatpvs = vis->fatPVS;
+	clientphs = vis->phs;
+
+	c_fullsend = 0;
+
+	// collect the indexed ents touching a PV leaf
+	memset (visible, 0, sizeof (visible));
+	for (i=0 ; i<sv_numOccupiedEntityClusters ; i++) {
+		l = sv_occupiedEntityClusters[i];
+		if (!(fatpvs[l >> 3] & (1 << (l&7))))
 			continue;
 
-		// ignore if not touching a PV leaf
-		if (ent != clent) {
-			// check area
-			if (!CM_AreasConnected (clientarea, ent->areaNum)) {
-				/*
-				** doors can legally straddle two areas, so
-				** we may need to check another one
-				*/
-				if (!ent->areaNum2 || !CM_AreasConnected (clientarea, ent->areaNum2))
-					continue;		// blocked by a door
-			}
+		for (link=sv_clusterEntities[l] ; link != -1 ; link=sv_entityLinks[link].next) {
+			e = sv_entityLinks[link].entNum;
+			visible[e >> 5] |= 1U << (e & 31);
+		}
+	}
 
-			// beams just check one point for PHS
-			if (ent->s.renderFx & RF_BEAM) {
-				l = ent->clusterNums[0];
-				if (!(clientphs[l >> 3] & (1 << (l&7))))
-					continue;
-			}
-			else {
-				// FIXME: if an ent has a model and a sound, but isn't
-				// in the PVS, only the PHS, clear the model
-				if (ent->s.sound)
-					bitvector = sv_fatPVS;	//clientphs;
-				else
-					bitvector = sv_fatPVS;
-
-				if (ent->numClusters == -1) {
-					// too many leafs for individual check, go by headnode
-					if (!CM_HeadnodeVisible (ent->headNode, bitvector))
-						continue;
-					c_fullsend++;
-				}
-				else {
-					// check individual leafs
-					for (i=0 ; i < ent->numClusters ; i++) {
-						l = ent->clusterNums[i];
-						if (bitvector[l >> 3] & (1 << (l&7)))
-							break;
-					}
-					if (i == ent->numClusters)
-						continue;		// not visible
+	for (i=0 ; i<sv_numPerClientEntities ; i++) {
+		e = sv_perClientEntities[i];
+		ent = EDICT_NUM(e);
+
+		if (ent->s.renderFx & RF_BEAM) {
+			l = ent->clusterNums[0];
+			if (!(clientphs[l >> 3] & (1 << (l&7))))
+				continue;
+		}
+		else {
+			// FIXME: if an ent has a model and a sound, but isn't
+			// in the PVS, only the PHS, clear the model
+			if (!CM_HeadnodeVisible (ent->headNode, fatpvs))
+				continue;
+			c_fullsend++;
+		}
+
+		visible[e >> 5] |= 1U << (e & 31);
+	}
+
+	// the client's own entity skips the visibility tests
+	e = NUM_FOR_EDICT(clent);
+	if (e < sv_numIndexedEdicts)
+		visible[e >> 5] |= sv_sendableEntities[e >> 5] & (1U << (e & 31));
+
+	// build up the list of visible entities in edict order, which the delta encoding relies on
+	numSend = 0;
+	for (i=0 ; i<(sv_numIndexedEdicts+31)>>5 ; i++) {
+		for (bits=visible[i], e=i<<5 ; bits ; bits>>=1, e++) {
+			if (!(bits & 1))
+				continue;
+
+			ent = EDICT_NUM(e);
+			if (ent != clent) {
+				// check area
+				if (!CM_AreasConnected (vis->area, ent->areaNum)) {
+					/*
+					** doors can legally straddle two areas, so
+					** we may need to check another one
+					*/
+					if (!ent->areaNum2 || !CM_AreasConnected (vis->area, ent->areaNum2))
+						continue;		// blocked by a door
 				}
 
-				if (!ent->s.modelIndex) {
+				if (!(ent->s.renderFx & RF_BEAM) && !ent->s.modelIndex) {
 					// don't send sounds if they will be attenuated away
 					vec3_t	delta;
 					float	len;
 
-					Vec3Subtract (org, ent->s.origin, delta);
+					Vec3Subtract (vis->origin, ent->s.origin, delta);
 					len = Vec3Length (delta);
 					if (len > 400)
 						continue;
 				}
 			}
-		}
 
-		// add it to the circular clientEntities array
-		state = &svs.clientEntities[svs.nextClientEntities%svs.numClientEntities];
-		if (ent->s.number != e) {
-			Com_DevPrintf (0, "FIXING ENT->S.NUMBER!!!\n");
-			ent->s.number = e;
+			sendList[numSend++] = e;
 		}
-		//memcpy (&state, &ent->s, sizeof (entityStateOld_t));
+	}
+
+	// claim a slice of the circular clientEntities array and fill it
+	first = Sys_AtomicAdd (&svs.nextClientEntities, numSend);
+	frame->firstEntity = first;
+	frame->numEntities = numSend;
+
+	for (i=0 ; i<numSend ; i++) {
+		ent = EDICT_NUM(sendList[i]);
+		state = &svs.clientEntities[(first+i)%svs.numClientEntities];
 		*state = ent->s;
 
 		// don't mark players missiles as solid
 		if (ent->owner == client->edict)
 			state->solid = SOLID_NOT;
-
-		svs.nextClientEntities++;
-		frame->numEntities++;
 	}
 }
 
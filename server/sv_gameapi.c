@@ -157,7 +157,7 @@ static qBool GI_IsInPVS (vec3_t p1, vec3_t p2)
 	int		leafnum;
 	int		cluster;
 	int		area1, area2;
-	byte	*mask;
+	const byte	*mask;
 
 	leafnum = CM_PointLeafnum (p1);
 	cluster = CM_LeafCluster (leafnum);
@@ -190,7 +190,7 @@ static qBool GI_IsInPHS (vec3_t p1, vec3_t p2)
 	int		leafnum;
 	int		cluster;
 	int		area1, area2;
-	byte	*mask;
+	const byte	*mask;
 
 	leafnum = CM_PointLeafnum (p1);
 	cluster = CM_LeafCluster (leafnum);
@@ -354,6 +354,28 @@ static void GI_MemFree (void *ptr)
 }
 
 
+/*
+=================
+GI_ObjAlloc
+=================
+*/
+static void *GI_ObjAlloc (size_t size)
+{
+	return _Mem_ObjAlloc (size, "GAME DLL", 0);
+}
+
+
+/*
+=================
+GI_ObjFree
+=================
+*/
+static void GI_ObjFree (void *ptr)
+{
+	_Mem_ObjFree (ptr, "GAME DLL", -1);
+}
+
+
 /*
 =================
 GI_FreeTags
@@ -511,6 +533,12 @@ void SV_GameAPI_Init (void)
 	gi.TagMalloc			= GI_TagAlloc;
 	gi.TagFree				= GI_MemFree;
 	gi.FreeTags				= GI_FreeTags;
+	gi.TraceBatch			= SV_TraceBatch;
+	gi.RadiusEdicts			= SV_RadiusEdicts;
+	gi.Microseconds			= Sys_Microseconds;
+	gi.NumTraces			= CM_NumTraces;
+	gi.ObjMalloc			= GI_ObjAlloc;
+	gi.ObjFree				= GI_ObjFree;
 
 	gi.cvar					= Cvar_Register;
 	gi.cvar_set				= GI_Cvar_Set;
@@ -525,6 +553,9 @@ void SV_GameAPI_Init (void)
 	gi.SetAreaPortalState	= GI_SetAreaPortalState;
 	gi.AreasConnected		= CM_AreasConnected;
 
+	// Tell the game the extensions are filled in
+	Cvar_VariableSetValue (Cvar_Register (GAME_EXTCVAR, "0", CVAR_READONLY), GAME_EXTVERSION, qTrue);
+
 	// Get the game api
 	Com_DevPrintf (0, "LoadLibrary()\n");
 	ge = (gameExport_t *) Sys_LoadLibrary (LIB_GAME, &gi);
@@ -185,6 +185,7 @@ static void SV_SpawnServer (char *server, char *spawnPoint, ssState_t serverStat
 
 	// Clear physics interaction links
 	SV_ClearWorld ();
+	SV_UpdateClientClusters ();
 	
 	for (i=1 ; i<CM_NumInlineModels () ; i++) {
 		Q_snprintfz (sv.configStrings[CS_MODELS+1+i], sizeof (sv.configStrings[CS_MODELS+1+i]), "*%i", i);
@@ -289,6 +290,7 @@ void SV_GameInit (void)
 
 	svs.spawnCount = rand ();
 	svs.clients = Mem_PoolAlloc (sizeof (svClient_t)*maxclients->intVal, sv_genericPool, 0);
+	memset (svs.clientHash, 0, sizeof (svs.clientHash));
 	svs.numClientEntities = maxclients->intVal*UPDATE_BACKUP*64;
 	svs.clientEntities = Mem_PoolAlloc (sizeof (entityStateOld_t)*svs.numClientEntities, sv_genericPool, 0);
 
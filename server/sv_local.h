@@ -134,6 +134,18 @@ typedef struct svClient_s {
 	int				challenge;						// challenge of this user, randomly generated
 
 	netChan_t		netChan;
+	struct svClient_s	*hashNext;					// svs.clientHash chain, keyed on (ip, qPort)
+
+	int				cluster;						// PVS cluster and area as of the last
+	int				area;							// SV_UpdateClientClusters, -1 if outside
+	struct svClient_s	*clusterNext;				// svs.clusterClients chain
+
+	// Built and delta-encoded by SV_BuildClientFrames, finished and sent
+	// by SV_SendClientDatagram
+	qBool			frameReady;
+	qBool			frameOverflowed;
+	size_t			frameSize;
+	byte			frameBuff[MAX_SV_MSGLEN];
 
 	uint32			protocol;						// client protocol
 } svClient_t;
@@ -158,6 +170,9 @@ typedef struct svClient_s {
 // out before legitimate users connected
 #define MAX_CHALLENGES	1024
 
+// Packets are matched to clients through this, see SV_FindPacketClient
+#define CLIENT_HASH_SIZE	256
+
 typedef struct challenge_s {
 	netAdr_t	adr;
 	int			challenge;
@@ -173,8 +188,15 @@ typedef struct serverStatic_s {
 	int					spawnCount;					// incremented each server start -- used to check late spawns
 
 	svClient_t			*clients;					// [maxclients->floatVal];
+	svClient_t			*clientHash[CLIENT_HASH_SIZE];	// connected clients by (ip, qPort)
 	int					numClientEntities;			// maxclients->floatVal*UPDATE_BACKUP*MAX_PACKET_ENTITIES
-	int					nextClientEntities;			// next client_entity to use
+
+	// Connected clients by PVS cluster, see SV_UpdateClientClusters
+	int					numClusters;
+	svClient_t			**clusterClients;			// [numClusters]
+	int					numOccupiedClusters;
+	int					occupiedClusters[MAX_CS_CLIENTS];
+	volatile int		nextClientEntities;			// next client_entity to use, slices are claimed with Sys_AtomicAdd
 	entityStateOld_t	*clientEntities;			// [numClientEntities]
 
 	int					lastHeartBeat;
@@ -214,6 +236,10 @@ extern	cVar_t		*sv_airaccelerate;		// don't reload level state when reentering
 											// development tool
 extern	cVar_t		*sv_enforcetime;
 
+extern	cVar_t		*sv_threads;			// threads building client frames, 0 uses every core
+extern	cVar_t		*sv_areagrid;			// loose grid instead of the area node tree for SV_AreaEdicts
+extern	cVar_t		*sv_arealog;			// log SV_AreaEdicts queries for areabench
+
 extern	svClient_t	*sv_currentClient;
 extern	edict_t		*sv_currentEdict;
 
@@ -248,6 +274,13 @@ int		SV_AreaEdicts (vec3_t mins, vec3_t maxs, edict_t **list, int maxCount, int
 // returns the number of pointers filled in
 // ??? does this always return the world?
 
+int		SV_RadiusEdicts (vec3_t origin, float radius, edict_t **list, int maxCount);
+// SV_AreaEdicts for both area types, trimmed to a sphere and sorted by
+// edict number
+
+void	SV_AreaBench_f (void);
+// replays recent SV_AreaEdicts queries against both area indexes
+
 // ==========================================================================
 
 //
@@ -269,6 +302,9 @@ trace_t	SV_Trace (vec3_t start, vec3_t mins, vec3_t maxs, vec3_t end, edict_t *p
 
 // passedict is explicitly excluded from clipping checks (normally NULL)
 
+void	SV_TraceBatch (traceRequest_t *requests, trace_t *results, int numRequests);
+// SV_Trace for each request, sharing one SV_AreaEdicts gather
+
 // ==========================================================================
 
 //
@@ -281,8 +317,13 @@ void		SV_ReadLevelFile (void);
 // sv_ents.c
 //
 
-void		SV_WriteFrameToClient (svClient_t *client, netMsg_t *msg);
+void		SV_BeginDeltaCaches (int numThreads);
+void		SV_DeltaStats_f (void);
+void		SV_WriteFrameToClient (svClient_t *client, netMsg_t *msg, int thread);
 void		SV_RecordDemoMessage (void);
+void		SV_BuildEntityIndex (void);
+void		SV_ClearEntityIndex (void);
+void		SV_BeginClientFrame (svClient_t *client);
 void		SV_BuildClientFrame (svClient_t *client);
 
 //
@@ -326,6 +367,9 @@ void		SV_Pmove (pMoveNew_t *pMove, float airAcceleration);
 
 void		SV_SendClientMessages (void);
 
+void		SV_UpdateClientClusters (void);
+int			SV_ClusterClients (const byte *mask, int area, svClient_t **list);
+
 void		SV_Unicast (edict_t *ent, qBool reliable);
 void		SV_Multicast (vec3_t origin, multiCast_t to);
 
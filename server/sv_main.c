@@ -56,6 +56,10 @@ cVar_t	*public_server;			// should heartbeats be sent
 
 cVar_t	*sv_reconnect_limit;	// minimum seconds between connect messages
 
+cVar_t	*sv_threads;
+cVar_t	*sv_areagrid;
+cVar_t	*sv_arealog;
+
 struct memPool_s	*sv_gameSysPool;
 struct memPool_s	*sv_genericPool;
 
@@ -70,6 +74,100 @@ void SV_SetState (ssState_t state)
 }
 
 
+/*
+=============================================================================
+
+	CLIENT ADDRESS HASH
+
+=============================================================================
+*/
+
+/*
+=====================
+SV_ClientHashKey
+
+The UDP port is left out on purpose so that clients behind address
+translating routers still hash to the same slot after their port changes
+=====================
+*/
+static uint32 SV_ClientHashKey (netAdr_t *adr, int qPort)
+{
+	uint32	key;
+
+	key = qPort & 0xffff;
+	if (adr->naType == NA_IP)
+		key ^= (adr->ip[0] << 24) | (adr->ip[1] << 16) | (adr->ip[2] << 8) | adr->ip[3];
+
+	key ^= key >> 16;
+	key *= 0x45d9f3b;
+	key ^= key >> 16;
+	return key & (CLIENT_HASH_SIZE-1);
+}
+
+
+/*
+=====================
+SV_LinkClientHash
+=====================
+*/
+static void SV_LinkClientHash (svClient_t *cl)
+{
+	uint32	key;
+
+	key = SV_ClientHashKey (&cl->netChan.remoteAddress, cl->netChan.qPort);
+	cl->hashNext = svs.clientHash[key];
+	svs.clientHash[key] = cl;
+}
+
+
+/*
+=====================
+SV_UnlinkClientHash
+=====================
+*/
+static void SV_UnlinkClientHash (svClient_t *cl)
+{
+	svClient_t	**prev;
+	uint32		key;
+
+	key = SV_ClientHashKey (&cl->netChan.remoteAddress, cl->netChan.qPort);
+	for (prev=&svs.clientHash[key] ; *prev ; prev=&(*prev)->hashNext) {
+		if (*prev == cl) {
+			*prev = cl->hashNext;
+			break;
+		}
+	}
+	cl->hashNext = NULL;
+}
+
+
+/*
+=====================
+SV_FindPacketClient
+
+Returns the connected client that sent the current packet, or NULL
+=====================
+*/
+static svClient_t *SV_FindPacketClient (netAdr_t *adr, int qPort)
+{
+	svClient_t	*cl;
+
+	for (cl=svs.clientHash[SV_ClientHashKey (adr, qPort)] ; cl ; cl=cl->hashNext) {
+		if (cl->state == SVCS_FREE)
+			continue;
+		if (cl->netChan.qPort != qPort)
+			continue;
+		if (!NET_CompareBaseAdr ((*adr), cl->netChan.remoteAddress))
+			continue;
+
+		return cl;
+	}
+
+	return NULL;
+}
+
+//=============================================================================
+
 /*
 =====================
 SV_DropClient
@@ -91,10 +189,11 @@ void SV_DropClient (svClient_t *drop)
 	}
 
 	if (drop->download) {
-		FS_FreeFile (drop->download);
+		FS_FreeFileView (drop->download);
 		drop->download = NULL;
 	}
 
+	SV_UnlinkClientHash (drop);
 	drop->state = SVCS_FREE;		// become free in a few seconds
 	drop->name[0] = 0;
 }
@@ -468,6 +567,8 @@ gotNewClient:
 	** Build a new connection and accept the new client
 	** This is the only place a svClient_t is ever initialized
 	*/
+	if (newcl->state != SVCS_FREE)
+		SV_UnlinkClientHash (newcl);
 	*newcl = temp;
 	sv_currentClient = newcl;
 	edictNum = (newcl-svs.clients)+1;
@@ -496,6 +597,7 @@ gotNewClient:
 	Netchan_OutOfBandPrint (NS_SERVER, &adr, "client_connect");
 
 	Netchan_Setup (NS_SERVER, &newcl->netChan, &adr, version, qPort, 0);
+	SV_LinkClientHash (newcl);
 
 	newcl->protocol = version;
 	newcl->state = SVCS_CONNECTED;
@@ -760,7 +862,6 @@ SV_ReadPackets
 */
 static void SV_ReadPackets (void)
 {
-	int			i;
 	svClient_t	*cl;
 	int			qPort;
 
@@ -781,26 +882,21 @@ static void SV_ReadPackets (void)
 		qPort = MSG_ReadShort (&sv_netMessage) & 0xffff;
 
 		// Check for packets from connected clients
-		for (i=0, cl=svs.clients ; i<maxclients->intVal ; i++, cl++) {
-			if (cl->state == SVCS_FREE)
-				continue;
-			if (!NET_CompareBaseAdr (sv_netFrom, cl->netChan.remoteAddress))
-				continue;
-			if (cl->netChan.qPort != qPort)
-				continue;
-			if (cl->netChan.remoteAddress.port != sv_netFrom.port) {
-				Com_Printf (0, "SV_ReadPackets: fixing up a translated port\n");
-				cl->netChan.remoteAddress.port = sv_netFrom.port;
-			}
+		cl = SV_FindPacketClient (&sv_netFrom, qPort);
+		if (!cl)
+			continue;
+
+		if (cl->netChan.remoteAddress.port != sv_netFrom.port) {
+			Com_Printf (0, "SV_ReadPackets: fixing up a translated port\n");
+			cl->netChan.remoteAddress.port = sv_netFrom.port;
+		}
 
-			if (Netchan_Process (&cl->netChan, &sv_netMessage)) {
-				// This is a valid, sequenced packet, so process it
-				if (cl->state != SVCS_FREE) {
-					cl->lastMessage = svs.realTime;	// Don't timeout
-					SV_ExecuteClientMessage (cl);
-				}
+		if (Netchan_Process (&cl->netChan, &sv_netMessage)) {
+			// This is a valid, sequenced packet, so process it
+			if (cl->state != SVCS_FREE) {
+				cl->lastMessage = svs.realTime;	// Don't timeout
+				SV_ExecuteClientMessage (cl);
 			}
-			break;
 		}
 	}
 }
@@ -883,6 +979,9 @@ static void SV_RunGameFrame (void)
 	sv.frameNum++;
 	sv.time = sv.frameNum*100;
 
+	// Index where the clients ended up after their moves
+	SV_UpdateClientClusters ();
+
 	// Don't run if paused
 	if (!sv_paused->intVal || maxclients->intVal > 1) {
 		ge->RunFrame ();
@@ -969,7 +1068,15 @@ Only called at egl.exe startup, not for each game
 */
 void SV_ServerInit (void)
 {
-	sv_gameSysPool = Mem_CreatePool ("Server: Game system");
+	cVar_t	*sv_gameArena;
+
+	// Arena blocks are only reclaimed by FreeTags, so this is opt-in for game
+	// modules known not to churn TagMalloc/TagFree within a level
+	sv_gameArena = Cvar_Register ("sv_gameArena", "0", 0);
+	if (sv_gameArena->intVal)
+		sv_gameSysPool = Mem_CreateArenaPool ("Server: Game system", 1<<20);
+	else
+		sv_gameSysPool = Mem_CreatePool ("Server: Game system");
 	sv_genericPool = Mem_CreatePool ("Server: Generic");
 
 	SV_OperatorCommandInit	();
@@ -1000,6 +1107,10 @@ void SV_ServerInit (void)
 	sv_noreload				= Cvar_Register ("sv_noreload",				"0",		0);
 	sv_airaccelerate		= Cvar_Register ("sv_airaccelerate",		"0",		CVAR_LATCH_SERVER);
 
+	sv_threads				= Cvar_Register ("sv_threads",				"0",		CVAR_ARCHIVE);
+	sv_areagrid				= Cvar_Register ("sv_areagrid",				"0",		CVAR_LATCH_SERVER);
+	sv_arealog				= Cvar_Register ("sv_arealog",				"0",		0);
+
 	allow_download			= Cvar_Register ("allow_download",			"1",		CVAR_ARCHIVE);
 	allow_download_players	= Cvar_Register ("allow_download_players",	"0",		CVAR_ARCHIVE);
 	allow_download_models	= Cvar_Register ("allow_download_models",	"1",		CVAR_ARCHIVE);
@@ -1085,6 +1196,9 @@ void SV_ServerShutdown (char *finalMessage, qBool reconnect, qBool crashing)
 		Mem_Free (svs.clients);
 	if (svs.clientEntities)
 		Mem_Free (svs.clientEntities);
+	if (svs.clusterClients)
+		Mem_Free (svs.clusterClients);
+	SV_ClearEntityIndex ();
 	if (svs.demoFile)
 		FS_CloseFile (svs.demoFile);
 	memset (&svs, 0, sizeof (svs));
@@ -153,6 +153,88 @@ void SV_Unicast (edict_t *ent, qBool reliable)
 }
 
 
+/*
+=================
+SV_UpdateClientClusters
+
+Finds the leaf of every connected client once and chains the clients by
+PVS cluster, so multicasts and sounds only have to look at the clusters
+that have someone in them. Run at the start of every server frame, so
+the index trails client moves made later in the same frame.
+=================
+*/
+void SV_UpdateClientClusters (void)
+{
+	svClient_t	*cl;
+	int			numClusters;
+	int			leafNum;
+	int			i;
+
+	numClusters = CM_NumClusters ();
+	if (numClusters != svs.numClusters) {
+		if (svs.clusterClients)
+			Mem_Free (svs.clusterClients);
+		svs.clusterClients = Mem_PoolAlloc (sizeof (svClient_t *) * numClusters, sv_genericPool, 0);
+		svs.numClusters = numClusters;
+	}
+	else {
+		for (i=0 ; i<svs.numOccupiedClusters ; i++)
+			svs.clusterClients[svs.occupiedClusters[i]] = NULL;
+	}
+	svs.numOccupiedClusters = 0;
+
+	for (i=0, cl=svs.clients ; i<maxclients->intVal ; i++, cl++) {
+		cl->cluster = -1;
+		cl->area = 0;
+		cl->clusterNext = NULL;
+		if (cl->state == SVCS_FREE || cl->state == SVCS_ZOMBIE)
+			continue;
+
+		leafNum = CM_PointLeafnum (cl->edict->s.origin);
+		cl->cluster = CM_LeafCluster (leafNum);
+		cl->area = CM_LeafArea (leafNum);
+		if (cl->cluster < 0 || cl->cluster >= svs.numClusters)
+			continue;
+
+		if (!svs.clusterClients[cl->cluster])
+			svs.occupiedClusters[svs.numOccupiedClusters++] = cl->cluster;
+		cl->clusterNext = svs.clusterClients[cl->cluster];
+		svs.clusterClients[cl->cluster] = cl;
+	}
+}
+
+
+/*
+=================
+SV_ClusterClients
+
+Fills list with the indexed clients whose cluster is set in mask and
+whose area is connected to area. list must hold maxclients entries.
+=================
+*/
+int SV_ClusterClients (const byte *mask, int area, svClient_t **list)
+{
+	svClient_t	*cl;
+	int			cluster;
+	int			count;
+	int			i;
+
+	count = 0;
+	for (i=0 ; i<svs.numOccupiedClusters ; i++) {
+		cluster = svs.occupiedClusters[i];
+		if (!(mask[cluster>>3] & (1<<(cluster&7))))
+			continue;
+
+		for (cl=svs.clusterClients[cluster] ; cl ; cl=cl->clusterNext) {
+			if (CM_AreasConnected (area, cl->area))
+				list[count++] = cl;
+		}
+	}
+
+	return count;
+}
+
+
 /*
 =================
 SV_Multicast
@@ -167,21 +249,23 @@ MULTICAST_PHS	send to clients potentially hearable from org
 */
 void SV_Multicast (vec3_t origin, multiCast_t to)
 {
+	svClient_t	*targets[MAX_CS_CLIENTS];
 	svClient_t	*client;
-	byte		*mask;
+	const byte	*mask;
 	int			leafNum, cluster;
-	int			j;
+	int			j, numTargets;
 	qBool		reliable;
-	int			area1, area2;
+	int			area1;
 
 	reliable = qFalse;
 
 	if ((to != MULTICAST_ALL_R) && (to != MULTICAST_ALL)) {
 		leafNum = CM_PointLeafnum (origin);
+		cluster = CM_LeafCluster (leafNum);
 		area1 = CM_LeafArea (leafNum);
 	}
 	else {
-		leafNum = 0;	// Just to avoid compiler warnings
+		cluster = -1;	// Just to avoid compiler warnings
 		area1 = 0;
 	}
 
@@ -194,23 +278,18 @@ void SV_Multicast (vec3_t origin, multiCast_t to)
 	case MULTICAST_ALL_R:
 		reliable = qTrue;	// Intentional fallthrough
 	case MULTICAST_ALL:
-		leafNum = 0;
 		mask = NULL;
 		break;
 
 	case MULTICAST_PHS_R:
 		reliable = qTrue;	// Intentional fallthrough
 	case MULTICAST_PHS:
-		leafNum = CM_PointLeafnum (origin);
-		cluster = CM_LeafCluster (leafNum);
 		mask = CM_ClusterPHS (cluster);
 		break;
 
 	case MULTICAST_PVS_R:
 		reliable = qTrue;	// Intentional fallthrough
 	case MULTICAST_PVS:
-		leafNum = CM_PointLeafnum (origin);
-		cluster = CM_LeafCluster (leafNum);
 		mask = CM_ClusterPVS (cluster);
 		break;
 
@@ -219,23 +298,24 @@ void SV_Multicast (vec3_t origin, multiCast_t to)
 		Com_Error (ERR_FATAL, "SV_Multicast: bad to:%i", to);
 	}
 
-	// Send the data to all relevent clients
-	for (j=0, client=svs.clients ; j<maxclients->intVal ; j++, client++) {
+	// Find the relevent clients
+	if (mask) {
+		numTargets = SV_ClusterClients (mask, area1, targets);
+	}
+	else {
+		for (j=0 ; j<maxclients->intVal ; j++)
+			targets[j] = &svs.clients[j];
+		numTargets = maxclients->intVal;
+	}
+
+	// Send the data to them
+	for (j=0 ; j<numTargets ; j++) {
+		client = targets[j];
 		if (client->state == SVCS_FREE || client->state == SVCS_ZOMBIE)
 			continue;
 		if (client->state != SVCS_SPAWNED && !reliable)
 			continue;
 
-		if (mask) {
-			leafNum = CM_PointLeafnum (client->edict->s.origin);
-			cluster = CM_LeafCluster (leafNum);
-			area2 = CM_LeafArea (leafNum);
-			if (!CM_AreasConnected (area1, area2))
-				continue;
-			if (mask && (!(mask[cluster>>3] & (1<<(cluster&7)))))
-				continue;
-		}
-
 		if (reliable) {
 			MSG_WriteRaw (&client->netChan.message, sv.multiCast.data, sv.multiCast.curSize);
 		}
@@ -281,10 +361,10 @@ or the midpoint of the entity box for bmodels.
 void SV_StartSound (vec3_t origin, edict_t *entity, int channel, int soundIndex, float vol, float attenuation, float timeOffset)
 {
 	int			sendChan, flags, i, ent;
-	int			cluster, leafNum, area1 = 0, area2;
+	int			leafNum, numTargets;
 	float		leftVol, rightVol, distanceMult;
+	svClient_t	*targets[MAX_CS_CLIENTS];
 	svClient_t	*client;
-	byte		*mask;
 	vec3_t		sourceVec, listenerRight;
 	vec3_t		originVec;
 	float		dot, dist;
@@ -344,32 +424,26 @@ void SV_StartSound (vec3_t origin, edict_t *entity, int channel, int soundIndex,
 		origin = originVec;
 	}
 
+	// Only clients hearable from the origin and not behind a closed door
 	if (usePHS) {
 		leafNum = CM_PointLeafnum (origin);
-		area1 = CM_LeafArea (leafNum);
+		numTargets = SV_ClusterClients (CM_ClusterPHS (CM_LeafCluster (leafNum)), CM_LeafArea (leafNum), targets);
+	}
+	else {
+		for (i=0 ; i<maxclients->intVal ; i++)
+			targets[i] = &svs.clients[i];
+		numTargets = maxclients->intVal;
 	}
 
 	// Cycle through the different targets and do attenuation calculations
-	for (i=0, client=svs.clients ; i<maxclients->intVal ; i++, client++) {
+	for (i=0 ; i<numTargets ; i++) {
+		client = targets[i];
 		if (client->state == SVCS_FREE || client->state == SVCS_ZOMBIE)
 			continue;
 
 		if (client->state != SVCS_SPAWNED && !(channel & CHAN_RELIABLE))
 			continue;
 
-		if (usePHS) {
-			leafNum = CM_PointLeafnum (client->edict->s.origin);
-			area2 = CM_LeafArea (leafNum);
-			cluster = CM_LeafCluster (leafNum);
-			mask = CM_ClusterPHS (cluster);
-
-			if (!CM_AreasConnected (area1, area2))
-				continue; // leafs aren't connected
-
-			if (mask && (!(mask[cluster>>3] & (1<<(cluster&7)))))
-				continue; // different pvs cluster
-		}
-
 		Vec3Subtract (origin, client->edict->s.origin, sourceVec);
 		distanceMult = attenuation * ((attenuation == ATTN_STATIC) ? 0.001f : 0.0005f);
 
@@ -420,6 +494,79 @@ void SV_StartSound (vec3_t origin, edict_t *entity, int channel, int soundIndex,
 ===============================================================================
 */
 
+// Big enough for any frame SV_WriteFrameToClient can produce, so jobs never
+// hit the overflow warning in MSG_GetWriteSpace
+#define SV_FRAME_SCRATCH	(MAX_CL_MSGLEN*16)
+
+static svClient_t	*sv_frameClients[MAX_CS_CLIENTS];
+static byte			*sv_frameScratch[SYS_MAX_JOB_THREADS];
+
+/*
+=======================
+SV_ClientFrameJob
+
+Builds and delta-encodes one client's frame into its frameBuff.
+=======================
+*/
+static void SV_ClientFrameJob (int job, int thread)
+{
+	svClient_t	*client;
+	netMsg_t	msg;
+
+	client = sv_frameClients[job];
+	SV_BuildClientFrame (client);
+
+	MSG_Init (&msg, sv_frameScratch[thread], SV_FRAME_SCRATCH);
+	msg.allowOverflow = qTrue;
+
+	// Send over all the relevant entityStateOld_t and the playerState_t
+	SV_WriteFrameToClient (client, &msg, thread);
+
+	if (msg.overFlowed || msg.curSize > MAX_SV_MSGLEN) {
+		client->frameOverflowed = qTrue;
+		client->frameSize = 0;
+		return;
+	}
+
+	memcpy (client->frameBuff, msg.data, msg.curSize);
+	client->frameOverflowed = qFalse;
+	client->frameSize = msg.curSize;
+}
+
+
+/*
+=======================
+SV_BuildClientFrames
+
+Builds and encodes the frames of every client in sv_frameClients on
+sv_threads threads. Only the frames are done here, the datagrams are
+still finished and sent in client order by SV_SendClientDatagram.
+=======================
+*/
+static void SV_BuildClientFrames (int numClients)
+{
+	int		numThreads;
+	int		i;
+
+	SV_BuildEntityIndex ();
+	for (i=0 ; i<numClients ; i++)
+		SV_BeginClientFrame (sv_frameClients[i]);
+
+	numThreads = sv_threads->intVal;
+	if (numThreads <= 0)
+		numThreads = Sys_NumProcessors ();
+	numThreads = clamp (numThreads, 1, SYS_MAX_JOB_THREADS);
+
+	for (i=0 ; i<numThreads ; i++) {
+		if (!sv_frameScratch[i])
+			sv_frameScratch[i] = Mem_PoolAlloc (SV_FRAME_SCRATCH, sv_genericPool, 0);
+	}
+	SV_BeginDeltaCaches (numThreads);
+
+	Sys_RunJobs (numClients, numThreads, SV_ClientFrameJob);
+}
+
+
 /*
 =======================
 SV_SendClientDatagram
@@ -430,13 +577,14 @@ qBool SV_SendClientDatagram (svClient_t *client)
 	byte		msgBuf[MAX_SV_MSGLEN];
 	netMsg_t	msg;
 
-	SV_BuildClientFrame (client);
-
 	MSG_Init (&msg, msgBuf, sizeof (msgBuf));
 	msg.allowOverflow = qTrue;
 
-	// Send over all the relevant entityStateOld_t and the playerState_t
-	SV_WriteFrameToClient (client, &msg);
+	// The frame was built and encoded by SV_BuildClientFrames
+	if (client->frameOverflowed)
+		msg.overFlowed = qTrue;
+	else
+		MSG_WriteRaw (&msg, client->frameBuff, client->frameSize);
 
 	// Copy the accumulated multicast datagram for this client out to the message it is
 	// necessary for this to be after the WriteEntities so that entity references will be current
@@ -524,6 +672,7 @@ void SV_SendClientMessages (void)
 	int			msgLen;
 	byte		msgBuf[MAX_SV_MSGLEN];
 	int			r;
+	int			numFrames;
 
 	msgLen = 0;
 
@@ -557,7 +706,8 @@ void SV_SendClientMessages (void)
 		}
 	}
 
-	// Send a message to each connected client
+	// Drop overflowed clients and pick out the ones that get a frame
+	numFrames = 0;
 	for (i=0, c=svs.clients ; i<maxclients->intVal ; i++, c++) {
 		if (!c->state)
 			continue;
@@ -570,6 +720,33 @@ void SV_SendClientMessages (void)
 			SV_DropClient (c);
 		}
 
+		c->frameReady = qFalse;
+		switch (Com_ServerState ()) {
+		case SS_CINEMATIC:
+		case SS_DEMO:
+		case SS_PIC:
+			break;
+
+		default:
+			// Don't overrun bandwidth
+			if (c->state == SVCS_SPAWNED && !SV_RateDrop (c)) {
+				c->frameReady = qTrue;
+				sv_frameClients[numFrames++] = c;
+			}
+			break;
+		}
+	}
+
+	// Build and encode their frames all at once
+	if (numFrames)
+		SV_BuildClientFrames (numFrames);
+
+	// Send a message to each connected client, queued up for a single batched send
+	NET_BeginBatch (NS_SERVER);
+	for (i=0, c=svs.clients ; i<maxclients->intVal ; i++, c++) {
+		if (!c->state)
+			continue;
+
 		switch (Com_ServerState ()) {
 		case SS_CINEMATIC:
 		case SS_DEMO:
@@ -579,8 +756,8 @@ void SV_SendClientMessages (void)
 
 		default:
 			if (c->state == SVCS_SPAWNED) {
-				// Don't overrun bandwidth
-				if (SV_RateDrop (c))
+				// Rate dropped
+				if (!c->frameReady)
 					continue;
 
 				SV_SendClientDatagram (c);
@@ -593,4 +770,5 @@ void SV_SendClientMessages (void)
 			break;
 		}
 	}
+	NET_FlushPackets (NS_SERVER);
 }
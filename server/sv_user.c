@@ -291,7 +291,7 @@ static void SV_NextDownload_f (void)
 	if (sv_currentClient->downloadCount != sv_currentClient->downloadSize)
 		return;
 
-	FS_FreeFile (sv_currentClient->download);
+	FS_FreeFileView (sv_currentClient->download);
 	sv_currentClient->download = NULL;
 }
 
@@ -336,9 +336,9 @@ static void SV_BeginDownload_f (void)
 	}
 
 	if (sv_currentClient->download)
-		FS_FreeFile (sv_currentClient->download);
+		FS_FreeFileView (sv_currentClient->download);
 
-	sv_currentClient->downloadSize = FS_LoadFile (name, (void **)&sv_currentClient->download, NULL);
+	sv_currentClient->downloadSize = FS_LoadFileView (name, (const void **)&sv_currentClient->download);
 	if (sv_currentClient->downloadSize == 0)
 		sv_currentClient->downloadSize = -1;	// Don't send an empty file
 	sv_currentClient->downloadCount = offset;
@@ -351,7 +351,7 @@ static void SV_BeginDownload_f (void)
 		|| (!strncmp (name, "maps/", 5) && fs_fileFromPak)) {
 		Com_DevPrintf (0, "Couldn't download %s to %s\n", name, sv_currentClient->name);
 		if (sv_currentClient->download) {
-			FS_FreeFile (sv_currentClient->download);
+			FS_FreeFileView (sv_currentClient->download);
 			sv_currentClient->download = NULL;
 		}
 
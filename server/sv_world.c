@@ -47,10 +47,50 @@ typedef struct areaNode_s {
 static areaNode_t	sv_areaNodes[AREA_NODES];
 static int			sv_numAreaNodes;
 
+// Loose grid alternative to the area node tree, see sv_areagrid. An edict
+// goes in the x/y cell holding the center of its box, and a cell's contents
+// reach at most half a cell past its edges. Edicts wider than a cell are
+// kept on sv_gridLarge, which every query checks.
+#define AREA_GRID_MAX		64			// cells per axis
+#define AREA_GRID_MINCELL	128
+
+typedef struct areaCell_s {
+	link_t		trigger_edicts;
+	link_t		solid_edicts;
+} areaCell_t;
+
+enum {
+	AREAINDEX_TREE,
+	AREAINDEX_GRID
+};
+
+static int			sv_areaIndex;
+static vec3_t		sv_worldMins, sv_worldMaxs;
+
+static vec2_t		sv_gridOrigin;
+static float		sv_gridCellSize;
+static int			sv_gridSize[2];
+static areaCell_t	*sv_gridCells;		// [sv_gridSize[1]][sv_gridSize[0]]
+static areaCell_t	sv_gridLarge;
+
 static float	*sv_areaMins, *sv_areaMaxs;
 static edict_t	**sv_areaList;
 static int		sv_areaCount, sv_areaMaxCount;
 static int		sv_areaType;
+static int		sv_areaChecks;			// edicts looked at, for areabench
+
+// Recent SV_AreaEdicts queries, logged with sv_arealog and replayed by areabench
+#define AREA_QUERY_LOG	4096
+
+typedef struct areaQuery_s {
+	vec3_t		mins, maxs;
+	int			areaType;
+} areaQuery_t;
+
+static areaQuery_t	sv_areaQueryLog[AREA_QUERY_LOG];
+static int			sv_areaQueryHead;
+static int			sv_numAreaQueries;
+static qBool		sv_areaBenching;
 
 // ClearLink is used for new headNodes
 static void ClearLink (link_t *l)
@@ -138,18 +178,83 @@ static areaNode_t *SV_CreateAreaNode (int depth, vec3_t mins, vec3_t maxs)
 
 /*
 ===============
-SV_ClearWorld
+SV_CreateAreaGrid
+
+Sizes the cells so the world fits in AREA_GRID_MAX of them per axis
 ===============
 */
-void SV_ClearWorld (void)
+static void SV_CreateAreaGrid (vec3_t mins, vec3_t maxs)
 {
-	vec3_t	mins, maxs;
+	float	size;
+	int		i;
+
+	size = max (maxs[0] - mins[0], maxs[1] - mins[1]);
+	sv_gridCellSize = max (size / AREA_GRID_MAX, AREA_GRID_MINCELL);
+
+	for (i=0 ; i<2 ; i++) {
+		sv_gridOrigin[i] = mins[i];
+		sv_gridSize[i] = (int)ceil ((maxs[i] - mins[i]) / sv_gridCellSize);
+		sv_gridSize[i] = clamp (sv_gridSize[i], 1, AREA_GRID_MAX);
+	}
+
+	if (!sv_gridCells)
+		sv_gridCells = Mem_PoolAlloc (sizeof (areaCell_t) * AREA_GRID_MAX * AREA_GRID_MAX, sv_genericPool, 0);
+
+	for (i=0 ; i<sv_gridSize[0]*sv_gridSize[1] ; i++) {
+		ClearLink (&sv_gridCells[i].trigger_edicts);
+		ClearLink (&sv_gridCells[i].solid_edicts);
+	}
+	ClearLink (&sv_gridLarge.trigger_edicts);
+	ClearLink (&sv_gridLarge.solid_edicts);
+}
+
+
+/*
+===============
+SV_GridCoord
+===============
+*/
+static int SV_GridCoord (float v, int axis)
+{
+	int		c;
+
+	c = (int)floor ((v - sv_gridOrigin[axis]) / sv_gridCellSize);
+	return clamp (c, 0, sv_gridSize[axis]-1);
+}
+
+
+/*
+===============
+SV_InitAreaIndex
+===============
+*/
+static void SV_InitAreaIndex (int index)
+{
+	sv_areaIndex = index;
+	if (index == AREAINDEX_GRID) {
+		SV_CreateAreaGrid (sv_worldMins, sv_worldMaxs);
+		return;
+	}
 
 	memset (sv_areaNodes, 0, sizeof (sv_areaNodes));
 	sv_numAreaNodes = 0;
+	SV_CreateAreaNode (0, sv_worldMins, sv_worldMaxs);
+}
+
+
+/*
+===============
+SV_ClearWorld
+===============
+*/
+void SV_ClearWorld (void)
+{
+	CM_InlineModelBounds (sv.models[1], sv_worldMins, sv_worldMaxs);
+	SV_InitAreaIndex (sv_areagrid->intVal ? AREAINDEX_GRID : AREAINDEX_TREE);
 
-	CM_InlineModelBounds (sv.models[1], mins, maxs);
-	SV_CreateAreaNode (0, mins, maxs);
+	// Queries logged on the last map mean nothing against this one
+	sv_areaQueryHead = 0;
+	sv_numAreaQueries = 0;
 }
 
 
@@ -168,6 +273,60 @@ void SV_UnlinkEdict (edict_t *ent)
 }
 
 
+/*
+===============
+SV_LinkAreaEdict
+
+Puts an edict with a valid absMin/absMax in the area index
+===============
+*/
+static void SV_LinkAreaEdict (edict_t *ent)
+{
+	areaNode_t	*node;
+	areaCell_t	*cell;
+
+	if (ent->solid == SOLID_NOT)
+		return;
+
+	if (sv_areaIndex == AREAINDEX_GRID) {
+		// Find the cell holding the box center, unless it's too wide for one
+		if (ent->absMax[0] - ent->absMin[0] > sv_gridCellSize
+		|| ent->absMax[1] - ent->absMin[1] > sv_gridCellSize) {
+			cell = &sv_gridLarge;
+		}
+		else {
+			cell = &sv_gridCells[SV_GridCoord ((ent->absMin[1] + ent->absMax[1]) * 0.5f, 1)*sv_gridSize[0]
+				+ SV_GridCoord ((ent->absMin[0] + ent->absMax[0]) * 0.5f, 0)];
+		}
+
+		if (ent->solid == SOLID_TRIGGER)
+			InsertLinkBefore (&ent->area, &cell->trigger_edicts);
+		else
+			InsertLinkBefore (&ent->area, &cell->solid_edicts);
+		return;
+	}
+
+	// Find the first node that the ent's box crosses
+	node = sv_areaNodes;
+	for ( ; ; ) {
+		if (node->axis == -1)
+			break;
+		if (ent->absMin[node->axis] > node->dist)
+			node = node->children[0];
+		else if (ent->absMax[node->axis] < node->dist)
+			node = node->children[1];
+		else
+			break;	// Crosses the node
+	}
+	
+	// Link it in	
+	if (ent->solid == SOLID_TRIGGER)
+		InsertLinkBefore (&ent->area, &node->trigger_edicts);
+	else
+		InsertLinkBefore (&ent->area, &node->solid_edicts);
+}
+
+
 /*
 ===============
 SV_LinkEdict
@@ -176,7 +335,6 @@ SV_LinkEdict
 #define MAX_TOTAL_ENT_LEAFS		128
 void SV_LinkEdict (edict_t *ent)
 {
-	areaNode_t	*node;
 	int			leafs[MAX_TOTAL_ENT_LEAFS];
 	int			clusters[MAX_TOTAL_ENT_LEAFS];
 	int			num_leafs;
@@ -327,27 +485,7 @@ void SV_LinkEdict (edict_t *ent)
 
 	ent->linkCount++;
 
-	if (ent->solid == SOLID_NOT)
-		return;
-
-	// Find the first node that the ent's box crosses
-	node = sv_areaNodes;
-	for ( ; ; ) {
-		if (node->axis == -1)
-			break;
-		if (ent->absMin[node->axis] > node->dist)
-			node = node->children[0];
-		else if (ent->absMax[node->axis] < node->dist)
-			node = node->children[1];
-		else
-			break;	// Crosses the node
-	}
-	
-	// Link it in	
-	if (ent->solid == SOLID_TRIGGER)
-		InsertLinkBefore (&ent->area, &node->trigger_edicts);
-	else
-		InsertLinkBefore (&ent->area, &node->solid_edicts);
+	SV_LinkAreaEdict (ent);
 }
 
 
@@ -356,20 +494,15 @@ void SV_LinkEdict (edict_t *ent)
 SV_AreaEdicts
 ================
 */
-static void SV_AreaEdicts_r (areaNode_t *node)
+static qBool SV_AreaEdictsList (link_t *start)
 {
-	link_t		*l, *next, *start;
+	link_t		*l, *next;
 	edict_t		*check;
 
-	// Touch linked edicts
-	if (sv_areaType == AREA_SOLID)
-		start = &node->solid_edicts;
-	else
-		start = &node->trigger_edicts;
-
 	for (l=start->next ; l!=start ; l=next) {
 		next = l->next;
 		check = EDICT_FROM_AREA(l);
+		sv_areaChecks++;
 
 		if (check->solid == SOLID_NOT)
 			continue;		// Deactivated
@@ -383,12 +516,23 @@ static void SV_AreaEdicts_r (areaNode_t *node)
 
 		if (sv_areaCount == sv_areaMaxCount) {
 			Com_Printf (0, "SV_AreaEdicts: MAXCOUNT\n");
-			return;
+			return qFalse;
 		}
 
 		sv_areaList[sv_areaCount] = check;
 		sv_areaCount++;
 	}
+
+	return qTrue;
+}
+
+static void SV_AreaEdicts_r (areaNode_t *node)
+{
+	// Touch linked edicts
+	if (sv_areaType == AREA_SOLID)
+		SV_AreaEdictsList (&node->solid_edicts);
+	else
+		SV_AreaEdictsList (&node->trigger_edicts);
 	
 	if (node->axis == -1)
 		return;		// Terminal node
@@ -400,8 +544,44 @@ static void SV_AreaEdicts_r (areaNode_t *node)
 		SV_AreaEdicts_r (node->children[1]);
 }
 
+static void SV_AreaEdictsGrid (void)
+{
+	areaCell_t	*cell;
+	float		halfCell;
+	int			x0, x1, y0, y1;
+	int			x, y;
+
+	if (sv_areaType == AREA_SOLID) {
+		if (!SV_AreaEdictsList (&sv_gridLarge.solid_edicts))
+			return;
+	}
+	else if (!SV_AreaEdictsList (&sv_gridLarge.trigger_edicts))
+		return;
+
+	// Cells hold edicts reaching up to half a cell past their edges
+	halfCell = sv_gridCellSize * 0.5f;
+	x0 = SV_GridCoord (sv_areaMins[0] - halfCell, 0);
+	x1 = SV_GridCoord (sv_areaMaxs[0] + halfCell, 0);
+	y0 = SV_GridCoord (sv_areaMins[1] - halfCell, 1);
+	y1 = SV_GridCoord (sv_areaMaxs[1] + halfCell, 1);
+
+	for (y=y0 ; y<=y1 ; y++) {
+		cell = &sv_gridCells[y*sv_gridSize[0] + x0];
+		for (x=x0 ; x<=x1 ; x++, cell++) {
+			if (sv_areaType == AREA_SOLID) {
+				if (!SV_AreaEdictsList (&cell->solid_edicts))
+					return;
+			}
+			else if (!SV_AreaEdictsList (&cell->trigger_edicts))
+				return;
+		}
+	}
+}
+
 int SV_AreaEdicts (vec3_t mins, vec3_t maxs, edict_t **list, int maxCount, int areaType)
 {
+	areaQuery_t	*query;
+
 	sv_areaMins = mins;
 	sv_areaMaxs = maxs;
 	sv_areaList = list;
@@ -409,11 +589,163 @@ int SV_AreaEdicts (vec3_t mins, vec3_t maxs, edict_t **list, int maxCount, int a
 	sv_areaMaxCount = maxCount;
 	sv_areaType = areaType;
 
-	SV_AreaEdicts_r (sv_areaNodes);
+	if (sv_arealog->intVal && !sv_areaBenching) {
+		query = &sv_areaQueryLog[sv_areaQueryHead];
+		sv_areaQueryHead = (sv_areaQueryHead + 1) % AREA_QUERY_LOG;
+		if (sv_numAreaQueries < AREA_QUERY_LOG)
+			sv_numAreaQueries++;
+		Vec3Copy (mins, query->mins);
+		Vec3Copy (maxs, query->maxs);
+		query->areaType = areaType;
+	}
+
+	if (sv_areaIndex == AREAINDEX_GRID)
+		SV_AreaEdictsGrid ();
+	else
+		SV_AreaEdicts_r (sv_areaNodes);
 
 	return sv_areaCount;
 }
 
+
+/*
+================
+SV_RadiusEdicts
+
+Fills list with the solid and trigger edicts whose bounds come within
+radius of origin, sorted by edict number.
+================
+*/
+static int SV_EdictNumCmp (const void *a, const void *b)
+{
+	const edict_t	*e1 = *(const edict_t **)a;
+	const edict_t	*e2 = *(const edict_t **)b;
+
+	if (e1 < e2)
+		return -1;
+	return e1 > e2;
+}
+
+int SV_RadiusEdicts (vec3_t origin, float radius, edict_t **list, int maxCount)
+{
+	edict_t	*check;
+	vec3_t	mins, maxs;
+	float	dist, d;
+	int		num, count;
+	int		i, j;
+
+	for (i=0 ; i<3 ; i++) {
+		mins[i] = origin[i] - radius;
+		maxs[i] = origin[i] + radius;
+	}
+
+	num = SV_AreaEdicts (mins, maxs, list, maxCount, AREA_SOLID);
+	if (num < maxCount)
+		num += SV_AreaEdicts (mins, maxs, list+num, maxCount-num, AREA_TRIGGERS);
+
+	// Drop the ones only the corners of the box reach
+	count = 0;
+	for (i=0 ; i<num ; i++) {
+		check = list[i];
+		for (j=0, dist=0 ; j<3 ; j++) {
+			if (origin[j] < check->absMin[j])
+				d = check->absMin[j] - origin[j];
+			else if (origin[j] > check->absMax[j])
+				d = origin[j] - check->absMax[j];
+			else
+				continue;
+			dist += d*d;
+		}
+		if (dist > radius*radius)
+			continue;
+
+		list[count++] = check;
+	}
+
+	qsort (list, count, sizeof (edict_t *), SV_EdictNumCmp);
+	return count;
+}
+
+
+/*
+================
+SV_AreaBench_f
+
+Replays the SV_AreaEdicts queries logged while sv_arealog was set against
+the current edicts, once with the area node tree and once with the loose grid.
+================
+*/
+void SV_AreaBench_f (void)
+{
+	static edict_t	*linked[MAX_CS_EDICTS];
+	static edict_t	*touch[MAX_CS_EDICTS];
+	static char		*indexNames[] = { "tree", "grid" };
+	areaQuery_t		*query;
+	int				numLinked, numQueries;
+	int				passes, found;
+	int				index, prevIndex, start;
+	int				e, i, j;
+	edict_t			*ent;
+
+	if (Com_ServerState () != SS_GAME) {
+		Com_Printf (0, "No map running.\n");
+		return;
+	}
+
+	numQueries = sv_numAreaQueries;
+	if (!numQueries) {
+		Com_Printf (0, "No area queries logged yet, set sv_arealog 1 first.\n");
+		return;
+	}
+
+	passes = (Cmd_Argc () > 1) ? atoi (Cmd_Argv (1)) : 20;
+	if (passes < 1)
+		passes = 1;
+
+	numLinked = 0;
+	for (e=1 ; e<ge->numEdicts && e<MAX_CS_EDICTS ; e++) {
+		ent = EDICT_NUM(e);
+		if (ent->area.prev)
+			linked[numLinked++] = ent;
+	}
+
+	Com_Printf (0, "%i edicts, %i queries, %i passes\n", numLinked, numQueries, passes);
+	Com_Printf (0, "index   checks/query  found/query   msec\n");
+	Com_Printf (0, "-----   ------------  -----------  -----\n");
+
+	prevIndex = sv_areaIndex;
+	sv_areaBenching = qTrue;
+	for (index=AREAINDEX_TREE ; index<=AREAINDEX_GRID ; index++) {
+		// Relink everything into this index
+		for (i=0 ; i<numLinked ; i++)
+			SV_UnlinkEdict (linked[i]);
+		SV_InitAreaIndex (index);
+		for (i=0 ; i<numLinked ; i++)
+			SV_LinkAreaEdict (linked[i]);
+
+		sv_areaChecks = 0;
+		found = 0;
+		start = Sys_Milliseconds ();
+		for (j=0 ; j<passes ; j++) {
+			for (i=0, query=sv_areaQueryLog ; i<numQueries ; i++, query++)
+				found += SV_AreaEdicts (query->mins, query->maxs, touch, MAX_CS_EDICTS, query->areaType);
+		}
+
+		Com_Printf (0, "%-5s   %12.1f  %11.1f  %5i\n", indexNames[index],
+			(float)sv_areaChecks / (numQueries*passes),
+			(float)found / (numQueries*passes),
+			Sys_Milliseconds () - start);
+	}
+	sv_areaBenching = qFalse;
+
+	// Put things back the way they were
+	for (i=0 ; i<numLinked ; i++)
+		SV_UnlinkEdict (linked[i]);
+	SV_InitAreaIndex (prevIndex);
+	for (i=0 ; i<numLinked ; i++)
+		SV_LinkAreaEdict (linked[i]);
+}
+
 /*
 ===============================================================================
 
@@ -496,19 +828,19 @@ int SV_PointContents (vec3_t p)
 
 /*
 ====================
-SV_ClipMoveToEntities
+SV_ClipMoveToEntityList
+
+ctx is the trace context to clip in, NULL for the shared one.
 ====================
 */
-static void SV_ClipMoveToEntities (moveClip_t *clip)
+static void SV_ClipMoveToEntityList (struct cmTraceContext_s *ctx, moveClip_t *clip, edict_t **touchlist, int num)
 {
-	int			i, num;
-	edict_t		*touchlist[MAX_CS_EDICTS], *touch;
+	int			i;
+	edict_t		*touch;
 	trace_t		trace;
 	int			headNode;
 	float		*angles;
 
-	num = SV_AreaEdicts (clip->boxMins, clip->boxMaxs, touchlist, MAX_CS_EDICTS, AREA_SOLID);
-
 	/*
 	** be careful, it is possible to have an entity in this
 	** list removed before we get to it (killtriggered)
@@ -532,20 +864,35 @@ static void SV_ClipMoveToEntities (moveClip_t *clip)
 			continue;
 
 		// Might intersect, so do an exact clip
-		headNode = SV_HullForEntity (touch);
+		if (ctx && touch->solid != SOLID_BSP)
+			headNode = CM_ContextHeadnodeForBox (ctx, touch->mins, touch->maxs);
+		else
+			headNode = SV_HullForEntity (touch);
 		if (touch->solid != SOLID_BSP)
 			angles = vec3Origin;	// Boxes don't rotate
 		else
 			angles = touch->s.angles;
 
-		if (touch->svFlags & SVF_MONSTER)
-			CM_TransformedBoxTrace (&trace, clip->start, clip->end,
-				clip->mins2, clip->maxs2, headNode, clip->contentMask,
-				touch->s.origin, angles);
-		else
-			CM_TransformedBoxTrace (&trace, clip->start, clip->end,
-				clip->mins, clip->maxs, headNode,  clip->contentMask,
-				touch->s.origin, angles);
+		if (touch->svFlags & SVF_MONSTER) {
+			if (ctx)
+				CM_ContextTransformedBoxTrace (ctx, &trace, clip->start, clip->end,
+					clip->mins2, clip->maxs2, headNode, clip->contentMask,
+					touch->s.origin, angles);
+			else
+				CM_TransformedBoxTrace (&trace, clip->start, clip->end,
+					clip->mins2, clip->maxs2, headNode, clip->contentMask,
+					touch->s.origin, angles);
+		}
+		else {
+			if (ctx)
+				CM_ContextTransformedBoxTrace (ctx, &trace, clip->start, clip->end,
+					clip->mins, clip->maxs, headNode,  clip->contentMask,
+					touch->s.origin, angles);
+			else
+				CM_TransformedBoxTrace (&trace, clip->start, clip->end,
+					clip->mins, clip->maxs, headNode,  clip->contentMask,
+					touch->s.origin, angles);
+		}
 
 		if (trace.allSolid || trace.startSolid || (trace.fraction < clip->trace.fraction)) {
 			trace.ent = touch;
@@ -562,6 +909,21 @@ static void SV_ClipMoveToEntities (moveClip_t *clip)
 }
 
 
+/*
+====================
+SV_ClipMoveToEntities
+====================
+*/
+static void SV_ClipMoveToEntities (moveClip_t *clip)
+{
+	int			num;
+	edict_t		*touchlist[MAX_CS_EDICTS];
+
+	num = SV_AreaEdicts (clip->boxMins, clip->boxMaxs, touchlist, MAX_CS_EDICTS, AREA_SOLID);
+	SV_ClipMoveToEntityList (NULL, clip, touchlist, num);
+}
+
+
 /*
 ==================
 SV_TraceBounds
@@ -628,3 +990,136 @@ trace_t SV_Trace (vec3_t start, vec3_t mins, vec3_t maxs, vec3_t end, edict_t *p
 
 	return clip.trace;
 }
+
+
+/*
+==================
+SV_TraceBatch
+
+Runs every request like SV_Trace, but gathers the edicts near all of
+them with a single SV_AreaEdicts call. Large batches are spread over
+sv_threads threads, each tracing in its own collision trace context.
+==================
+*/
+#define TRACE_BATCH_THREADED	16		// smallest batch worth waking the workers for
+
+static traceRequest_t			*sv_batchRequests;
+static trace_t					*sv_batchResults;
+static vec3_t					*sv_batchBoxes;		// [numRequests*2], mins and maxs of each move
+static edict_t					*sv_batchEdicts[MAX_CS_EDICTS];
+static int						sv_numBatchEdicts;
+static struct cmTraceContext_s	*sv_batchContexts[SYS_MAX_JOB_THREADS];
+
+static void SV_BatchTrace (int job, int thread)
+{
+	traceRequest_t			*req;
+	struct cmTraceContext_s	*ctx;
+	moveClip_t				clip;
+	edict_t					*touch[MAX_CS_EDICTS];
+	edict_t					*check;
+	float					*boxMins, *boxMaxs;
+	int						i, num;
+
+	req = &sv_batchRequests[job];
+	ctx = sv_batchContexts[thread];
+	memset (&clip, 0, sizeof (moveClip_t));
+
+	// Clip to world
+	if (ctx)
+		clip.trace = CM_ContextBoxTrace (ctx, req->start, req->end, req->mins, req->maxs, 0, req->contentMask);
+	else
+		clip.trace = CM_BoxTrace (req->start, req->end, req->mins, req->maxs, 0, req->contentMask);
+	clip.trace.ent = ge->edicts;
+	if (clip.trace.fraction == 0) {
+		sv_batchResults[job] = clip.trace;
+		return;		// Blocked by the world
+	}
+
+	clip.contentMask = req->contentMask;
+	clip.start = req->start;
+	clip.end = req->end;
+	clip.mins = req->mins;
+	clip.maxs = req->maxs;
+	clip.passEdict = req->passEnt;
+
+	Vec3Copy (req->mins, clip.mins2);
+	Vec3Copy (req->maxs, clip.maxs2);
+
+	// Pick this move's edicts out of the gather, this keeps SV_AreaEdicts' order
+	boxMins = sv_batchBoxes[job*2];
+	boxMaxs = sv_batchBoxes[job*2+1];
+	num = 0;
+	for (i=0 ; i<sv_numBatchEdicts ; i++) {
+		check = sv_batchEdicts[i];
+		if (check->absMin[0] > boxMaxs[0]
+		|| check->absMin[1] > boxMaxs[1]
+		|| check->absMin[2] > boxMaxs[2]
+		|| check->absMax[0] < boxMins[0]
+		|| check->absMax[1] < boxMins[1]
+		|| check->absMax[2] < boxMins[2])
+			continue;		// Not touching
+
+		touch[num++] = check;
+	}
+
+	// Clip to other solid entities
+	SV_ClipMoveToEntityList (ctx, &clip, touch, num);
+	sv_batchResults[job] = clip.trace;
+}
+
+void SV_TraceBatch (traceRequest_t *requests, trace_t *results, int numRequests)
+{
+	vec3_t		mins, maxs;
+	int			numThreads;
+	int			i, j;
+
+	if (numRequests <= 0)
+		return;
+
+	// Bound every move and all of them together
+	sv_batchBoxes = Mem_PoolAlloc (sizeof (vec3_t) * 2 * numRequests, sv_genericPool, 0);
+	ClearBounds (mins, maxs);
+	for (i=0 ; i<numRequests ; i++) {
+		SV_TraceBounds (requests[i].start, requests[i].mins, requests[i].maxs, requests[i].end, sv_batchBoxes[i*2], sv_batchBoxes[i*2+1]);
+		AddPointToBounds (sv_batchBoxes[i*2], mins, maxs);
+		AddPointToBounds (sv_batchBoxes[i*2+1], mins, maxs);
+	}
+
+	sv_numBatchEdicts = SV_AreaEdicts (mins, maxs, sv_batchEdicts, MAX_CS_EDICTS, AREA_SOLID);
+	if (sv_numBatchEdicts == MAX_CS_EDICTS) {
+		// The gather may be missing some, trace them one at a time
+		for (i=0 ; i<numRequests ; i++)
+			results[i] = SV_Trace (requests[i].start, requests[i].mins, requests[i].maxs, requests[i].end, requests[i].passEnt, requests[i].contentMask);
+		Mem_Free (sv_batchBoxes);
+		return;
+	}
+
+	// Catch bad brush models here, the workers can't Com_Error
+	for (i=0 ; i<sv_numBatchEdicts ; i++) {
+		if (sv_batchEdicts[i]->solid == SOLID_BSP && !sv.models[sv_batchEdicts[i]->s.modelIndex])
+			Com_Error (ERR_FATAL, "MOVETYPE_PUSH with a non bsp model");
+	}
+
+	sv_batchRequests = requests;
+	sv_batchResults = results;
+
+	numThreads = sv_threads->intVal;
+	if (numThreads <= 0)
+		numThreads = Sys_NumProcessors ();
+	numThreads = clamp (numThreads, 1, SYS_MAX_JOB_THREADS);
+
+	if (numRequests < TRACE_BATCH_THREADED || numThreads == 1) {
+		for (i=0 ; i<numRequests ; i++)
+			SV_BatchTrace (i, 0);
+	}
+	else {
+		for (j=0 ; j<numThreads ; j++) {
+			if (!sv_batchContexts[j])
+				sv_batchContexts[j] = CM_NewTraceContext ();
+		}
+		Sys_RunJobs (numRequests, numThreads, SV_BatchTrace);
+	}
+
+	Mem_Free (sv_batchBoxes);
+	sv_batchBoxes = NULL;
+}
@@ -125,12 +125,11 @@ Sys_ConsoleOutput
 void Sys_ConsoleOutput (const char *string)
 {
   static qBool colorleft = qFalse;
-  qBool        convert = con_convertcolors && (con_convertcolors->intVal == 1 && ttyc || con_convertcolors->intVal > 1);
-  char buf[65];
-  char c = 0;
+  qBool        convert = con_convertcolors && ((con_convertcolors->intVal == 1 && ttyc) || con_convertcolors->intVal > 1);
+  char buf[72];
+  int  c = 0;
   char e;
 
-  buf[65] = 0;
   while (*string) {
     if (convert && *string == '^') {
       if (c > 56) {
@@ -182,7 +181,8 @@ void Sys_ConsoleOutput (const char *string)
       buf[c++] = *string & 127;
     }
     string++;
-    if (c == 65) {
+    if (c >= 64) {
+      buf[c] = 0;
       c = 0;
       printf("%s", buf);
     }
@@ -40,6 +40,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include <errno.h>
 #include <dlfcn.h>
 #include <dirent.h>
+#include <pthread.h>
 
 #include "../common/common.h"
 #include "unix_local.h"
@@ -367,6 +368,26 @@ uint32 Sys_UMilliseconds (void)
 }
 
 
+/*
+================
+Sys_Microseconds
+================
+*/
+uint32 Sys_Microseconds (void)
+{
+	struct timeval	tp;
+	struct timezone	tzp;
+	static int		secbase;
+
+	gettimeofday (&tp, &tzp);
+
+	if (!secbase)
+		secbase = tp.tv_sec;
+
+	return (tp.tv_sec - secbase)*1000000 + tp.tv_usec;
+}
+
+
 /*
 ================
 Sys_AppActivate
@@ -388,6 +409,48 @@ void Sys_Mkdir (char *path)
 }
 
 
+/*
+================
+Sys_MapFile
+================
+*/
+void *Sys_MapFile (char *path, size_t *size)
+{
+	struct stat	st;
+	void		*base;
+	int			fd;
+
+	fd = open (path, O_RDONLY);
+	if (fd == -1)
+		return NULL;
+
+	if (fstat (fd, &st) == -1 || st.st_size <= 0) {
+		close (fd);
+		return NULL;
+	}
+
+	// The mapping stays valid after the descriptor is closed
+	base = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close (fd);
+	if (base == MAP_FAILED)
+		return NULL;
+
+	*size = st.st_size;
+	return base;
+}
+
+
+/*
+================
+Sys_UnmapFile
+================
+*/
+void Sys_UnmapFile (void *base, size_t size)
+{
+	munmap (base, size);
+}
+
+
 /*
 ================
 Sys_SendKeyEvents
@@ -595,6 +658,229 @@ int Sys_FindFiles (char *path, char *pattern, char **fileList, int maxFiles, int
 	return maxFiles-f.max;
 }
 
+/*
+========================================================================
+
+	WORKER THREADS
+
+========================================================================
+*/
+
+static pthread_mutex_t	sys_jobLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t	sys_jobStart = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t	sys_jobDone = PTHREAD_COND_INITIALIZER;
+
+static int				sys_numJobThreads;		// workers created, not counting the caller
+static int				sys_jobGeneration;		// bumped for every batch
+static int				sys_jobSeen[SYS_MAX_JOB_THREADS];
+
+static void				(*sys_jobFunc) (int job, int thread);
+static int				sys_numJobs;
+static volatile int		sys_nextJob;
+static int				sys_jobThreads;			// threads taking part in this batch
+static int				sys_jobsRunning;		// workers not yet done with this batch
+
+/*
+================
+Sys_NumProcessors
+================
+*/
+int Sys_NumProcessors (void)
+{
+	long	count;
+
+	count = sysconf (_SC_NPROCESSORS_ONLN);
+	return (count < 1) ? 1 : (int)count;
+}
+
+
+/*
+================
+Sys_AtomicAdd
+================
+*/
+int Sys_AtomicAdd (volatile int *value, int add)
+{
+	return __sync_fetch_and_add (value, add);
+}
+
+
+/*
+================
+Sys_DoJobs
+================
+*/
+static void Sys_DoJobs (int thread)
+{
+	int		job;
+
+	while ((job = __sync_fetch_and_add (&sys_nextJob, 1)) < sys_numJobs)
+		sys_jobFunc (job, thread);
+}
+
+
+/*
+================
+Sys_JobThread
+================
+*/
+static void *Sys_JobThread (void *arg)
+{
+	int		thread = (int)(intptr_t)arg;
+
+	pthread_mutex_lock (&sys_jobLock);
+	for ( ; ; ) {
+		while (sys_jobSeen[thread] == sys_jobGeneration)
+			pthread_cond_wait (&sys_jobStart, &sys_jobLock);
+		sys_jobSeen[thread] = sys_jobGeneration;
+		if (thread >= sys_jobThreads)
+			continue;
+
+		pthread_mutex_unlock (&sys_jobLock);
+		Sys_DoJobs (thread);
+		pthread_mutex_lock (&sys_jobLock);
+
+		if (!--sys_jobsRunning)
+			pthread_cond_signal (&sys_jobDone);
+	}
+
+	return NULL;
+}
+
+
+/*
+================
+Sys_SpawnJobThreads
+
+Starts any workers that are missing, each one sleeps until the next batch.
+Returns how many there are, up to numWorkers.
+================
+*/
+static int Sys_SpawnJobThreads (int numWorkers)
+{
+	pthread_t	handle;
+	int			i;
+
+	while (sys_numJobThreads < numWorkers) {
+		i = sys_numJobThreads+1;
+		sys_jobSeen[i] = sys_jobGeneration;
+		if (pthread_create (&handle, NULL, Sys_JobThread, (void *)(intptr_t)i))
+			break;
+		pthread_detach (handle);
+		sys_numJobThreads++;
+	}
+
+	return (numWorkers > sys_numJobThreads) ? sys_numJobThreads : numWorkers;
+}
+
+
+/*
+================
+Sys_BeginJobs
+================
+*/
+static void Sys_BeginJobs (int numJobs, int numWorkers, void (*func) (int job, int thread))
+{
+	pthread_mutex_lock (&sys_jobLock);
+	sys_jobFunc = func;
+	sys_numJobs = numJobs;
+	sys_nextJob = 0;
+	sys_jobThreads = numWorkers+1;
+	sys_jobsRunning = numWorkers;
+	sys_jobGeneration++;
+	pthread_cond_broadcast (&sys_jobStart);
+	pthread_mutex_unlock (&sys_jobLock);
+}
+
+
+/*
+================
+Sys_RunJobs
+================
+*/
+void Sys_RunJobs (int numJobs, int numThreads, void (*func) (int job, int thread))
+{
+	int		i;
+
+	// Let a batch from Sys_StartJobs finish first
+	Sys_WaitJobs ();
+
+	if (numThreads > SYS_MAX_JOB_THREADS)
+		numThreads = SYS_MAX_JOB_THREADS;
+	if (numThreads > numJobs)
+		numThreads = numJobs;
+
+	numThreads = Sys_SpawnJobThreads (numThreads-1) + 1;
+	if (numThreads <= 1) {
+		for (i=0 ; i<numJobs ; i++)
+			func (i, 0);
+		return;
+	}
+
+	Sys_BeginJobs (numJobs, numThreads-1, func);
+	Sys_DoJobs (0);
+	Sys_WaitJobs ();
+}
+
+
+/*
+================
+Sys_StartJobs
+================
+*/
+void Sys_StartJobs (int numJobs, int numThreads, void (*func) (int job, int thread))
+{
+	int		i;
+
+	Sys_WaitJobs ();
+
+	if (numThreads > SYS_MAX_JOB_THREADS-1)
+		numThreads = SYS_MAX_JOB_THREADS-1;
+	if (numThreads > numJobs)
+		numThreads = numJobs;
+
+	numThreads = Sys_SpawnJobThreads (numThreads);
+	if (numThreads < 1) {
+		for (i=0 ; i<numJobs ; i++)
+			func (i, 0);
+		return;
+	}
+
+	Sys_BeginJobs (numJobs, numThreads, func);
+}
+
+
+/*
+================
+Sys_RunJob
+================
+*/
+qBool Sys_RunJob (void)
+{
+	int		job;
+
+	job = __sync_fetch_and_add (&sys_nextJob, 1);
+	if (job >= sys_numJobs)
+		return qFalse;
+
+	sys_jobFunc (job, 0);
+	return qTrue;
+}
+
+
+/*
+================
+Sys_WaitJobs
+================
+*/
+void Sys_WaitJobs (void)
+{
+	pthread_mutex_lock (&sys_jobLock);
+	while (sys_jobsRunning)
+		pthread_cond_wait (&sys_jobDone, &sys_jobLock);
+	pthread_mutex_unlock (&sys_jobLock);
+}
+
 /*
 ========================================================================
 
@@ -21,6 +21,11 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 // unix_udp.c
 //
 
+#ifdef __linux__
+# define _GNU_SOURCE		// recvmmsg/sendmmsg
+# define NET_MMSG
+#endif
+
 #include "../common/common.h"
 #include "unix_local.h"
 
@@ -63,6 +68,38 @@ int			ipSockets[2];
 
 netStats_t		netStats;
 
+/*
+** Batched socket I/O. Incoming datagrams are drained into a ring with one
+** recvmmsg call and handed out by NET_GetPacket, outgoing datagrams queued
+** between NET_BeginBatch and NET_FlushPackets go out with one sendmmsg.
+*/
+#define NET_RECV_BATCH	32
+#define NET_SEND_BATCH	64
+
+typedef struct netRecvRing_s {
+	byte				data[NET_RECV_BATCH][MAX_CL_MSGLEN];
+	struct sockaddr_in	from[NET_RECV_BATCH];
+	int					size[NET_RECV_BATCH];
+	int					flags[NET_RECV_BATCH];
+
+	int					numPackets;
+	int					curPacket;
+} netRecvRing_t;
+
+typedef struct netSendQueue_s {
+	byte				data[NET_SEND_BATCH][MAX_CL_MSGLEN];
+	struct sockaddr_in	to[NET_SEND_BATCH];
+	size_t				size[NET_SEND_BATCH];
+
+	qBool				active;
+	int					numPackets;
+} netSendQueue_t;
+
+static netRecvRing_t	net_recvRing[NS_MAX];
+static netSendQueue_t	net_sendQueue[NS_MAX];
+
+static cVar_t			*net_batch;
+
 int NET_Socket (char *net_interface, int port);
 char *NET_ErrorString (void);
 
@@ -264,6 +301,60 @@ void NET_SendLoopPacket (netSrc_t sock, int length, void *data, netAdr_t *to)
 
 //=============================================================================
 
+#ifdef NET_MMSG
+/*
+====================
+NET_FillRecvRing
+
+Pulls everything waiting on the socket (up to NET_RECV_BATCH) in one call
+====================
+*/
+static int NET_FillRecvRing (netSrc_t sock, size_t maxSize)
+{
+	netRecvRing_t	*ring;
+	struct mmsghdr	msgs[NET_RECV_BATCH];
+	struct iovec	iovs[NET_RECV_BATCH];
+	int				ret, i;
+
+	ring = &net_recvRing[sock];
+	if (maxSize > MAX_CL_MSGLEN)
+		maxSize = MAX_CL_MSGLEN;
+
+	memset (msgs, 0, sizeof (msgs));
+	for (i=0 ; i<NET_RECV_BATCH ; i++) {
+		iovs[i].iov_base = ring->data[i];
+		iovs[i].iov_len = maxSize;
+
+		msgs[i].msg_hdr.msg_name = &ring->from[i];
+		msgs[i].msg_hdr.msg_namelen = sizeof (ring->from[i]);
+		msgs[i].msg_hdr.msg_iov = &iovs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	ring->numPackets = ring->curPacket = 0;
+
+	netStats.recvCalls++;
+	ret = recvmmsg (ipSockets[sock], msgs, NET_RECV_BATCH, MSG_DONTWAIT, NULL);
+	if (ret == -1) {
+		if (errno != EWOULDBLOCK && errno != ECONNREFUSED)
+			Com_Printf (0, "NET_GetPacket: %s\n", NET_ErrorString());
+		return 0;
+	}
+
+	for (i=0 ; i<ret ; i++) {
+		ring->size[i] = msgs[i].msg_len;
+		ring->flags[i] = msgs[i].msg_hdr.msg_flags;
+	}
+	ring->numPackets = ret;
+	return ret;
+}
+#endif
+
+/*
+====================
+NET_GetPacket
+====================
+*/
 qBool NET_GetPacket (netSrc_t sock, netAdr_t *net_from, netMsg_t *net_message)
 {
 	int 	ret;
@@ -271,6 +362,10 @@ qBool NET_GetPacket (netSrc_t sock, netAdr_t *net_from, netMsg_t *net_message)
 	socklen_t		fromlen;
 	int		net_socket;
 	int		err;
+#ifdef NET_MMSG
+	netRecvRing_t	*ring;
+	int				flags;
+#endif
 
 	if (NET_GetLoopPacket (sock, net_from, net_message))
 		return qTrue;
@@ -279,7 +374,37 @@ qBool NET_GetPacket (netSrc_t sock, netAdr_t *net_from, netMsg_t *net_message)
 	if (!net_socket)
 		return qFalse;
 
+#ifdef NET_MMSG
+	ring = &net_recvRing[sock];
+	if (net_batch->intVal || ring->curPacket < ring->numPackets) {
+		if (ring->curPacket >= ring->numPackets) {
+			if (!NET_FillRecvRing (sock, net_message->maxSize))
+				return qFalse;
+		}
+
+		ret = ring->size[ring->curPacket];
+		flags = ring->flags[ring->curPacket];
+		NET_SockAdrToNetAdr (&ring->from[ring->curPacket], net_from);
+
+		if (ret >= net_message->maxSize || flags & MSG_TRUNC) {
+			ring->curPacket++;
+			Com_Printf (0, "Oversize packet from %s\n", NET_AdrToString (net_from));
+			return qFalse;
+		}
+
+		memcpy (net_message->data, ring->data[ring->curPacket], ret);
+		ring->curPacket++;
+
+		netStats.sizeIn += ret;
+		netStats.packetsIn++;
+
+		net_message->curSize = ret;
+		return qTrue;
+	}
+#endif
+
 	fromlen = sizeof(from);
+	netStats.recvCalls++;
 	ret = recvfrom (net_socket, net_message->data, net_message->maxSize, 0, (struct sockaddr *)&from, &fromlen);
 
 	NET_SockAdrToNetAdr (&from, net_from);
@@ -308,11 +433,17 @@ qBool NET_GetPacket (netSrc_t sock, netAdr_t *net_from, netMsg_t *net_message)
 
 //=============================================================================
 
+/*
+====================
+NET_SendPacket
+====================
+*/
 int NET_SendPacket (netSrc_t sock, size_t length, void *data, netAdr_t *to)
 {
 	int		ret;
 	struct sockaddr_in	addr;
 	int		net_socket;
+	netSendQueue_t	*queue;
 
 	switch (to->naType) {
 	case NA_LOOPBACK:
@@ -336,8 +467,24 @@ int NET_SendPacket (netSrc_t sock, size_t length, void *data, netAdr_t *to)
 		break;
 	}
 
-	NET_NetadrToSockadr (&to, &addr);
+	NET_NetadrToSockadr (to, &addr);
+
+	// Queue it up if a batch is open, it goes out in NET_FlushPackets
+	queue = &net_sendQueue[sock];
+	if (queue->active && length <= MAX_CL_MSGLEN) {
+		if (queue->numPackets == NET_SEND_BATCH) {
+			NET_FlushPackets (sock);
+			queue->active = qTrue;
+		}
+
+		memcpy (queue->data[queue->numPackets], data, length);
+		queue->to[queue->numPackets] = addr;
+		queue->size[queue->numPackets] = length;
+		queue->numPackets++;
+		return 1;
+	}
 
+	netStats.sendCalls++;
 	ret = sendto (net_socket, data, length, 0, (struct sockaddr *)&addr, sizeof(addr));
 	if (ret == -1) {
 		Com_Printf (0, "NET_SendPacket ERROR: %s to %s\n", NET_ErrorString(), NET_AdrToString (to));
@@ -345,10 +492,89 @@ int NET_SendPacket (netSrc_t sock, size_t length, void *data, netAdr_t *to)
 		// FIXME: return -1 for certain errors like in net_wins.c
 	}
 
+	netStats.sizeOut += ret;
+	netStats.packetsOut++;
 	return 1;
 }
 
 
+/*
+====================
+NET_BeginBatch
+
+Datagrams sent on this socket are held until NET_FlushPackets
+====================
+*/
+void NET_BeginBatch (netSrc_t sock)
+{
+#ifdef NET_MMSG
+	if (!ipSockets[sock] || !net_batch->intVal)
+		return;
+
+	net_sendQueue[sock].active = qTrue;
+#endif
+}
+
+
+/*
+====================
+NET_FlushPackets
+
+Sends everything queued since NET_BeginBatch and closes the batch
+====================
+*/
+void NET_FlushPackets (netSrc_t sock)
+{
+#ifdef NET_MMSG
+	netSendQueue_t	*queue;
+	struct mmsghdr	msgs[NET_SEND_BATCH];
+	struct iovec	iovs[NET_SEND_BATCH];
+	netAdr_t		to;
+	int				sent, ret, i;
+
+	queue = &net_sendQueue[sock];
+	if (!queue->active)
+		return;
+	queue->active = qFalse;
+	netStats.batchFrames++;
+
+	if (!queue->numPackets)
+		return;
+
+	memset (msgs, 0, sizeof (msgs));
+	for (i=0 ; i<queue->numPackets ; i++) {
+		iovs[i].iov_base = queue->data[i];
+		iovs[i].iov_len = queue->size[i];
+
+		msgs[i].msg_hdr.msg_name = &queue->to[i];
+		msgs[i].msg_hdr.msg_namelen = sizeof (queue->to[i]);
+		msgs[i].msg_hdr.msg_iov = &iovs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	for (sent=0 ; sent<queue->numPackets ; ) {
+		netStats.sendCalls++;
+		ret = sendmmsg (ipSockets[sock], msgs+sent, queue->numPackets-sent, 0);
+		if (ret == -1) {
+			// The datagram at the head failed, report and skip it
+			NET_SockAdrToNetAdr (&queue->to[sent], (&to));
+			Com_Printf (0, "NET_SendPacket ERROR: %s to %s\n", NET_ErrorString(), NET_AdrToString (&to));
+			sent++;
+			continue;
+		}
+
+		for (i=sent ; i<sent+ret ; i++) {
+			netStats.sizeOut += msgs[i].msg_len;
+			netStats.packetsOut++;
+		}
+		sent += ret;
+	}
+
+	queue->numPackets = 0;
+#endif
+}
+
+
 //=============================================================================
 
 /*
@@ -386,6 +612,13 @@ netConfig_t NET_Config (netConfig_t openFlags)
 			close (ipSockets[NS_SERVER]);
 			ipSockets[NS_SERVER] = 0;
 		}
+
+		// anything still buffered belongs to the old sockets
+		memset (net_recvRing, 0, sizeof (net_recvRing));
+		for (i=0 ; i<NS_MAX ; i++) {
+			net_sendQueue[i].active = qFalse;
+			net_sendQueue[i].numPackets = 0;
+		}
 	}
 	else {
 		oldest = oldFlags;
@@ -549,19 +782,35 @@ static void NET_Stats_f (void)
 {
 	uint32	now = time(0);
 	uint32	diff = now - netStats.initTime;
+	uint32	frames;
 
 	if (!netStats.initialized) {
 		Com_Printf (0, "Network sockets not up!\n");
 		return;
 	}
+	if (!diff)
+		diff = 1;
 
 	Com_Printf (0, "Network up for %i seconds.\n"
-		"%i bytes in %i packets received (av: %i kbps)\n"
-		"%i bytes in %i packets sent (av: %i kbps)\n",
+		"%i bytes in %i packets received (av: %i kbps, %i packets/sec)\n"
+		"%i bytes in %i packets sent (av: %i kbps, %i packets/sec)\n",
 		
 		diff,
-		netStats.sizeIn, netStats.packetsIn, (int)(((netStats.sizeIn * 8) / 1024) / diff),
-		netStats.sizeOut, netStats.packetsOut, (int)((netStats.sizeOut * 8) / 1024) / diff);
+		netStats.sizeIn, netStats.packetsIn, (int)(((netStats.sizeIn * 8) / 1024) / diff), netStats.packetsIn / diff,
+		netStats.sizeOut, netStats.packetsOut, (int)((netStats.sizeOut * 8) / 1024) / diff, netStats.packetsOut / diff);
+
+	Com_Printf (0, "%i recv and %i send syscalls\n", netStats.recvCalls, netStats.sendCalls);
+	if (netStats.batchFrames) {
+		frames = netStats.batchFrames;
+		Com_Printf (0, "av: %.2f recv, %.2f send syscalls per frame over %i batched frames\n",
+			(float)netStats.recvCalls / (float)frames, (float)netStats.sendCalls / (float)frames, frames);
+	}
+
+#ifdef NET_MMSG
+	Com_Printf (0, "Batched socket I/O is %s\n", net_batch->intVal ? "on" : "off");
+#else
+	Com_Printf (0, "Batched socket I/O is not supported on this platform\n");
+#endif
 }
 
 
@@ -583,6 +832,8 @@ NET_Init
 */
 void NET_Init (void)
 {
+  net_batch = Cvar_Register ("net_batch", "1", CVAR_ARCHIVE);
+
   cmd_netStats = Cmd_AddCommand ("net_stats", NET_Stats_f, "Prints out connection information");
 }
 
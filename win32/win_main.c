@@ -228,6 +228,30 @@ uint32 Sys_UMilliseconds (void)
 }
 
 
+/*
+================
+Sys_Microseconds
+================
+*/
+uint32 Sys_Microseconds (void)
+{
+	static LARGE_INTEGER	base;
+	static double			scale;
+	LARGE_INTEGER			now;
+
+	if (!scale) {
+		LARGE_INTEGER	freq;
+
+		QueryPerformanceFrequency (&freq);
+		QueryPerformanceCounter (&base);
+		scale = 1000000.0 / (double)freq.QuadPart;
+	}
+
+	QueryPerformanceCounter (&now);
+	return (uint32)((double)(now.QuadPart - base.QuadPart) * scale);
+}
+
+
 /*
 =================
 Sys_AppActivate
@@ -256,6 +280,54 @@ void Sys_Mkdir (char *path)
 }
 
 
+/*
+================
+Sys_MapFile
+================
+*/
+void *Sys_MapFile (char *path, size_t *size)
+{
+	HANDLE	file, mapping;
+	DWORD	fileSize;
+	void	*base;
+
+	file = CreateFile (path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return NULL;
+
+	fileSize = GetFileSize (file, NULL);
+	if (fileSize == INVALID_FILE_SIZE || !fileSize) {
+		CloseHandle (file);
+		return NULL;
+	}
+
+	// The view keeps the mapping and file alive after the handles are closed
+	mapping = CreateFileMapping (file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle (file);
+	if (!mapping)
+		return NULL;
+
+	base = MapViewOfFile (mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle (mapping);
+	if (!base)
+		return NULL;
+
+	*size = fileSize;
+	return base;
+}
+
+
+/*
+================
+Sys_UnmapFile
+================
+*/
+void Sys_UnmapFile (void *base, size_t size)
+{
+	UnmapViewOfFile (base);
+}
+
+
 /*
 ================
 Sys_SendKeyEvents
@@ -487,6 +559,241 @@ int Sys_FindFiles (char *path, char *pattern, char **fileList, int maxFiles, int
 	return fileCount;
 }
 
+/*
+==============================================================================
+
+	WORKER THREADS
+
+==============================================================================
+*/
+
+static CRITICAL_SECTION		sys_jobLock;
+static CONDITION_VARIABLE	sys_jobStart;
+static CONDITION_VARIABLE	sys_jobDone;
+static qBool				sys_jobInitialized;
+
+static int					sys_numJobThreads;		// workers created, not counting the caller
+static int					sys_jobGeneration;		// bumped for every batch
+static int					sys_jobSeen[SYS_MAX_JOB_THREADS];
+
+static void					(*sys_jobFunc) (int job, int thread);
+static int					sys_numJobs;
+static volatile LONG		sys_nextJob;
+static int					sys_jobThreads;			// threads taking part in this batch
+static int					sys_jobsRunning;		// workers not yet done with this batch
+
+/*
+================
+Sys_NumProcessors
+================
+*/
+int Sys_NumProcessors (void)
+{
+	SYSTEM_INFO	info;
+
+	GetSystemInfo (&info);
+	return (info.dwNumberOfProcessors < 1) ? 1 : (int)info.dwNumberOfProcessors;
+}
+
+
+/*
+================
+Sys_AtomicAdd
+================
+*/
+int Sys_AtomicAdd (volatile int *value, int add)
+{
+	return (int)InterlockedExchangeAdd ((volatile LONG *)value, add);
+}
+
+
+/*
+================
+Sys_DoJobs
+================
+*/
+static void Sys_DoJobs (int thread)
+{
+	int		job;
+
+	while ((job = (int)InterlockedIncrement (&sys_nextJob) - 1) < sys_numJobs)
+		sys_jobFunc (job, thread);
+}
+
+
+/*
+================
+Sys_JobThread
+================
+*/
+static DWORD WINAPI Sys_JobThread (LPVOID arg)
+{
+	int		thread = (int)(intptr_t)arg;
+
+	EnterCriticalSection (&sys_jobLock);
+	for ( ; ; ) {
+		while (sys_jobSeen[thread] == sys_jobGeneration)
+			SleepConditionVariableCS (&sys_jobStart, &sys_jobLock, INFINITE);
+		sys_jobSeen[thread] = sys_jobGeneration;
+		if (thread >= sys_jobThreads)
+			continue;
+
+		LeaveCriticalSection (&sys_jobLock);
+		Sys_DoJobs (thread);
+		EnterCriticalSection (&sys_jobLock);
+
+		if (!--sys_jobsRunning)
+			WakeConditionVariable (&sys_jobDone);
+	}
+
+	return 0;
+}
+
+
+/*
+================
+Sys_SpawnJobThreads
+
+Starts any workers that are missing, each one sleeps until the next batch.
+Returns how many there are, up to numWorkers.
+================
+*/
+static int Sys_SpawnJobThreads (int numWorkers)
+{
+	HANDLE	handle;
+	int		i;
+
+	if (!sys_jobInitialized) {
+		InitializeCriticalSection (&sys_jobLock);
+		InitializeConditionVariable (&sys_jobStart);
+		InitializeConditionVariable (&sys_jobDone);
+		sys_jobInitialized = qTrue;
+	}
+
+	while (sys_numJobThreads < numWorkers) {
+		i = sys_numJobThreads+1;
+		sys_jobSeen[i] = sys_jobGeneration;
+		handle = CreateThread (NULL, 0, Sys_JobThread, (LPVOID)(intptr_t)i, 0, NULL);
+		if (!handle)
+			break;
+		CloseHandle (handle);
+		sys_numJobThreads++;
+	}
+
+	return (numWorkers > sys_numJobThreads) ? sys_numJobThreads : numWorkers;
+}
+
+
+/*
+================
+Sys_BeginJobs
+================
+*/
+static void Sys_BeginJobs (int numJobs, int numWorkers, void (*func) (int job, int thread))
+{
+	EnterCriticalSection (&sys_jobLock);
+	sys_jobFunc = func;
+	sys_numJobs = numJobs;
+	sys_nextJob = 0;
+	sys_jobThreads = numWorkers+1;
+	sys_jobsRunning = numWorkers;
+	sys_jobGeneration++;
+	WakeAllConditionVariable (&sys_jobStart);
+	LeaveCriticalSection (&sys_jobLock);
+}
+
+
+/*
+================
+Sys_RunJobs
+================
+*/
+void Sys_RunJobs (int numJobs, int numThreads, void (*func) (int job, int thread))
+{
+	int		i;
+
+	// Let a batch from Sys_StartJobs finish first
+	Sys_WaitJobs ();
+
+	if (numThreads > SYS_MAX_JOB_THREADS)
+		numThreads = SYS_MAX_JOB_THREADS;
+	if (numThreads > numJobs)
+		numThreads = numJobs;
+
+	numThreads = Sys_SpawnJobThreads (numThreads-1) + 1;
+	if (numThreads <= 1) {
+		for (i=0 ; i<numJobs ; i++)
+			func (i, 0);
+		return;
+	}
+
+	Sys_BeginJobs (numJobs, numThreads-1, func);
+	Sys_DoJobs (0);
+	Sys_WaitJobs ();
+}
+
+
+/*
+================
+Sys_StartJobs
+================
+*/
+void Sys_StartJobs (int numJobs, int numThreads, void (*func) (int job, int thread))
+{
+	int		i;
+
+	Sys_WaitJobs ();
+
+	if (numThreads > SYS_MAX_JOB_THREADS-1)
+		numThreads = SYS_MAX_JOB_THREADS-1;
+	if (numThreads > numJobs)
+		numThreads = numJobs;
+
+	numThreads = Sys_SpawnJobThreads (numThreads);
+	if (numThreads < 1) {
+		for (i=0 ; i<numJobs ; i++)
+			func (i, 0);
+		return;
+	}
+
+	Sys_BeginJobs (numJobs, numThreads, func);
+}
+
+
+/*
+================
+Sys_RunJob
+================
+*/
+qBool Sys_RunJob (void)
+{
+	int		job;
+
+	job = (int)InterlockedIncrement (&sys_nextJob) - 1;
+	if (job >= sys_numJobs)
+		return qFalse;
+
+	sys_jobFunc (job, 0);
+	return qTrue;
+}
+
+
+/*
+================
+Sys_WaitJobs
+================
+*/
+void Sys_WaitJobs (void)
+{
+	if (!sys_jobInitialized)
+		return;
+
+	EnterCriticalSection (&sys_jobLock);
+	while (sys_jobsRunning)
+		SleepConditionVariableCS (&sys_jobDone, &sys_jobLock, INFINITE);
+	LeaveCriticalSection (&sys_jobLock);
+}
+
 /*
 ==============================================================================
 
@@ -339,6 +339,7 @@ qBool NET_GetPacket (netSrc_t sock, netAdr_t *fromAddr, netMsg_t *message)
 		return qFalse;
 
 	fromLen = sizeof (fromSockAddr);
+	netStats.recvCalls++;
 	ret = recvfrom (netSocket, (char *)message->data, (int) message->maxSize, 0, (struct sockaddr *)&fromSockAddr, &fromLen);
 
 	NET_SockAdrToNetAdr (&fromSockAddr, fromAddr);
@@ -419,6 +420,7 @@ int NET_SendPacket (netSrc_t sock, size_t length, void *data, netAdr_t *to)
 
 	NET_NetAdrToSockAdr (to, &addr);
 
+	netStats.sendCalls++;
 	ret = sendto (netSocket, data, (int) length, 0, &addr, sizeof (addr));
 	if (ret == -1) {
 		int error = WSAGetLastError ();
@@ -454,6 +456,28 @@ int NET_SendPacket (netSrc_t sock, size_t length, void *data, netAdr_t *to)
 	return 1;
 }
 
+
+/*
+==================
+NET_BeginBatch
+
+Winsock has no batched send, datagrams go out immediately
+==================
+*/
+void NET_BeginBatch (netSrc_t sock)
+{
+}
+
+
+/*
+==================
+NET_FlushPackets
+==================
+*/
+void NET_FlushPackets (netSrc_t sock)
+{
+}
+
 /*
 =============================================================================
 